@@ -0,0 +1,182 @@
+#include "Analytics.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>   // For the SIMD counter merge
+#define ANALYTICS_SSE2 1
+#endif
+#include <algorithm>     // For min and max
+#include <cstdio>        // For the report file
+#include <cstring>       // For strcmp
+using namespace std;
+
+// Function to add one counter array into another, two 64-bit lanes per SSE2 add
+static void addCounters(vector<uint64_t>& target, const vector<uint64_t>& source) {
+	size_t count = min(target.size(), source.size());
+	uint64_t* out = target.data();
+	const uint64_t* in = source.data();
+	size_t i = 0;
+#ifdef ANALYTICS_SSE2
+	for (; i + 4 <= count; i += 4) {
+		__m128i a = _mm_add_epi64(_mm_loadu_si128((const __m128i*)(out + i)), _mm_loadu_si128((const __m128i*)(in + i)));
+		__m128i b = _mm_add_epi64(_mm_loadu_si128((const __m128i*)(out + i + 2)), _mm_loadu_si128((const __m128i*)(in + i + 2)));
+		_mm_storeu_si128((__m128i*)(out + i), a);
+		_mm_storeu_si128((__m128i*)(out + i + 2), b);
+	}
+#endif
+	for (; i < count; i++) out[i] += in[i];
+}
+
+AnalyticsAccumulator::AnalyticsAccumulator(int boardCells)
+	: cellCount(boardCells), deathHeat((size_t)boardCells * boardCells, 0), foodHeat((size_t)boardCells * boardCells, 0) {}
+
+void AnalyticsAccumulator::beginMatch(const Engine& engine) {
+	foodSince = engine.tick;
+	lastTick = engine.tick;
+	lastShown = engine.showPowerup ? engine.powerupOffTime : -1;
+	matchPowerups[0] = matchPowerups[1] = 0;
+}
+
+void AnalyticsAccumulator::observe(const Engine& engine, uint32_t events) {
+	ticks += engine.tick - lastTick;
+	lastTick = engine.tick;
+	uint32_t food = events & (EVENT_FOOD1 | EVENT_FOOD2);
+	if (food) {
+		foodEaten += food == (EVENT_FOOD1 | EVENT_FOOD2) ? 2 : 1;
+		foodWaitTicks += engine.tick - foodSince;  // A second eat in the same tick waited zero ticks
+		foodSince = engine.tick;
+		for (int i = 0; i < 2; i++) {
+			if (food & (i == 0 ? EVENT_FOOD1 : EVENT_FOOD2)) foodHeat[engine.cellIndex(engine.snakes[i].head())]++;
+		}
+	}
+	if (events & EVENT_POWERUP1) { powerupsTaken++; matchPowerups[0]++; }
+	if (events & EVENT_POWERUP2) { powerupsTaken++; matchPowerups[1]++; }
+	if (engine.showPowerup && engine.powerupOffTime != lastShown) {  // A new power-up appeared
+		powerupsShown++;
+		lastShown = engine.powerupOffTime;
+	}
+
+	if (events & EVENT_GAME_OVER) {
+		matches++;
+		outcomes[engine.winner & 3]++;
+		for (int i = 0; i < 2; i++) {
+			DeathCause cause = engine.deathCause[i];
+			deaths[cause]++;
+			if (cause == DEATH_NONE) continue;
+			Cell head = engine.snakes[i].head();
+			int x = min(max(head.x, 0), cellCount - 1);
+			int y = min(max(head.y, 0), cellCount - 1);
+			deathHeat[(size_t)y * cellCount + x]++;
+		}
+		if (matchPowerups[0] != matchPowerups[1] && (engine.winner == 1 || engine.winner == 2)) {
+			int leader = matchPowerups[0] > matchPowerups[1] ? 1 : 2;
+			powerupLeadMatches++;
+			if (engine.winner == leader) powerupLeadWins++;
+		}
+	}
+}
+
+void AnalyticsAccumulator::observeEnd(const Engine& engine, int winner) {
+	ticks += engine.tick - lastTick;
+	lastTick = engine.tick;
+	matches++;
+	outcomes[winner & 3]++;
+	deaths[DEATH_NONE] += 2;  // Nobody has crashed yet, so the heatmap is left alone
+	if (matchPowerups[0] != matchPowerups[1] && (winner == 1 || winner == 2)) {
+		int leader = matchPowerups[0] > matchPowerups[1] ? 1 : 2;
+		powerupLeadMatches++;
+		if (winner == leader) powerupLeadWins++;
+	}
+}
+
+void AnalyticsAccumulator::merge(const AnalyticsAccumulator& other) {
+	matches += other.matches;
+	ticks += other.ticks;
+	for (int i = 0; i < 4; i++) outcomes[i] += other.outcomes[i];
+	for (int i = 0; i <= DEATH_HEAD_ON; i++) deaths[i] += other.deaths[i];
+	foodEaten += other.foodEaten;
+	foodWaitTicks += other.foodWaitTicks;
+	powerupsShown += other.powerupsShown;
+	powerupsTaken += other.powerupsTaken;
+	powerupLeadMatches += other.powerupLeadMatches;
+	powerupLeadWins += other.powerupLeadWins;
+	addCounters(deathHeat, other.deathHeat);
+	addCounters(foodHeat, other.foodHeat);
+}
+
+void AnalyticsAccumulator::clear() {
+	matches = ticks = 0;
+	for (uint64_t& n : outcomes) n = 0;
+	for (uint64_t& n : deaths) n = 0;
+	foodEaten = foodWaitTicks = 0;
+	powerupsShown = powerupsTaken = 0;
+	powerupLeadMatches = powerupLeadWins = 0;
+	fill(deathHeat.begin(), deathHeat.end(), 0);
+	fill(foodHeat.begin(), foodHeat.end(), 0);
+}
+
+// Function to write a heatmap as a titled CSV grid
+static void writeHeat(FILE* file, const char* title, const vector<uint64_t>& heat, int cellCount) {
+	fprintf(file, "%s,%d\n", title, cellCount);
+	for (int y = 0; y < cellCount; y++) {
+		for (int x = 0; x < cellCount; x++) {
+			fprintf(file, x ? ",%llu" : "%llu", (unsigned long long)heat[(size_t)y * cellCount + x]);
+		}
+		fputc('\n', file);
+	}
+}
+
+bool AnalyticsAccumulator::writeReport(const string& path) const {
+	FILE* file = fopen(path.c_str(), "w");
+	if (!file) return false;
+	fprintf(file, "matches,%llu\nticks,%llu\n", (unsigned long long)matches, (unsigned long long)ticks);
+	fprintf(file, "wins1,%llu\nwins2,%llu\ndraws,%llu\nunfinished,%llu\n", (unsigned long long)outcomes[1],
+		(unsigned long long)outcomes[2], (unsigned long long)outcomes[DRAW], (unsigned long long)outcomes[NO_WINNER]);
+	fprintf(file, "deaths_wall,%llu\ndeaths_self,%llu\ndeaths_opponent,%llu\ndeaths_head_on,%llu\n",
+		(unsigned long long)deaths[DEATH_WALL], (unsigned long long)deaths[DEATH_SELF],
+		(unsigned long long)deaths[DEATH_OPPONENT], (unsigned long long)deaths[DEATH_HEAD_ON]);
+	fprintf(file, "food_eaten,%llu\nfood_wait_ticks,%llu\navg_ticks_to_food,%.3f\n", (unsigned long long)foodEaten,
+		(unsigned long long)foodWaitTicks, averageTimeToFood());
+	fprintf(file, "powerups_shown,%llu\npowerups_taken,%llu\npowerup_conversion,%.4f\n", (unsigned long long)powerupsShown,
+		(unsigned long long)powerupsTaken, powerupConversion());
+	fprintf(file, "powerup_lead_matches,%llu\npowerup_lead_wins,%llu\npowerup_lead_win_rate,%.4f\n",
+		(unsigned long long)powerupLeadMatches, (unsigned long long)powerupLeadWins, powerupLeadWinRate());
+	writeHeat(file, "death_heatmap", deathHeat, cellCount);
+	writeHeat(file, "food_heatmap", foodHeat, cellCount);
+	return fclose(file) == 0;
+}
+
+bool AnalyticsAccumulator::readReport(const string& path) {
+	FILE* file = fopen(path.c_str(), "r");
+	if (!file) return false;
+	AnalyticsAccumulator loaded(cellCount);
+	struct { const char* key; uint64_t* value; } fields[] = {
+		{ "matches", &loaded.matches }, { "ticks", &loaded.ticks },
+		{ "wins1", &loaded.outcomes[1] }, { "wins2", &loaded.outcomes[2] },
+		{ "draws", &loaded.outcomes[DRAW] }, { "unfinished", &loaded.outcomes[NO_WINNER] },
+		{ "deaths_wall", &loaded.deaths[DEATH_WALL] }, { "deaths_self", &loaded.deaths[DEATH_SELF] },
+		{ "deaths_opponent", &loaded.deaths[DEATH_OPPONENT] }, { "deaths_head_on", &loaded.deaths[DEATH_HEAD_ON] },
+		{ "food_eaten", &loaded.foodEaten }, { "food_wait_ticks", &loaded.foodWaitTicks }, { "powerups_shown", &loaded.powerupsShown },
+		{ "powerups_taken", &loaded.powerupsTaken }, { "powerup_lead_matches", &loaded.powerupLeadMatches },
+		{ "powerup_lead_wins", &loaded.powerupLeadWins },
+	};
+	bool ok = true;
+	char line[256];
+	while (ok && fgets(line, sizeof(line), file)) {
+		char key[64];
+		unsigned long long value = 0;
+		if (sscanf(line, "%63[^,],%llu", key, &value) != 2) continue;
+		for (auto& field : fields) {
+			if (strcmp(key, field.key) == 0) *field.value = value;
+		}
+		vector<uint64_t>* heat = strcmp(key, "death_heatmap") == 0 ? &loaded.deathHeat
+			: strcmp(key, "food_heatmap") == 0 ? &loaded.foodHeat : nullptr;
+		if (!heat) continue;
+		if ((int)value != cellCount) { ok = false; break; }  // Heatmaps of another board do not map
+		for (size_t i = 0; ok && i < heat->size(); i++) {
+			ok = fscanf(file, " %llu,", &value) == 1;
+			(*heat)[i] = value;
+		}
+	}
+	fclose(file);
+	if (ok) merge(loaded);
+	return ok;
+}
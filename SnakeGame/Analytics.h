@@ -0,0 +1,67 @@
+#pragma once
+// Streaming match analytics. Every match worker feeds its engine ticks into its own
+// AnalyticsAccumulator, which keeps only running sums and per-cell counters (no raw events), and
+// merges it into a shared total every few matches. Memory stays fixed however many ticks are run.
+// The per-cell heatmaps are flat arrays (one row of the board after another) so merging them is a
+// straight run of SIMD adds.
+#include <cstdint>       // For fixed-width integer types
+#include <mutex>         // For the shared total
+#include <string>        // For the report path
+#include <vector>        // For the death heatmap
+#include "Engine.h"
+
+class AnalyticsAccumulator {
+public:
+	int cellCount = 0;                    // Board side the heatmap is sized for
+	uint64_t matches = 0;                 // Finished matches
+	uint64_t ticks = 0;                   // Observed ticks (several updates can share one with sub-steps)
+	uint64_t outcomes[4] = { 0, 0, 0, 0 };// Indexed by winner: NO_WINNER, 1, 2, DRAW
+	uint64_t deaths[DEATH_HEAD_ON + 1] = {};  // Indexed by DeathCause
+	uint64_t foodEaten = 0;               // Food items eaten
+	uint64_t foodWaitTicks = 0;           // Sum of ticks from food appearing to being eaten
+	uint64_t powerupsShown = 0;           // Power-up appearances
+	uint64_t powerupsTaken = 0;           // Power-ups eaten
+	uint64_t powerupLeadMatches = 0;      // Decided matches where one snake took more power-ups
+	uint64_t powerupLeadWins = 0;         // ... and that snake won
+	std::vector<uint64_t> deathHeat;      // Deaths per cell (wall deaths count on the edge cell)
+	std::vector<uint64_t> foodHeat;       // Food eaten per cell
+
+	explicit AnalyticsAccumulator(int cellCount = 0);
+
+	void beginMatch(const Engine& engine);                // Start tracking a fresh engine
+	void observe(const Engine& engine, uint32_t events);  // Call after every Engine::update()
+	void observeEnd(const Engine& engine, int winner);    // Call when a match is ended before anyone crashes
+	void merge(const AnalyticsAccumulator& other);        // Add another accumulator's totals
+	void clear();                                         // Zero the totals (keeps the board size)
+
+	double averageTimeToFood() const { return foodEaten ? (double)foodWaitTicks / foodEaten : 0.0; }
+	double powerupConversion() const { return powerupsShown ? (double)powerupsTaken / powerupsShown : 0.0; }
+	double powerupLeadWinRate() const { return powerupLeadMatches ? (double)powerupLeadWins / powerupLeadMatches : 0.0; }
+
+	bool writeReport(const std::string& path) const;     // Summary plus the heatmaps as CSV grids
+	bool readReport(const std::string& path);            // Add a report's totals (same board size only)
+
+private:
+	int64_t foodSince = 0;       // Tick the current food appeared
+	int64_t lastTick = 0;        // Engine tick at the previous observation
+	int64_t lastShown = 0;       // Tick the last counted power-up appeared
+	int matchPowerups[2] = { 0, 0 };  // Power-ups taken by each snake this match
+};
+
+// Shared total that worker accumulators are flushed into
+class AnalyticsTotal {
+public:
+	explicit AnalyticsTotal(int cellCount) : total(cellCount) {}
+
+	// Function to merge a worker's accumulator into the total and zero it
+	void flush(AnalyticsAccumulator& local) {
+		std::lock_guard<std::mutex> lock(mutex);
+		total.merge(local);
+		local.clear();
+	}
+
+	AnalyticsAccumulator total;  // Read once the workers have flushed for the last time
+
+private:
+	std::mutex mutex;
+};
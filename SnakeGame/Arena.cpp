@@ -0,0 +1,201 @@
+#include "Arena.h"
+#include "ThreadPool.h"
+using namespace std;
+
+// Function to add a segment in front of the head, doubling the ring when it is full
+void ArenaSnake::pushHead(Cell c) {
+	if (length == (int)ring.size()) {
+		vector<Cell> grown(ring.size() * 2);
+		for (int i = 0; i < length; i++) grown[i] = segment(i);
+		ring.swap(grown);
+		headIndex = 0;
+	}
+	headIndex = (headIndex - 1) & (unsigned)(ring.size() - 1);
+	ring[headIndex] = c;
+	length++;
+}
+
+// Function to remove the tail segment
+void ArenaSnake::popTail() {
+	length--;
+}
+
+Arena::Arena(const ArenaOptions& arenaOptions, ThreadPool& threadPool)
+	: options(arenaOptions), rng(arenaOptions.seed), pool(threadPool) {
+	int cells = options.cellCount * options.cellCount;
+	occupancy.assign(cells, 0);
+	foodAt.assign(cells, 0);
+	partitions = pool.size();
+	buffers.resize(pool.size());
+	for (WorkerBuffers& b : buffers) {
+		b.heads.resize(partitions);
+		b.tails.resize(partitions);
+	}
+	eaten.resize(partitions);
+
+	snakes.resize(options.snakes);
+	for (int i = 0; i < options.snakes; i++) {
+		snakes[i].rng = SimRng(mix64(options.seed ^ mix64(i + 1)));
+		snakes[i].ring.resize(16);
+		spawnSnake(i);
+	}
+	for (int i = 0; i < options.foods; i++) spawnFood();
+}
+
+// Function to find a random free cell; gives up (returns -1) on a crowded board
+int Arena::randomFreeCell() {
+	int cells = options.cellCount * options.cellCount;
+	for (int attempt = 0; attempt < 64; attempt++) {
+		int cell = rng.randomValue(0, cells - 1);
+		if (occupancy[cell] == 0 && !foodAt[cell]) return cell;
+	}
+	return -1;
+}
+
+// Function to place a snake as a single head that grows to the start length
+void Arena::spawnSnake(int index) {
+	int cell = randomFreeCell();
+	if (cell < 0) return;  // Try again next tick
+	ArenaSnake& s = snakes[index];
+	s.length = 0;
+	s.pushHead(Cell{ cell % options.cellCount, cell / options.cellCount });
+	s.pendingGrowth = options.startLength - 1;
+	s.direction = (Dir)rng.randomValue(0, 3);
+	s.score = 0;
+	s.alive = true;
+	s.dying = false;
+	occupancy[cell]++;
+}
+
+// Function to place one food item
+void Arena::spawnFood() {
+	int cell = randomFreeCell();
+	if (cell >= 0) foodAt[cell] = 1;
+}
+
+// Function to get the row partition that owns a cell
+int Arena::partitionOf(int cell) const {
+	int row = cell / options.cellCount;
+	return row * partitions / options.cellCount;
+}
+
+// Function to pick a move: keep going, turn now and then, and dodge anything directly ahead
+Dir Arena::chooseMove(ArenaSnake& snake) const {
+	Dir d = snake.direction;
+	if (snake.rng.randomValue(0, 15) == 0) d = (Dir)((d + (snake.rng.randomValue(0, 1) ? 1 : 3)) & 3);
+	Cell next = stepCell(snake.head(), d);
+	if (inBounds(next) && occupancy[cellIndex(next)] == 0) return d;
+	int first = snake.rng.randomValue(0, 3);
+	for (int i = 0; i < 4; i++) {
+		Dir candidate = (Dir)((first + i) & 3);
+		if (candidate == oppositeDir(snake.direction)) continue;
+		next = stepCell(snake.head(), candidate);
+		if (inBounds(next) && occupancy[cellIndex(next)] == 0) return candidate;
+	}
+	return d;
+}
+
+// Phase 1: move a range of snakes and file their claims (reads occupancy, writes only snake-owned data)
+void Arena::propose(int begin, int end, int worker) {
+	WorkerBuffers& out = buffers[worker];
+	for (int i = begin; i < end; i++) {
+		ArenaSnake& s = snakes[i];
+		if (!s.alive) continue;
+		s.direction = chooseMove(s);
+		Cell head = stepCell(s.head(), s.direction);
+		s.pushHead(head);
+		if (s.pendingGrowth > 0) {
+			s.pendingGrowth--;
+		} else {
+			Cell tail = s.tail();
+			s.popTail();
+			int tailCell = cellIndex(tail);
+			out.tails[partitionOf(tailCell)].push_back(Claim{ tailCell, i });
+		}
+		if (!inBounds(head)) {
+			s.dying = true;
+			continue;
+		}
+		int headCell = cellIndex(head);
+		out.heads[partitionOf(headCell)].push_back(Claim{ headCell, i });
+	}
+}
+
+// Phase 2: apply every claim in one row partition, then resolve its heads
+void Arena::resolve(int partition) {
+	for (WorkerBuffers& b : buffers) {
+		for (const Claim& c : b.tails[partition]) occupancy[c.cell]--;
+	}
+	for (WorkerBuffers& b : buffers) {
+		for (const Claim& c : b.heads[partition]) occupancy[c.cell]++;
+	}
+	for (WorkerBuffers& b : buffers) {
+		for (const Claim& c : b.heads[partition]) {
+			ArenaSnake& s = snakes[c.snake];
+			if (occupancy[c.cell] > 1) {
+				s.dying = true;  // Shares its cell with another head or any body segment
+			} else if (foodAt[c.cell]) {
+				foodAt[c.cell] = 0;
+				s.pendingGrowth++;
+				s.score += options.foodScore;
+				eaten[partition].push_back(c.snake);
+			}
+		}
+		b.heads[partition].clear();
+		b.tails[partition].clear();
+	}
+}
+
+// Phase 3: remove dead snakes, then respawn food and snakes in a fixed order
+void Arena::commit() {
+	deathsLastTick = 0;
+	for (ArenaSnake& s : snakes) {
+		if (!s.dying) continue;
+		for (int i = 0; i < s.length; i++) {
+			Cell c = s.segment(i);
+			if (inBounds(c)) occupancy[cellIndex(c)]--;
+		}
+		s.alive = false;
+		s.dying = false;
+		s.length = 0;
+		deathsLastTick++;
+	}
+	for (vector<int>& list : eaten) {
+		for (size_t i = 0; i < list.size(); i++) spawnFood();
+		list.clear();
+	}
+	if (options.respawn) {
+		for (int i = 0; i < (int)snakes.size(); i++) {
+			if (!snakes[i].alive) spawnSnake(i);
+		}
+	}
+}
+
+void Arena::update() {
+	tick++;
+	pool.parallelFor((int)snakes.size(), [this](int begin, int end, int worker) { propose(begin, end, worker); });
+	pool.parallelFor(partitions, [this](int begin, int end, int) {
+		for (int p = begin; p < end; p++) resolve(p);
+	});
+	commit();
+}
+
+int Arena::aliveCount() const {
+	int count = 0;
+	for (const ArenaSnake& s : snakes) count += s.alive;
+	return count;
+}
+
+uint64_t Arena::stateHash() const {
+	uint64_t h = mix64((uint64_t)tick);
+	for (int i = 0; i < (int)snakes.size(); i++) {
+		const ArenaSnake& s = snakes[i];
+		if (!s.alive) continue;
+		h = foldHash(h, (uint64_t)i << 32 | packCell(s.head()));
+		h = foldHash(h, (uint64_t)s.length << 40 | (uint64_t)s.pendingGrowth << 20 | (uint64_t)s.score << 2 | s.direction);
+	}
+	for (int cell = 0; cell < (int)foodAt.size(); cell++) {
+		if (foodAt[cell]) h = foldHash(h, (uint64_t)cell);
+	}
+	return mix64(h);
+}
@@ -0,0 +1,97 @@
+#pragma once
+// Many-snake arena with a two-phase parallel tick.
+// Uses the simultaneous rules of Engine generalised to N snakes and many food items:
+//  1. Propose (parallel over snakes): each snake picks a move from the occupancy of the previous
+//     tick, updates its own ring buffer and files head/tail claims into per-thread buffers,
+//     bucketed by the board rows that own the claimed cell.
+//  2. Resolve (parallel over row partitions): each partition applies the tail releases and head
+//     claims that land in its rows, then kills every head that shares its cell with anything else
+//     (several heads on one cell all die) and lets the surviving heads eat.
+//  3. Commit (serial, in snake order): remove dead bodies, respawn food and snakes.
+// Every cell is touched by exactly one worker per phase and all random draws happen in snake order,
+// so the result is identical for any thread count.
+#include <vector>        // For snakes, claims and the occupancy grid
+#include "SimCore.h"
+
+class ThreadPool;
+
+struct ArenaOptions {
+	int cellCount = 256;    // Number of cells in one row or column
+	int snakes = 1000;      // Number of snakes
+	int foods = 500;        // Food items kept on the board
+	int startLength = 3;    // Segments of a new or respawned snake
+	int foodScore = 1;      // Points for eating food
+	bool respawn = true;    // Respawn dead snakes on the next tick
+	uint64_t seed = 1;      // Seed for placement and the snakes' policies
+};
+
+// Snake in the arena: growable ring buffer, head first
+class ArenaSnake {
+public:
+	std::vector<Cell> ring;    // Segment storage (power-of-two capacity)
+	unsigned headIndex = 0;    // Ring index of the head
+	int length = 0;            // Number of segments
+	int pendingGrowth = 0;     // Moves left that keep the tail
+	Dir direction = DIR_UP;    // Current moving direction
+	int score = 0;             // Food eaten since the last respawn
+	bool alive = false;        // Flag to check if the snake is on the board
+	bool dying = false;        // Set during a tick when the snake collides
+	SimRng rng;                // Private random stream for the snake's policy
+
+	Cell segment(int i) const { return ring[(headIndex + i) & (ring.size() - 1)]; }
+	Cell head() const { return ring[headIndex]; }
+	Cell tail() const { return segment(length - 1); }
+	void pushHead(Cell c);
+	void popTail();
+};
+
+class Arena {
+public:
+	ArenaOptions options;               // Arena settings
+	std::vector<ArenaSnake> snakes;     // All snakes, dead or alive
+	std::vector<uint16_t> occupancy;    // Per-cell segment count over all snakes
+	std::vector<uint8_t> foodAt;        // Per-cell food flag
+	SimRng rng;                         // Arena random stream (placement)
+	int64_t tick = 0;                   // Ticks played
+	int deathsLastTick = 0;             // Snakes that died in the last tick
+
+	Arena(const ArenaOptions& options, ThreadPool& pool);
+
+	void update();                      // Advance one tick
+	int aliveCount() const;             // Number of live snakes
+	uint64_t stateHash() const;         // Hash of the full arena state
+
+	// Function to check if a cell is inside the grid
+	bool inBounds(Cell c) const {
+		return c.x >= 0 && c.x < options.cellCount && c.y >= 0 && c.y < options.cellCount;
+	}
+
+	// Function to get the grid index of an in-bounds cell
+	int cellIndex(Cell c) const { return c.y * options.cellCount + c.x; }
+
+private:
+	// One head or tail claim filed by the propose phase
+	struct Claim {
+		int cell;    // Grid index of the claimed cell
+		int snake;   // Snake filing the claim
+	};
+	// Per-thread claim buffers, one bucket per row partition
+	struct WorkerBuffers {
+		std::vector<std::vector<Claim>> heads;
+		std::vector<std::vector<Claim>> tails;
+	};
+
+	ThreadPool& pool;
+	int partitions;                      // Number of row partitions
+	std::vector<WorkerBuffers> buffers;  // Indexed by worker
+	std::vector<std::vector<int>> eaten; // Snakes that ate, per partition
+
+	int partitionOf(int cell) const;
+	Dir chooseMove(ArenaSnake& snake) const;
+	void propose(int begin, int end, int worker);
+	void resolve(int partition);
+	void commit();
+	void spawnSnake(int snake);
+	void spawnFood();
+	int randomFreeCell();
+};
@@ -0,0 +1,114 @@
+#include "Batch.h"
+#include <algorithm>     // For min
+#include <chrono>        // For timing the run
+#include <cstdio>        // For snprintf
+#include <memory>        // For the bots
+#include <vector>        // For the per-worker buffers
+#include "Bot.h"
+#include "Match.h"
+using namespace std;
+
+// Function to append a CSV field, quoted (RFC 4180) if it holds a comma, a quote or a line break
+static void appendCsvField(string& buffer, const string& text) {
+	if (text.find_first_of(",\"\r\n") == string::npos) {
+		buffer += text;
+		return;
+	}
+	buffer += '"';
+	for (char c : text) {
+		if (c == '"') buffer += '"';  // A quote inside a quoted field is doubled
+		buffer += c;
+	}
+	buffer += '"';
+}
+
+// Function to append a JSON string with its quotes, escaping what JSON does not allow raw
+static void appendJsonString(string& buffer, const string& text) {
+	buffer += '"';
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			buffer += '\\';
+			buffer += c;
+		} else if ((unsigned char)c < 0x20) {
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			buffer += escaped;
+		} else {
+			buffer += c;
+		}
+	}
+	buffer += '"';
+}
+
+// Function to append one match as a CSV or JSON line
+static void formatResult(string& buffer, const BatchOptions& options, uint64_t match, const MatchResult& r) {
+	const char* death[2] = { deathCauseName(r.deathCause[0]), deathCauseName(r.deathCause[1]) };
+	char numbers[160];  // Only numbers and fixed words go through snprintf; names are appended as they are
+	if (options.format == BATCH_JSON) {
+		snprintf(numbers, sizeof(numbers), "{\"match\":%llu,\"seed\":%llu,\"bot1\":", (unsigned long long)match,
+			(unsigned long long)r.seed);
+		buffer += numbers;
+		appendJsonString(buffer, options.bot1);
+		buffer += ",\"bot2\":";
+		appendJsonString(buffer, options.bot2);
+		snprintf(numbers, sizeof(numbers), ",\"winner\":%d,\"ticks\":%d,\"score1\":%d,\"score2\":%d,\"length1\":%d,"
+			"\"length2\":%d,\"death1\":\"%s\",\"death2\":\"%s\"}\n", r.winner, r.ticks, r.score[0], r.score[1],
+			r.length[0], r.length[1], death[0], death[1]);
+		buffer += numbers;
+	} else {
+		snprintf(numbers, sizeof(numbers), "%llu,%llu,", (unsigned long long)match, (unsigned long long)r.seed);
+		buffer += numbers;
+		appendCsvField(buffer, options.bot1);
+		buffer += ',';
+		appendCsvField(buffer, options.bot2);
+		snprintf(numbers, sizeof(numbers), ",%d,%d,%d,%d,%d,%d,%s,%s\n", r.winner, r.ticks, r.score[0], r.score[1],
+			r.length[0], r.length[1], death[0], death[1]);
+		buffer += numbers;
+	}
+}
+
+BatchSummary runBatch(const BatchOptions& options, ThreadPool& pool, FILE* out) {
+	BatchSummary summary;
+	auto startTime = chrono::steady_clock::now();
+	if (options.format == BATCH_CSV) {
+		fputs("match,seed,bot1,bot2,winner,ticks,score1,score2,length1,length2,death1,death2\n", out);
+	}
+
+	vector<string> buffers(pool.size());
+	vector<BatchSummary> partial(pool.size());
+	for (uint64_t first = 0; first < options.matches; first += options.blockMatches) {
+		int count = (int)min<uint64_t>(options.blockMatches, options.matches - first);
+		pool.parallelFor(count, [&](int begin, int end, int worker) {
+			string& buffer = buffers[worker];
+			BatchSummary& local = partial[worker];
+			for (int i = begin; i < end; i++) {
+				uint64_t match = first + i;
+				uint64_t seed = mix64(options.seed ^ mix64(match));
+				unique_ptr<Bot> bot1 = createBot(options.bot1, seed ^ 1);
+				unique_ptr<Bot> bot2 = createBot(options.bot2, seed ^ 2);
+				MatchResult result = playMatch(options.rules, *bot1, *bot2, seed, options.limits);
+				local.matches++;
+				local.ticks += result.ticks;
+				local.outcomes[result.winner & 3]++;
+				local.adjudicated += result.adjudicated;
+				local.repeated += result.repeated;
+				formatResult(buffer, options, match, result);
+			}
+		});
+		for (string& buffer : buffers) {  // Chunks are contiguous, so worker order is match order
+			fwrite(buffer.data(), 1, buffer.size(), out);
+			buffer.clear();
+		}
+	}
+	fflush(out);
+
+	for (const BatchSummary& local : partial) {
+		summary.matches += local.matches;
+		summary.ticks += local.ticks;
+		for (int i = 0; i < 4; i++) summary.outcomes[i] += local.outcomes[i];
+		summary.adjudicated += local.adjudicated;
+		summary.repeated += local.repeated;
+	}
+	summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	return summary;
+}
@@ -0,0 +1,35 @@
+#pragma once
+// Batch bot-vs-bot simulation for balance work: plays N matches on a thread pool and streams one
+// result line per match (CSV or JSON lines). Matches run in blocks; every worker formats its share
+// of a block into its own buffer and the buffers are written in order, so memory stays bounded and
+// the output is byte-identical for any thread count.
+#include <cstdint>       // For fixed-width integer types
+#include <cstdio>        // For the output stream
+#include <string>        // For bot names
+#include "Match.h"
+#include "ThreadPool.h"
+
+enum BatchFormat { BATCH_CSV, BATCH_JSON };
+
+struct BatchOptions {
+	uint64_t matches = 1000;        // Matches to play
+	std::string bot1 = "greedy";    // Bot on the first snake (see createBot)
+	std::string bot2 = "greedy";    // Bot on the second snake
+	uint64_t seed = 1;              // Master seed; match i uses mix64(seed ^ mix64(i))
+	Rules rules;                    // Match rules
+	MatchLimits limits;             // Tick cap, adjudication and repetition draws per match
+	BatchFormat format = BATCH_CSV; // Output format
+	int blockMatches = 4096;        // Matches per block
+};
+
+struct BatchSummary {
+	uint64_t matches = 0;                 // Matches played
+	uint64_t ticks = 0;                   // Ticks simulated
+	uint64_t outcomes[4] = { 0, 0, 0, 0 };// Indexed by winner: NO_WINNER, 1, 2, DRAW
+	uint64_t adjudicated = 0;             // Matches ended early by decidedWinner()
+	uint64_t repeated = 0;                // Matches drawn by repetition
+	double seconds = 0;                   // Wall-clock time
+};
+
+// Function to play a batch of matches, writing one line per match (plus a CSV header) to out
+BatchSummary runBatch(const BatchOptions& options, ThreadPool& pool, FILE* out);
@@ -0,0 +1,270 @@
+#include "Bitboard.h"
+#if defined(__AVX2__)
+#include <immintrin.h>   // For flooding four moves at once and four-row frontier steps
+#define BITBOARD_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>   // For building the free-cell rows and two-row frontier steps
+#define BITBOARD_SSE2 1
+#endif
+#include <algorithm>     // For min and max
+using namespace std;
+
+int Bitboard::count() const {
+	int total = 0;
+	for (int y = 1; y <= cellCount; y++) total += bitCount(rows[y]);
+	return total;
+}
+
+Bitboard freeCells(const Engine& engine) {
+	int n = engine.rules.cellCount;
+	Bitboard free(n);
+	const uint8_t* occupancy1 = engine.occupancy[0].data();
+	const uint8_t* occupancy2 = engine.occupancy[1].data();
+	for (int y = 0; y < n; y++) {
+		const uint8_t* row1 = occupancy1 + (size_t)y * n;
+		const uint8_t* row2 = occupancy2 + (size_t)y * n;
+		uint64_t word = 0;
+		int x = 0;
+#ifdef BITBOARD_SSE2
+		// Sixteen cells per compare: a cell is free when both snakes' counts are zero
+		const __m128i zero = _mm_setzero_si128();
+		for (; x + 16 <= n; x += 16) {
+			__m128i both = _mm_or_si128(_mm_loadu_si128((const __m128i*)(row1 + x)), _mm_loadu_si128((const __m128i*)(row2 + x)));
+			word |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(both, zero)) << x;
+		}
+#endif
+		for (; x < n; x++) word |= (uint64_t)((row1[x] | row2[x]) == 0) << x;
+		free.rows[y + 1] = word;
+	}
+	return free;
+}
+
+// Function to fill a row's reached cells along their free runs in both directions (seeds must be free)
+static inline uint64_t fillRow(uint64_t seeds, uint64_t free) {
+	uint64_t row = seeds | (free & ((free + seeds) ^ free));  // Towards higher columns: the carry runs along the free run
+	uint64_t open = free;
+	row |= open & (row >> 1); open &= open >> 1;
+	row |= open & (row >> 2); open &= open >> 2;
+	row |= open & (row >> 4); open &= open >> 4;
+	row |= open & (row >> 8); open &= open >> 8;
+	row |= open & (row >> 16); open &= open >> 16;
+	row |= open & (row >> 32);
+	return row;
+}
+
+void floodFill(const Bitboard& free, Bitboard& reach) {
+	int n = free.cellCount;
+	const uint64_t* allowed = free.rows;
+	uint64_t* rows = reach.rows;
+
+	// Sweeps alternate top down and bottom up and update rows in place, so a sweep carries the fill
+	// across any number of rows; they stop once a sweep changes nothing
+	for (int y = 1; y <= n; y++) rows[y] = fillRow(rows[y] & allowed[y], allowed[y]);
+	bool changed = true, down = true;
+	while (changed) {
+		changed = false;
+		for (int i = 1; i <= n; i++) {
+			int y = down ? i : n + 1 - i;
+			uint64_t row = rows[y];
+			uint64_t seeds = (row | rows[y - 1] | rows[y + 1]) & allowed[y];
+			if (seeds == row) continue;
+			rows[y] = fillRow(seeds, allowed[y]);
+			changed = true;
+		}
+		down = !down;
+	}
+}
+
+int reachableArea(const Bitboard& free, Cell start) {
+	Bitboard reach(free.cellCount);
+	reach.set(start);
+	floodFill(free, reach);
+	return reach.count();
+}
+
+#ifdef BITBOARD_AVX2
+// Function to run fillRow() on four rows at once
+static inline __m256i fillRows(__m256i seeds, __m256i free) {
+	__m256i row = _mm256_or_si256(seeds, _mm256_and_si256(free, _mm256_xor_si256(_mm256_add_epi64(free, seeds), free)));
+	__m256i open = free;
+	for (int shift = 1; shift < 64; shift *= 2) {
+		row = _mm256_or_si256(row, _mm256_and_si256(open, _mm256_srli_epi64(row, shift)));
+		open = _mm256_and_si256(open, _mm256_srli_epi64(open, shift));
+	}
+	return row;
+}
+
+void moveAreas(const Bitboard& free, Cell head, Dir direction, int areas[4]) {
+	// Lane d of reach[y] holds row y of the region reached by move d, so the four moves flood together
+	int n = free.cellCount;
+	alignas(32) uint64_t reach[Bitboard::ROWS][4];
+	for (int y = 0; y <= n + 1; y++) _mm256_store_si256((__m256i*)reach[y], _mm256_setzero_si256());
+	bool any = false;
+	for (int d = 0; d < 4; d++) {
+		areas[d] = 0;
+		Cell next = stepCell(head, (Dir)d);
+		if (d == oppositeDir(direction) || next.x < 0 || next.x >= n || next.y < 0 || next.y >= n) continue;
+		if (!free.test(next)) continue;
+		reach[next.y + 1][d] = fillRow(1ULL << next.x, free.rows[next.y + 1]);
+		any = true;
+	}
+	bool changed = any, down = true;
+	while (changed) {
+		changed = false;
+		for (int i = 1; i <= n; i++) {
+			int y = down ? i : n + 1 - i;
+			__m256i row = _mm256_load_si256((const __m256i*)reach[y]);
+			__m256i allowed = _mm256_set1_epi64x((long long)free.rows[y]);
+			__m256i neighbours = _mm256_or_si256(_mm256_load_si256((const __m256i*)reach[y - 1]), _mm256_load_si256((const __m256i*)reach[y + 1]));
+			__m256i seeds = _mm256_and_si256(_mm256_or_si256(row, neighbours), allowed);
+			if (_mm256_testc_si256(row, seeds)) continue;  // No new seed in any lane
+			_mm256_store_si256((__m256i*)reach[y], fillRows(seeds, allowed));
+			changed = true;
+		}
+		down = !down;
+	}
+	for (int y = 1; any && y <= n; y++) {
+		for (int d = 0; d < 4; d++) areas[d] += bitCount(reach[y][d]);
+	}
+}
+#else
+void moveAreas(const Bitboard& free, Cell head, Dir direction, int areas[4]) {
+	Bitboard regions[3];  // At most three moves are allowed
+	int regionArea[3];
+	int regionCount = 0;
+	for (int d = 0; d < 4; d++) {
+		areas[d] = 0;
+		Cell next = stepCell(head, (Dir)d);
+		if (d == oppositeDir(direction) || next.x < 0 || next.x >= free.cellCount || next.y < 0 || next.y >= free.cellCount) continue;
+		if (!free.test(next)) continue;
+		int region = 0;
+		while (region < regionCount && !regions[region].test(next)) region++;
+		if (region == regionCount) {
+			regions[region].cellCount = free.cellCount;
+			regions[region].set(next);
+			floodFill(free, regions[region]);
+			regionArea[region] = regions[region].count();
+			regionCount++;
+		}
+		areas[d] = regionArea[region];
+	}
+}
+#endif
+
+void moveAreas(const Engine& engine, int snake, int areas[4]) {
+	const EngineSnake& self = engine.snakes[snake];
+	moveAreas(freeCells(engine), self.head(), self.direction, areas);
+}
+
+// Blocks of rows for the territory rounds: four rows per AVX2 register, two per SSE2 register,
+// otherwise one word
+#if defined(BITBOARD_AVX2)
+typedef __m256i RowBlock;
+static const int BLOCK_ROWS = 4;
+static inline RowBlock loadRows(const uint64_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+static inline void storeRows(uint64_t* p, RowBlock v) { _mm256_storeu_si256((__m256i*)p, v); }
+static inline RowBlock orRows(RowBlock a, RowBlock b) { return _mm256_or_si256(a, b); }
+static inline RowBlock andRows(RowBlock a, RowBlock b) { return _mm256_and_si256(a, b); }
+static inline RowBlock andNotRows(RowBlock a, RowBlock b) { return _mm256_andnot_si256(a, b); }  // ~a & b
+static inline RowBlock sideways(RowBlock v) { return _mm256_or_si256(_mm256_slli_epi64(v, 1), _mm256_srli_epi64(v, 1)); }
+static inline bool emptyRows(RowBlock v) { return _mm256_testz_si256(v, v) != 0; }
+static inline RowBlock noRows() { return _mm256_setzero_si256(); }
+#elif defined(BITBOARD_SSE2)
+typedef __m128i RowBlock;
+static const int BLOCK_ROWS = 2;
+static inline RowBlock loadRows(const uint64_t* p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline void storeRows(uint64_t* p, RowBlock v) { _mm_storeu_si128((__m128i*)p, v); }
+static inline RowBlock orRows(RowBlock a, RowBlock b) { return _mm_or_si128(a, b); }
+static inline RowBlock andRows(RowBlock a, RowBlock b) { return _mm_and_si128(a, b); }
+static inline RowBlock andNotRows(RowBlock a, RowBlock b) { return _mm_andnot_si128(a, b); }  // ~a & b
+static inline RowBlock sideways(RowBlock v) { return _mm_or_si128(_mm_slli_epi64(v, 1), _mm_srli_epi64(v, 1)); }
+static inline bool emptyRows(RowBlock v) { return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF; }
+static inline RowBlock noRows() { return _mm_setzero_si128(); }
+#else
+typedef uint64_t RowBlock;
+static const int BLOCK_ROWS = 1;
+static inline RowBlock loadRows(const uint64_t* p) { return *p; }
+static inline void storeRows(uint64_t* p, RowBlock v) { *p = v; }
+static inline RowBlock orRows(RowBlock a, RowBlock b) { return a | b; }
+static inline RowBlock andRows(RowBlock a, RowBlock b) { return a & b; }
+static inline RowBlock andNotRows(RowBlock a, RowBlock b) { return ~a & b; }
+static inline RowBlock sideways(RowBlock v) { return v << 1 | v >> 1; }
+static inline bool emptyRows(RowBlock v) { return v == 0; }
+static inline RowBlock noRows() { return 0; }
+#endif
+
+void Territory::compute(const Bitboard& free, const Cell* heads, int count) {
+	int n = free.cellCount;
+	owned.assign(count, Bitboard(n));
+	cells.assign(count, 0);
+	growing.assign(count, 0);
+	for (int b = 0; b < 2; b++) frontier[b].assign(count, Bitboard(n));
+
+	// Each round only touches the rows next to the cells reached in the round before
+	Bitboard available = free;
+	int first = n + 1, last = 0;
+	for (int i = 0; i < count; i++) {
+		if (heads[i].x < 0 || heads[i].x >= n || heads[i].y < 0 || heads[i].y >= n) continue;
+		frontier[0][i].set(heads[i]);
+		growing[i] = 1;
+		first = min(first, heads[i].y + 1);
+		last = max(last, heads[i].y + 1);
+	}
+	int current = 0;
+	bool any = last > 0;
+	while (any) {
+		first = max(1, first - 1);
+		last = min(n, last + 1);
+		int next = 1 - current;
+		int reachedFirst = n + 1, reachedLast = 0;
+
+		// Every frontier steps into the available cells; cells reached by two or more snakes go to
+		// nobody but stay in each frontier, so the split matches BFS distances. Blocks past the last
+		// row only ever see empty rows (the padding keeps them inside the array).
+		for (int y = first; y <= last; y += BLOCK_ROWS) {
+			RowBlock allowed = loadRows(available.rows + y);
+			RowBlock once = noRows(), twice = noRows();
+			for (int i = 0; i < count; i++) {
+				if (!growing[i]) continue;
+				const uint64_t* from = frontier[current][i].rows + y;
+				RowBlock row = loadRows(from);
+				RowBlock grown = orRows(orRows(row, sideways(row)), orRows(loadRows(from - 1), loadRows(from + 1)));
+				grown = andRows(grown, allowed);
+				storeRows(frontier[next][i].rows + y, grown);
+				twice = orRows(twice, andRows(once, grown));
+				once = orRows(once, grown);
+				if (!emptyRows(grown)) growing[i] = 3;  // Bit 1 marks a frontier that reached something this round
+			}
+			if (emptyRows(once)) continue;
+			reachedFirst = min(reachedFirst, y);
+			reachedLast = y + BLOCK_ROWS - 1;
+			storeRows(available.rows + y, andNotRows(once, allowed));
+			for (int i = 0; i < count; i++) {
+				if (growing[i] != 3) continue;
+				uint64_t* mine = owned[i].rows + y;
+				storeRows(mine, orRows(loadRows(mine), andNotRows(twice, loadRows(frontier[next][i].rows + y))));
+			}
+		}
+		first = reachedFirst;
+		last = min(n, reachedLast);
+		any = false;
+		for (int i = 0; i < count; i++) {
+			growing[i] >>= 1;
+			any |= growing[i] != 0;
+		}
+		current = next;
+	}
+
+	int reached = free.count() - available.count();
+	for (int i = 0; i < count; i++) {
+		cells[i] = owned[i].count();
+		reached -= cells[i];
+	}
+	contested = reached;
+}
+
+void Territory::compute(const Engine& engine) {
+	Cell heads[2] = { engine.snakes[0].head(), engine.snakes[1].head() };
+	compute(freeCells(engine), heads, 2);
+}
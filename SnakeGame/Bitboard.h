@@ -0,0 +1,71 @@
+#pragma once
+// Bitboards for bot space evaluation.
+// A board is stored one 64-bit word per row (bit x is column x) between two always-empty guard
+// rows, so boards up to MAX_CELLS wide fit and a 25 x 25 board takes 27 words. A flood fill spreads
+// each reached row along its free runs in one go (a carry chain one way, a shift ladder the other),
+// seeds the rows above and below, and sweeps the board alternately down and up until nothing
+// changes; a few sweeps are usually enough. With AVX2 (/arch:AVX2 or -mavx2) moveAreas() floods all
+// four moves at once, one move per 64-bit lane; otherwise moves into the same region share one fill.
+//
+// Territory (a Voronoi split of the free cells) grows every snake's frontier one step per round from
+// all heads at once, four rows per AVX2 instruction (two with SSE2). A cell reached by two snakes in
+// the same round belongs to nobody. `snake_sim --flood` checks flood fills and
+// territories against plain BFS and times them.
+#include <cstdint>       // For fixed-width integer types
+#include <vector>        // For territory buffers
+#include "Engine.h"
+
+struct Bitboard {
+	static const int MAX_CELLS = 64;        // Largest supported board side
+	static const int ROWS = MAX_CELLS + 5;  // Stored rows: guard, board rows, guard and padding for four-row steps
+
+	int cellCount = 0;                      // Board side
+	uint64_t rows[ROWS];                    // Row y of the board is rows[y + 1]; unused rows stay zero
+
+	Bitboard() : rows() {}
+	explicit Bitboard(int cells) : cellCount(cells), rows() {}
+
+	void set(Cell c) { rows[c.y + 1] |= 1ULL << c.x; }
+	void clear(Cell c) { rows[c.y + 1] &= ~(1ULL << c.x); }
+	bool test(Cell c) const { return (rows[c.y + 1] >> c.x & 1) != 0; }
+	int count() const;  // Number of set cells
+};
+
+// Function to build the bitboard of free cells (in bounds and without any snake segment; tails are
+// treated as solid, like isSafeMove); the engine board must be at most Bitboard::MAX_CELLS wide
+Bitboard freeCells(const Engine& engine);
+
+// Function to grow `reach` over the free cells until it covers every free cell connected to it
+void floodFill(const Bitboard& free, Bitboard& reach);
+
+// Function to count the free cells reachable from a free start cell (the start cell included)
+int reachableArea(const Bitboard& free, Cell start);
+
+// Function to count the cells reachable after each move of a snake whose head is at `head`; moves
+// that reverse the snake or step into a wall or a body get 0. Moves into the same region share one
+// flood fill unless AVX2 floods them all at once.
+void moveAreas(const Bitboard& free, Cell head, Dir direction, int areas[4]);
+
+// Function to count the reachable cells after each move of `snake` (see above)
+void moveAreas(const Engine& engine, int snake, int areas[4]);
+
+// Voronoi territory: the free cells each snake reaches strictly before every other snake, by BFS
+// distance through free cells. Keep one
+// object around and call compute() repeatedly; its buffers are reused.
+class Territory {
+public:
+	std::vector<Bitboard> owned;  // Cells owned by each snake
+	std::vector<int> cells;       // Number of cells owned by each snake
+	int contested = 0;            // Cells at the same distance from two or more snakes (owned by nobody)
+
+	// Function to split the free cells between snakes with heads at heads[0..count-1]; a head off the
+	// board owns nothing
+	void compute(const Bitboard& free, const Cell* heads, int count);
+
+	// Function to split the free cells of an engine between its two snakes
+	void compute(const Engine& engine);
+
+private:
+	std::vector<Bitboard> frontier[2];  // Cells reached in the last round and the round being built
+	std::vector<uint8_t> growing;       // Flag per snake: its frontier is not empty
+};
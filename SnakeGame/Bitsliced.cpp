@@ -0,0 +1,427 @@
+#include "Bitsliced.h"
+using namespace std;
+
+// Function to get the lanes moving in each direction from a pair of direction bit planes
+static inline void splitDirections(uint64_t low, uint64_t high, uint64_t out[4]) {
+	out[DIR_UP] = ~low & ~high;
+	out[DIR_RIGHT] = low & ~high;
+	out[DIR_DOWN] = ~low & high;
+	out[DIR_LEFT] = low & high;
+}
+
+BitslicedEngine::BitslicedEngine(const Rules& gameRules, int tickCap)
+	: rules(gameRules), maxTicks(tickCap) {
+	int n = rules.cellCount;
+	cells = n * n;
+	neighbour.resize((size_t)cells * 4);
+	for (int c = 0; c < cells; c++) {
+		for (int k = 0; k < 4; k++) {
+			Cell next = stepCell(Cell{ c % n, c / n }, (Dir)k);
+			bool inside = next.x >= 0 && next.x < n && next.y >= 0 && next.y < n;
+			neighbour[c * 4 + k] = inside ? next.y * n + next.x : -1;
+		}
+	}
+	board.assign(cells, CellPlanes());
+	foodInColumn.assign(n, 0);
+	foodInRow.assign(n, 0);
+	listed.assign(cells, 0);
+	for (int lane = 0; lane < LANES; lane++) {
+		food[lane] = Cell{ 0, 0 };  // Idle lanes have no bits on the board, so these are never seen
+		powerup[lane] = Cell{ -1, -1 };
+	}
+}
+
+// Function to start a new cell list (stamps wrap around by clearing every stamp)
+void BitslicedEngine::beginList() {
+	scratchCells.clear();
+	if (++stamp == 0) {
+		listed.assign(cells, 0);
+		stamp = 1;
+	}
+}
+
+// Function to add a cell to the list being built unless it is already on it
+void BitslicedEngine::listCell(int cell) {
+	if (listed[cell] != stamp) {
+		listed[cell] = stamp;
+		scratchCells.push_back(cell);
+	}
+}
+
+// Function to place a three-segment snake in one lane, like Engine::resetSnake()
+void BitslicedEngine::placeSnake(int snake, int lane, Cell start, Dir direction) {
+	uint64_t bit = 1ULL << lane;
+	uint64_t low = (direction & 1) ? bit : 0;
+	uint64_t high = (direction & 2) ? bit : 0;
+	Cell back = dirDelta(oppositeDir(direction));
+	int n = rules.cellCount;
+	int cell[3];
+	for (int i = 0; i < 3; i++) {  // Every segment steps towards the head in the starting direction
+		cell[i] = (start.y + i * back.y) * n + start.x + i * back.x;
+		board[cell[i]].occupancy[snake] |= bit;
+		board[cell[i]].stepLow[snake] = (board[cell[i]].stepLow[snake] & ~bit) | low;
+		board[cell[i]].stepHigh[snake] = (board[cell[i]].stepHigh[snake] & ~bit) | high;
+	}
+	if (!board[cell[0]].heads[snake]) headCells[snake].push_back(cell[0]);  // Cells with bits set are already listed
+	board[cell[0]].heads[snake] |= bit;
+	if (!board[cell[2]].tails[snake]) tailCells[snake].push_back(cell[2]);
+	board[cell[2]].tails[snake] |= bit;
+	directionLow[snake] = (directionLow[snake] & ~bit) | low;
+	directionHigh[snake] = (directionHigh[snake] & ~bit) | high;
+	length[snake][lane] = 3;
+	score[snake][lane] = 0;
+}
+
+// Function to draw a random free cell for a lane; the same draws as Engine::genRandPos()
+int BitslicedEngine::randomFreeCell(int lane) {
+	int n = rules.cellCount;
+	while (true) {
+		int x = rng[lane].randomValue(0, n - 1);
+		int y = rng[lane].randomValue(0, n - 1);
+		int cell = y * n + x;
+		if (!(((board[cell].occupancy[0] | board[cell].occupancy[1]) >> lane) & 1)) return cell;
+	}
+}
+
+// Function to move a lane's food to a cell
+void BitslicedEngine::placeFood(int lane, int cell) {
+	uint64_t bit = 1ULL << lane;
+	int n = rules.cellCount;
+	int old = food[lane].y * n + food[lane].x;
+	board[old].food &= ~bit;
+	foodInColumn[food[lane].x] &= ~bit;
+	foodInRow[food[lane].y] &= ~bit;
+	food[lane] = Cell{ cell % n, cell / n };
+	board[cell].food |= bit;
+	foodInColumn[food[lane].x] |= bit;
+	foodInRow[food[lane].y] |= bit;
+}
+
+// Function to move a lane's power-up to a cell (-1 takes it off the board)
+void BitslicedEngine::placePowerup(int lane, int cell) {
+	uint64_t bit = 1ULL << lane;
+	int n = rules.cellCount;
+	if (powerup[lane].x >= 0) board[powerup[lane].y * n + powerup[lane].x].powerup &= ~bit;
+	powerup[lane] = cell < 0 ? Cell{ -1, -1 } : Cell{ cell % n, cell / n };
+	if (cell >= 0) board[cell].powerup |= bit;
+}
+
+void BitslicedEngine::startLane(int lane, uint64_t matchSeed) {
+	uint64_t bit = 1ULL << lane;
+	rng[lane] = SimRng(matchSeed);
+	seed[lane] = matchSeed;
+	tick[lane] = 0;
+	powerupOnTime[lane] = powerupOffTime[lane] = 0;
+	active |= bit;
+	grow[0] &= ~bit;
+	grow[1] &= ~bit;
+	showPowerup &= ~bit;
+	placeSnake(0, lane, rules.start1, rules.dir1);
+	placeSnake(1, lane, rules.start2, rules.dir2);
+	placeFood(lane, randomFreeCell(lane));
+	powerup[lane] = Cell{ -1, -1 };
+	placePowerup(lane, randomFreeCell(lane));  // Hidden until the first gap has passed
+	powerupTimeGap[lane] = rng[lane].randomValue(rules.powerupGapMin, rules.powerupGapMax);
+}
+
+// Function to let one snake eat the food and the power-up in the given lanes
+void BitslicedEngine::eat(int snake, uint64_t foodLanes, uint64_t powerupLanes) {
+	while (foodLanes) {
+		int lane = lowestBit(foodLanes);
+		foodLanes &= foodLanes - 1;
+		placeFood(lane, randomFreeCell(lane));
+		grow[snake] |= 1ULL << lane;
+		score[snake][lane] += rules.foodScore;
+	}
+	while (powerupLanes) {
+		int lane = lowestBit(powerupLanes);
+		powerupLanes &= powerupLanes - 1;
+		placePowerup(lane, -1);
+		showPowerup &= ~(1ULL << lane);
+		grow[snake] |= 1ULL << lane;
+		score[snake][lane] += rules.powerupScore;
+	}
+}
+
+// Function to expire and respawn the power-up of every given lane, like Engine::updatePowerupTimers()
+void BitslicedEngine::updatePowerupTimers(uint64_t lanes) {
+	while (lanes) {
+		int lane = lowestBit(lanes);
+		lanes &= lanes - 1;
+		uint64_t bit = 1ULL << lane;
+		int64_t now = tick[lane];
+		if ((showPowerup & bit) && now - powerupOnTime[lane] >= rules.powerupLifetime) {
+			powerupOnTime[lane] = now;
+			showPowerup &= ~bit;
+			placePowerup(lane, -1);
+		}
+		if (!(showPowerup & bit) && now - powerupOffTime[lane] >= powerupTimeGap[lane]) {
+			powerupOffTime[lane] = now;
+			showPowerup |= bit;
+			powerupOnTime[lane] = now;
+			placePowerup(lane, randomFreeCell(lane));
+		}
+	}
+}
+
+// Function to wipe finished lanes from the board so they can be refilled. Each body is walked from
+// its tail along the step planes, so only the cells the lane actually uses are touched.
+void BitslicedEngine::clearLanes(uint64_t lanes) {
+	uint64_t keep = ~lanes;
+	int n = rules.cellCount;
+	for (int s = 0; s < 2; s++) {
+		for (int32_t c : tailCells[s]) {
+			for (uint64_t found = board[c].tails[s] & lanes; found; found &= found - 1) {
+				int lane = lowestBit(found);
+				uint64_t bit = 1ULL << lane;
+				int cell = c;
+				for (int i = 0; cell >= 0 && i < length[s][lane]; i++) {  // A head off the board ends the walk early
+					board[cell].occupancy[s] &= ~bit;
+					board[cell].heads[s] &= ~bit;
+					board[cell].tails[s] &= ~bit;
+					uint64_t low = board[cell].stepLow[s] & bit, high = board[cell].stepHigh[s] & bit;
+					cell = neighbour[cell * 4 + (low ? 1 : 0) + (high ? 2 : 0)];
+				}
+			}
+		}
+		directionLow[s] &= keep;
+		directionHigh[s] &= keep;
+		grow[s] &= keep;
+	}
+	for (uint64_t found = lanes; found; found &= found - 1) {
+		int lane = lowestBit(found);
+		uint64_t bit = 1ULL << lane;
+		board[food[lane].y * n + food[lane].x].food &= ~bit;
+		foodInColumn[food[lane].x] &= ~bit;
+		foodInRow[food[lane].y] &= ~bit;
+		placePowerup(lane, -1);
+	}
+	showPowerup &= keep;
+	active &= keep;
+}
+
+uint64_t BitslicedEngine::update() {
+	if (!active) return 0;
+	int n = rules.cellCount;
+
+	// Lanes whose food lies left of / right of each column and above / below each row
+	uint64_t foodLeft[MAX_CELLS], foodRight[MAX_CELLS], foodAbove[MAX_CELLS], foodBelow[MAX_CELLS];
+	uint64_t seen = 0, seenRows = 0;
+	for (int i = 0; i < n; i++) {
+		foodLeft[i] = seen;
+		foodAbove[i] = seenRows;
+		seen |= foodInColumn[i];
+		seenRows |= foodInRow[i];
+	}
+	seen = seenRows = 0;
+	for (int i = n - 1; i >= 0; i--) {
+		foodRight[i] = seen;
+		foodBelow[i] = seenRows;
+		seen |= foodInColumn[i];
+		seenRows |= foodInRow[i];
+	}
+
+	// 1. Every snake picks its move from the occupancy before the tick and its head moves into
+	//    movedHeads; the step is recorded on the cell it leaves so the tail can follow later
+	uint64_t wall[2] = { 0, 0 };
+	for (int s = 0; s < 2; s++) {
+		uint64_t current[4];
+		splitDirections(directionLow[s], directionHigh[s], current);
+		uint64_t newLow = 0, newHigh = 0;
+		beginList();
+		for (int32_t c : headCells[s]) {
+			uint64_t h = board[c].heads[s];
+			if (!h) continue;
+			board[c].heads[s] = 0;
+			const int32_t* next = &neighbour[c * 4];
+			uint64_t open[4];
+			for (int k = 0; k < 4; k++) {
+				open[k] = next[k] < 0 ? 0 : ~(board[next[k]].occupancy[0] | board[next[k]].occupancy[1]);
+			}
+
+			// The steady policy: food horizontally, food vertically, straight on, clockwise, counter-clockwise
+			uint64_t go[4] = { 0, 0, 0, 0 };
+			uint64_t pending = h;
+			auto take = [&](int k, uint64_t lanes) {
+				uint64_t taken = pending & lanes & open[k];
+				go[k] |= taken;
+				pending &= ~taken;
+			};
+			int x = c % n, y = c / n;
+			take(DIR_RIGHT, foodRight[x]);
+			take(DIR_LEFT, foodLeft[x]);
+			take(DIR_DOWN, foodBelow[y]);
+			take(DIR_UP, foodAbove[y]);
+			if (pending) {  // Most lanes are settled by the food rules
+				for (int k = 0; k < 4; k++) take(k, current[k]);
+				for (int k = 0; k < 4; k++) take(k, current[(k + 3) & 3]);
+				for (int k = 0; k < 4; k++) take(k, current[(k + 1) & 3]);
+				for (int k = 0; k < 4; k++) go[k] |= pending & current[k];  // Boxed in: keep going and crash
+			}
+
+			uint64_t low = go[DIR_RIGHT] | go[DIR_LEFT];
+			uint64_t high = go[DIR_DOWN] | go[DIR_LEFT];
+			board[c].stepLow[s] = (board[c].stepLow[s] & ~h) | low;
+			board[c].stepHigh[s] = (board[c].stepHigh[s] & ~h) | high;
+			newLow |= low;
+			newHigh |= high;
+			if (!(h & (h - 1))) {  // One lane on the cell (the usual case): no search over directions
+				int lane = lowestBit(h);
+				int to = next[(low >> lane & 1) | (high >> lane & 1) << 1];
+				if (to < 0) {
+					wall[s] |= h;
+				} else {
+					board[to].movedHeads[s] |= h;
+					listCell(to);
+				}
+				continue;
+			}
+			for (int k = 0; k < 4; k++) {
+				if (!go[k]) continue;
+				if (next[k] < 0) {
+					wall[s] |= go[k];
+				} else {
+					board[next[k]].movedHeads[s] |= go[k];
+					listCell(next[k]);
+				}
+			}
+		}
+		directionLow[s] = newLow;
+		directionHigh[s] = newHigh;
+		headCells[s].swap(scratchCells);
+	}
+
+	// 2. Tails follow their bodies, except in lanes where the snake grows this move
+	for (int s = 0; s < 2; s++) {
+		uint64_t keep = grow[s];
+		beginList();
+		for (int32_t c : tailCells[s]) {
+			uint64_t t = board[c].tails[s];
+			if (!t) continue;
+			uint64_t moving = t & ~keep;
+			if (moving) {
+				board[c].occupancy[s] &= ~moving;
+				board[c].tails[s] = t & ~moving;
+				uint64_t low = board[c].stepLow[s], high = board[c].stepHigh[s];
+				if (!(moving & (moving - 1))) {  // One lane, as for heads
+					int lane = lowestBit(moving);
+					int next = neighbour[c * 4 + ((low >> lane & 1) | (high >> lane & 1) << 1)];
+					board[next].movedTails[s] |= moving;
+					listCell(next);
+				} else {
+					uint64_t to[4];
+					splitDirections(low, high, to);
+					for (int k = 0; k < 4; k++) {
+						uint64_t lanes = moving & to[k];
+						if (!lanes) continue;
+						int next = neighbour[c * 4 + k];  // The next segment is always on the board
+						board[next].movedTails[s] |= lanes;
+						listCell(next);
+					}
+				}
+			}
+			if (board[c].tails[s]) listCell(c);
+		}
+		for (int32_t c : scratchCells) {
+			board[c].tails[s] |= board[c].movedTails[s];
+			board[c].movedTails[s] = 0;
+		}
+		tailCells[s].swap(scratchCells);
+		for (uint64_t lanes = keep & active; lanes; lanes &= lanes - 1) length[s][lowestBit(lanes)]++;
+		grow[s] = 0;
+	}
+
+	// 3. Test every moved head against the bodies left after the tails moved, then place the heads
+	uint64_t self[2] = { 0, 0 }, opponent[2] = { 0, 0 }, headOn = 0;
+	uint64_t onFood[2] = { 0, 0 }, onPowerup[2] = { 0, 0 };
+	for (int s = 0; s < 2; s++) {
+		for (int32_t c : headCells[s]) {
+			uint64_t h = board[c].movedHeads[s];
+			uint64_t other = board[c].movedHeads[1 - s];
+			self[s] |= h & board[c].occupancy[s];
+			opponent[s] |= h & (board[c].occupancy[1 - s] | other);
+			headOn |= h & other;
+			onFood[s] |= h & board[c].food;
+			onPowerup[s] |= h & board[c].powerup;
+		}
+	}
+	for (int s = 0; s < 2; s++) {
+		for (int32_t c : headCells[s]) {
+			board[c].occupancy[s] |= board[c].movedHeads[s];
+			board[c].heads[s] |= board[c].movedHeads[s];
+			board[c].movedHeads[s] = 0;
+		}
+	}
+
+	// 4. Eat and decide the winners with the same rules as Engine::resolveSequential/Simultaneous
+	uint64_t win1 = 0, win2 = 0, draw = 0;
+	if (rules.simultaneous) {
+		uint64_t dead1 = wall[0] | self[0] | opponent[0];
+		uint64_t dead2 = wall[1] | self[1] | opponent[1];
+		draw = dead1 & dead2;
+		win1 = dead2 & ~dead1;
+		win2 = dead1 & ~dead2;
+		eat(0, onFood[0] & ~dead1, onPowerup[0] & ~dead1 & showPowerup);
+		eat(1, onFood[1] & ~dead2, onPowerup[1] & ~dead2 & showPowerup);
+	} else {
+		// Snake 1 eats first, so on a head-on crash over an item snake 2 finds it gone
+		eat(0, onFood[0], onPowerup[0]);
+		eat(1, onFood[1] & ~onFood[0], onPowerup[1] & ~onPowerup[0]);
+		uint64_t decided = 0;  // The last check to fire names the winner, so walk them backwards
+		auto fire = [&](uint64_t lanes, uint64_t& win) {
+			win |= lanes & ~decided;
+			decided |= lanes;
+		};
+		fire(opponent[1], win1);
+		fire(opponent[0], win2);
+		fire(self[1], win1);
+		fire(self[0], win2);
+		fire(wall[1], win1);
+		fire(wall[0], win2);
+	}
+
+	// 5. Count the tick, report finished lanes and run the power-up timers of the rest
+	uint64_t decided = win1 | win2 | draw;
+	uint64_t finished = decided;
+	for (uint64_t lanes = active; lanes; lanes &= lanes - 1) {
+		int lane = lowestBit(lanes);
+		if (++tick[lane] >= maxTicks) finished |= 1ULL << lane;
+	}
+	for (uint64_t lanes = finished; lanes; lanes &= lanes - 1) {
+		int lane = lowestBit(lanes);
+		uint64_t bit = 1ULL << lane;
+		MatchResult& r = result[lane];
+		r.seed = seed[lane];
+		r.winner = (win1 & bit) ? 1 : (win2 & bit) ? 2 : (draw & bit) ? DRAW : NO_WINNER;
+		r.ticks = (int)tick[lane];
+		for (int s = 0; s < 2; s++) {
+			r.score[s] = score[s][lane];
+			r.length[s] = length[s][lane];
+			r.deathCause[s] = !(decided & bit) ? DEATH_NONE : (wall[s] & bit) ? DEATH_WALL : (headOn & bit) ? DEATH_HEAD_ON :
+				(self[s] & bit) ? DEATH_SELF : (opponent[s] & bit) ? DEATH_OPPONENT : DEATH_NONE;
+		}
+	}
+	if (finished) clearLanes(finished);
+	updatePowerupTimers(active);
+	return finished;
+}
+
+void playBitsliced(const Rules& rules, int maxTicks, const uint64_t* seeds, size_t count, MatchResult* results) {
+	BitslicedEngine engine(rules, maxTicks);
+	size_t laneMatch[BitslicedEngine::LANES];
+	size_t next = 0;
+	for (int lane = 0; lane < BitslicedEngine::LANES && next < count; lane++) {
+		laneMatch[lane] = next;
+		engine.startLane(lane, seeds[next++]);
+	}
+	while (engine.active) {
+		for (uint64_t finished = engine.update(); finished; finished &= finished - 1) {
+			int lane = lowestBit(finished);
+			results[laneMatch[lane]] = engine.result[lane];
+			if (next < count) {
+				laneMatch[lane] = next;
+				engine.startLane(lane, seeds[next++]);
+			}
+		}
+	}
+}
@@ -0,0 +1,185 @@
+#include "Bot.h"
+#include "Bitboard.h"
+#include "BotPlugin.h"
+#include "BotVM.h"
+#include "InferenceBroker.h"
+#include "Policy.h"
+#include "ProcessBot.h"
+#include "Search.h"
+#include "Tablebase.h"
+#include "Tuner.h"
+#include <cctype>        // For isdigit
+#include <cstdlib>       // For abs, atoi and atof
+using namespace std;
+
+// Bot that wanders randomly but never steps into a wall or a body if it can help it
+class RandomBot : public Bot {
+public:
+	SimRng rng;  // Private random stream
+
+	explicit RandomBot(uint64_t seed) : rng(seed) {}
+
+	Dir chooseMove(const Engine& engine, int snake) override {
+		Dir current = engine.snakes[snake].direction;
+		int first = rng.randomValue(0, 3);
+		for (int i = 0; i < 4; i++) {
+			Dir d = (Dir)((first + i) & 3);
+			if (d != oppositeDir(current) && isSafeMove(engine, snake, d)) return d;
+		}
+		return current;
+	}
+};
+
+// Bot that heads for the food (or the visible power-up if it is closer) along safe moves
+class GreedyBot : public Bot {
+public:
+	SimRng rng;        // Private random stream for tie-breaks
+	bool cautious;     // Also avoid cells the opponent's head can reach next tick
+
+	GreedyBot(uint64_t seed, bool avoidHeads) : rng(seed), cautious(avoidHeads) {}
+
+	Dir chooseMove(const Engine& engine, int snake) override {
+		const EngineSnake& self = engine.snakes[snake];
+		Cell head = self.head();
+		Cell target = engine.food;
+		if (engine.showPowerup && distance(head, engine.powerup) < distance(head, target)) target = engine.powerup;
+
+		Dir best = self.direction;
+		int bestScore = -1000000;
+		int first = rng.randomValue(0, 3);
+		for (int i = 0; i < 4; i++) {
+			Dir d = (Dir)((first + i) & 3);
+			if (d == oppositeDir(self.direction) || !isSafeMove(engine, snake, d)) continue;
+			Cell next = stepCell(head, d);
+			int score = -distance(next, target);
+			if (cautious) {
+				if (distance(next, engine.snakes[1 - snake].head()) == 1) score -= 1000;  // Possible head-on crash
+				score += 2 * freeNeighbours(engine, next);
+			}
+			if (score > bestScore) {
+				bestScore = score;
+				best = d;
+			}
+		}
+		return best;
+	}
+
+private:
+	static int distance(Cell a, Cell b) { return abs(a.x - b.x) + abs(a.y - b.y); }
+
+	static int freeNeighbours(const Engine& engine, Cell c) {
+		int count = 0;
+		for (int d = 0; d < 4; d++) {
+			Cell n = stepCell(c, (Dir)d);
+			count += engine.inBounds(n) && !engine.occupied(n);
+		}
+		return count;
+	}
+};
+
+// Bot that heads for the food without any randomness: it tries the horizontal step towards the food,
+// the vertical one, straight on, a clockwise turn and a counter-clockwise turn, and takes the first
+// safe one. BitslicedEngine runs this exact policy on 64 matches at once.
+class SteadyBot : public Bot {
+public:
+	Dir chooseMove(const Engine& engine, int snake) override {
+		const EngineSnake& self = engine.snakes[snake];
+		Cell head = self.head();
+		Dir current = self.direction;
+		Dir order[5] = { engine.food.x > head.x ? DIR_RIGHT : DIR_LEFT, engine.food.y > head.y ? DIR_DOWN : DIR_UP,
+			current, (Dir)((current + 1) & 3), (Dir)((current + 3) & 3) };
+		bool wanted[5] = { engine.food.x != head.x, engine.food.y != head.y, true, true, true };
+		for (int i = 0; i < 5; i++) {
+			if (wanted[i] && isSafeMove(engine, snake, order[i])) return order[i];
+		}
+		return current;
+	}
+};
+
+// Bot that heads for the food like the cautious bot, but counts the cells it can still reach after
+// each move and only walks into a region smaller than its own body when every move does
+class RoomyBot : public Bot {
+public:
+	SimRng rng;  // Private random stream for tie-breaks
+
+	explicit RoomyBot(uint64_t seed) : rng(seed) {}
+
+	Dir chooseMove(const Engine& engine, int snake) override {
+		const EngineSnake& self = engine.snakes[snake];
+		Cell head = self.head();
+		Cell target = engine.food;
+		if (engine.showPowerup && distance(head, engine.powerup) < distance(head, target)) target = engine.powerup;
+		int areas[4] = { 0, 0, 0, 0 };
+		bool counted = engine.rules.cellCount <= Bitboard::MAX_CELLS;
+		if (counted) moveAreas(engine, snake, areas);
+
+		Dir best = self.direction;
+		int bestScore = -1000000;
+		int first = rng.randomValue(0, 3);
+		for (int i = 0; i < 4; i++) {
+			Dir d = (Dir)((first + i) & 3);
+			if (d == oppositeDir(self.direction) || !isSafeMove(engine, snake, d)) continue;
+			Cell next = stepCell(head, d);
+			int score = -distance(next, target);
+			if (distance(next, engine.snakes[1 - snake].head()) == 1) score -= 1000;  // Possible head-on crash
+			if (counted && areas[d] < self.length) score += 100 * areas[d] - 100000;  // Trap; prefer the larger one
+			if (score > bestScore) {
+				bestScore = score;
+				best = d;
+			}
+		}
+		return best;
+	}
+
+private:
+	static int distance(Cell a, Cell b) { return abs(a.x - b.x) + abs(a.y - b.y); }
+};
+
+unique_ptr<Bot> createBot(const string& name, uint64_t seed) {
+	if (name == "random") return unique_ptr<Bot>(new RandomBot(seed));
+	if (name == "greedy") return unique_ptr<Bot>(new GreedyBot(seed, false));
+	if (name == "cautious") return unique_ptr<Bot>(new GreedyBot(seed, true));
+	if (name == "steady") return unique_ptr<Bot>(new SteadyBot());
+	if (name == "roomy") return unique_ptr<Bot>(new RoomyBot(seed));
+	if (name == "minimax") return unique_ptr<Bot>(new MinimaxBot());
+	if (name.compare(0, 8, "minimax:") == 0 && atof(name.c_str() + 8) > 0) {
+		return unique_ptr<Bot>(new MinimaxBot(atof(name.c_str() + 8) / 1000));  // "minimax:MS" thinks MS milliseconds per move
+	}
+	if (name.compare(0, 3, "nn:") == 0) {
+		shared_ptr<InferenceBroker> broker = policyBroker(name.substr(3));  // Batched when enabled
+		if (broker) return unique_ptr<Bot>(new BrokeredPolicyBot(broker));
+		shared_ptr<const PolicyNet> net = loadPolicy(name.substr(3));  // "nn:PATH" plays the weights file at PATH
+		if (net) return unique_ptr<Bot>(new PolicyBot(net));
+	}
+	if (name.compare(0, 7, "plugin:") == 0) {
+		shared_ptr<PluginLibrary> library = loadPlugin(name.substr(7));  // "plugin:PATH" plays a shared library
+		if (library) return unique_ptr<Bot>(new PluginBot(library, seed));
+	}
+	if (name.compare(0, 3, "vm:") == 0) {
+		string path = name.substr(3);
+		int budget = VMBot::DEFAULT_BUDGET;
+		size_t digits = 0;
+		while (digits < path.size() && isdigit((unsigned char)path[digits])) digits++;
+		if (digits > 0 && digits < path.size() && path[digits] == ':') {  // "vm:BUDGET:PATH"
+			budget = atoi(path.c_str());
+			path = path.substr(digits + 1);
+		}
+		shared_ptr<const VMProgram> program = loadProgram(path);
+		if (program) return unique_ptr<Bot>(new VMBot(program, budget));
+	}
+	if (name.compare(0, 10, "tablebase:") == 0) {
+		shared_ptr<const Tablebase> tablebase = loadTablebase(name.substr(10));  // "tablebase:PATH" plays from a tablebase file
+		if (tablebase) return unique_ptr<Bot>(new TablebaseBot(tablebase, seed));
+	}
+	if (name == "weighted") return unique_ptr<Bot>(new WeightedBot(TunerWeights(), seed));
+	if (name.compare(0, 9, "weighted:") == 0) {
+		TunerWeights weights;  // "weighted:W1:W2:W3:W4" plays tuned heuristic weights
+		if (parseWeights(name.substr(9), weights)) return unique_ptr<Bot>(new WeightedBot(weights, seed));
+	}
+	if (name.compare(0, 8, "process:") == 0) return createProcessBot(name.substr(8), seed);  // "process:[MS:]COMMAND"
+	return nullptr;
+}
+
+vector<string> builtinBotNames() {
+	return { "random", "greedy", "cautious", "steady", "roomy", "minimax", "weighted" };
+}
@@ -0,0 +1,32 @@
+#pragma once
+// Computer players for headless matches.
+// A bot is created per match (so it may keep state between moves) and asked for a direction once
+// per tick. New bots are added to createBot() in Bot.cpp.
+#include <memory>        // For unique_ptr
+#include <string>        // For bot names
+#include <vector>        // For the list of built-in bots
+#include "Engine.h"
+
+class Bot {
+public:
+	virtual ~Bot() {}
+
+	// Function to pick the next direction for `snake` (0 or 1) from the current engine state
+	virtual Dir chooseMove(const Engine& engine, int snake) = 0;
+};
+
+// Function to create a bot by name ("minimax:MS" gives the minimax bot MS milliseconds per move,
+// "nn:PATH" plays a neural-network policy from a weights file, "plugin:PATH" a bot plugin library,
+// "process:[MS:]COMMAND" a bot process over shared memory, "vm:[BUDGET:]PATH" a bytecode program,
+// "tablebase:PATH" an endgame tablebase, "weighted:W1:W2:W3:W4" the heuristic bot with tuned weights);
+// returns nullptr for unknown names
+std::unique_ptr<Bot> createBot(const std::string& name, uint64_t seed);
+
+// Function to list the names createBot() accepts
+std::vector<std::string> builtinBotNames();
+
+// Function to check if a move leads into a free in-bounds cell (tails are treated as solid)
+inline bool isSafeMove(const Engine& engine, int snake, Dir d) {
+	Cell next = stepCell(engine.snakes[snake].head(), d);
+	return engine.inBounds(next) && !engine.occupied(next);
+}
@@ -0,0 +1,180 @@
+#include "BotPlugin.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <atomic>        // For unique copy names
+#include <cstdio>        // For copying the library and reporting reloads
+#include <cstdlib>       // For getenv
+#include <map>           // For the plugin registry
+#include <mutex>         // For the plugin registry
+#include <type_traits>   // For the layout check
+using namespace std;
+
+static_assert(sizeof(Cell) == sizeof(SnakePluginCell) && is_standard_layout<Cell>::value,
+	"Engine cells are handed to plugins as SnakePluginCell");
+
+// Modification time and size of a file, to notice when it is replaced
+struct FileStamp {
+	int64_t time = 0;
+	int64_t size = -1;  // -1 when the file cannot be read
+
+	bool operator==(const FileStamp& other) const { return time == other.time && size == other.size; }
+};
+
+// Function to copy a file; false if either side cannot be opened or written
+static bool copyFile(const string& from, const string& to) {
+	FILE* in = fopen(from.c_str(), "rb");
+	if (!in) return false;
+	FILE* out = fopen(to.c_str(), "wb");
+	if (!out) {
+		fclose(in);
+		return false;
+	}
+	char buffer[1 << 16];
+	size_t n;
+	bool ok = true;
+	while (ok && (n = fread(buffer, 1, sizeof(buffer), in)) > 0) ok = fwrite(buffer, 1, n, out) == n;
+	ok = !ferror(in) && ok;
+	fclose(in);
+	return fclose(out) == 0 && ok;
+}
+
+static atomic<unsigned> copyCounter(0);
+
+#ifdef _WIN32
+static FileStamp fileStamp(const string& path) {
+	FileStamp stamp;
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) return stamp;
+	stamp.time = ((int64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+	stamp.size = ((int64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	return stamp;
+}
+
+shared_ptr<PluginLibrary> PluginLibrary::open(const string& path, string& error) {
+	char directory[MAX_PATH + 1];
+	DWORD length = GetTempPathA(sizeof(directory), directory);
+	if (length == 0 || length > MAX_PATH) { error = "no temporary directory"; return nullptr; }
+	string copy = string(directory) + "snake_plugin_" + to_string(GetCurrentProcessId()) + "_" + to_string(copyCounter++) + ".dll";
+	if (!copyFile(path, copy)) { error = "cannot copy the library"; return nullptr; }
+	HMODULE module = LoadLibraryA(copy.c_str());
+	if (!module) {
+		DeleteFileA(copy.c_str());
+		error = "LoadLibrary failed with error " + to_string(GetLastError());
+		return nullptr;
+	}
+	shared_ptr<PluginLibrary> library(new PluginLibrary());
+	library->handle = module;
+	library->copyPath = copy;
+	SnakePluginAbiFn abi = (SnakePluginAbiFn)(void*)GetProcAddress(module, "snake_plugin_abi");
+	library->init = (SnakePluginInitFn)(void*)GetProcAddress(module, "snake_plugin_init");
+	library->chooseMove = (SnakePluginChooseMoveFn)(void*)GetProcAddress(module, "snake_plugin_choose_move");
+	library->shutdown = (SnakePluginShutdownFn)(void*)GetProcAddress(module, "snake_plugin_shutdown");
+	if (!abi || !library->init || !library->chooseMove || !library->shutdown) { error = "missing exports"; return nullptr; }
+	if (abi() != SNAKE_PLUGIN_ABI) { error = "built for interface version " + to_string(abi()); return nullptr; }
+	return library;
+}
+
+PluginLibrary::~PluginLibrary() {
+	if (handle) FreeLibrary((HMODULE)handle);
+	if (!copyPath.empty()) DeleteFileA(copyPath.c_str());
+}
+#else
+static FileStamp fileStamp(const string& path) {
+	FileStamp stamp;
+	struct stat info;
+	if (stat(path.c_str(), &info) != 0) return stamp;
+	stamp.time = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+	stamp.size = (int64_t)info.st_size;
+	return stamp;
+}
+
+shared_ptr<PluginLibrary> PluginLibrary::open(const string& path, string& error) {
+	const char* directory = getenv("TMPDIR");
+	string copy = string(directory && *directory ? directory : "/tmp") + "/snake_plugin_" + to_string(getpid()) + "_" +
+		to_string(copyCounter++) + ".so";
+	if (!copyFile(path, copy)) { error = "cannot copy the library"; return nullptr; }
+	void* module = dlopen(copy.c_str(), RTLD_NOW | RTLD_LOCAL);
+	unlink(copy.c_str());  // The mapping stays valid; nothing is left behind if the process dies
+	if (!module) {
+		const char* message = dlerror();
+		error = message ? message : "dlopen failed";
+		return nullptr;
+	}
+	shared_ptr<PluginLibrary> library(new PluginLibrary());
+	library->handle = module;
+	SnakePluginAbiFn abi = (SnakePluginAbiFn)dlsym(module, "snake_plugin_abi");
+	library->init = (SnakePluginInitFn)dlsym(module, "snake_plugin_init");
+	library->chooseMove = (SnakePluginChooseMoveFn)dlsym(module, "snake_plugin_choose_move");
+	library->shutdown = (SnakePluginShutdownFn)dlsym(module, "snake_plugin_shutdown");
+	if (!abi || !library->init || !library->chooseMove || !library->shutdown) { error = "missing exports"; return nullptr; }
+	if (abi() != SNAKE_PLUGIN_ABI) { error = "built for interface version " + to_string(abi()); return nullptr; }
+	return library;
+}
+
+PluginLibrary::~PluginLibrary() {
+	if (handle) dlclose(handle);
+}
+#endif
+
+// Latest library loaded for a path, and the stamp of the file it was loaded from
+struct LoadedPlugin {
+	shared_ptr<PluginLibrary> library;
+	FileStamp stamp;      // File the library came from
+	FileStamp rejected;   // Last file that failed to load, so it is reported once
+};
+
+shared_ptr<PluginLibrary> loadPlugin(const string& path) {
+	static mutex lock;
+	static map<string, LoadedPlugin> loaded;
+	lock_guard<mutex> guard(lock);
+	LoadedPlugin& entry = loaded[path];
+	FileStamp stamp = fileStamp(path);
+	if (stamp.size < 0 || stamp == entry.stamp || stamp == entry.rejected) return entry.library;
+	string error;
+	shared_ptr<PluginLibrary> library = PluginLibrary::open(path, error);
+	if (!library) {
+		fprintf(stderr, "Cannot load plugin '%s': %s\n", path.c_str(), error.c_str());
+		entry.rejected = stamp;
+		return entry.library;  // Keep playing the previous version, if there is one
+	}
+	if (entry.library) fprintf(stderr, "Reloaded plugin '%s'\n", path.c_str());
+	entry.library = library;
+	entry.stamp = stamp;
+	return library;
+}
+
+PluginBot::PluginBot(shared_ptr<PluginLibrary> library, uint64_t seed) : plugin(library) {
+	context = plugin->init(seed);
+}
+
+PluginBot::~PluginBot() {
+	plugin->shutdown(context);
+}
+
+Dir PluginBot::chooseMove(const Engine& engine, int snake) {
+	SnakePluginState state;
+	state.board = engine.rules.cellCount;
+	state.you = snake;
+	state.tick = engine.tick;
+	state.food = SnakePluginCell{ engine.food.x, engine.food.y };
+	state.powerup = engine.showPowerup ? SnakePluginCell{ engine.powerup.x, engine.powerup.y } : SnakePluginCell{ -1, -1 };
+	for (int s = 0; s < 2; s++) {
+		const EngineSnake& body = engine.snakes[s];
+		state.snakes[s].ring = reinterpret_cast<const SnakePluginCell*>(body.ring.data());
+		state.snakes[s].mask = body.mask;
+		state.snakes[s].head = body.headIndex;
+		state.snakes[s].length = body.length;
+		state.snakes[s].direction = body.direction;
+		state.snakes[s].score = body.score;
+		state.occupancy[s] = engine.occupancy[s].data();
+	}
+	int32_t move = plugin->chooseMove(context, &state);
+	return move >= 0 && move < 4 ? (Dir)move : engine.snakes[snake].direction;
+}
@@ -0,0 +1,54 @@
+#pragma once
+// Bots loaded from shared libraries (see SnakePlugin.h for the interface a plugin implements).
+// A PluginBot fills a SnakePluginState with pointers into the engine and calls the plugin directly,
+// so a move costs one indirect call plus whatever the plugin does.
+//
+// Hot reload: every time a "plugin:PATH" bot is created (once per match) the file's modification time
+// and size are checked. If they changed, the new file is loaded and later matches use it, while
+// matches already running finish with the version they started with. The loader copies the file
+// to a private temporary path before opening it, because the dynamic loader hands back the already
+// loaded library for a path it has seen. Replace a plugin by writing a new file and renaming it
+// over the old one: a library that is rewritten in place while loaded can crash the host.
+#include <cstdint>       // For fixed-width integer types
+#include <memory>        // For sharing a loaded library between bots
+#include <string>        // For paths and errors
+#include "Bot.h"
+#include "SnakePlugin.h"
+
+// One loaded copy of a plugin library; unloaded when its last bot is gone
+class PluginLibrary {
+public:
+	SnakePluginInitFn init = nullptr;
+	SnakePluginChooseMoveFn chooseMove = nullptr;
+	SnakePluginShutdownFn shutdown = nullptr;
+
+	~PluginLibrary();
+
+	// Function to load a library from path (through a private copy); nullptr with a message in error
+	// if it cannot be loaded or does not export the interface
+	static std::shared_ptr<PluginLibrary> open(const std::string& path, std::string& error);
+
+private:
+	void* handle = nullptr;  // dlopen or LoadLibrary handle
+	std::string copyPath;    // Private copy (deleted once unloaded on Windows, right after loading elsewhere)
+};
+
+// Function to get the current library for a plugin file, reloading it if the file changed since it
+// was last loaded; nullptr if it has never loaded successfully
+std::shared_ptr<PluginLibrary> loadPlugin(const std::string& path);
+
+// Bot backed by a plugin library
+class PluginBot : public Bot {
+public:
+	PluginBot(std::shared_ptr<PluginLibrary> library, uint64_t seed);
+	~PluginBot() override;
+
+	PluginBot(const PluginBot&) = delete;
+	PluginBot& operator=(const PluginBot&) = delete;
+
+	Dir chooseMove(const Engine& engine, int snake) override;
+
+private:
+	std::shared_ptr<PluginLibrary> plugin;
+	void* context;  // Whatever the plugin's init returned
+};
@@ -0,0 +1,332 @@
+#include "BotVM.h"
+#include <atomic>        // For the statistics
+#include <cstdio>        // For reading program files and reporting errors
+#include <cstdlib>       // For strtoll
+#include <cstring>       // For strcmp
+#include <map>           // For the program cache
+#include <mutex>         // For the program cache
+using namespace std;
+
+#if defined(__GNUC__)
+#define VM_COMPUTED_GOTO 1  // Labels as values: one indirect jump per instruction, no bounds check
+#endif
+
+// Queries for the get instruction: X(name, assembly name)
+#define VM_QUERIES(X) \
+	X(BOARD, "board") X(TICK, "tick") X(HEAD_X, "head_x") X(HEAD_Y, "head_y") X(DIRECTION, "direction") \
+	X(LENGTH, "length") X(SCORE, "score") X(OPP_HEAD_X, "opp_head_x") X(OPP_HEAD_Y, "opp_head_y") \
+	X(OPP_DIRECTION, "opp_direction") X(OPP_LENGTH, "opp_length") X(OPP_SCORE, "opp_score") \
+	X(FOOD_X, "food_x") X(FOOD_Y, "food_y") X(POWERUP_X, "powerup_x") X(POWERUP_Y, "powerup_y")
+
+enum VMQuery {
+#define VM_QUERY_ENUM(name, text) QUERY_##name,
+	VM_QUERIES(VM_QUERY_ENUM)
+#undef VM_QUERY_ENUM
+	QUERY_COUNT
+};
+
+static const char* const OP_NAMES[VM_OP_COUNT] = {
+#define VM_OP_NAME(name, mnemonic, operands) mnemonic,
+	VM_OPS(VM_OP_NAME)
+#undef VM_OP_NAME
+};
+
+static const char* const OP_OPERANDS[VM_OP_COUNT] = {
+#define VM_OP_OPERANDS(name, mnemonic, operands) operands,
+	VM_OPS(VM_OP_OPERANDS)
+#undef VM_OP_OPERANDS
+};
+
+static const char* const QUERY_NAMES[QUERY_COUNT] = {
+#define VM_QUERY_NAME(name, text) text,
+	VM_QUERIES(VM_QUERY_NAME)
+#undef VM_QUERY_NAME
+};
+
+static const int RUN_EXHAUSTED = -2;  // run() result for a move that used up its budget
+
+// Function to split an assembly line into label and tokens, dropping the comment
+static void tokenize(const string& line, vector<string>& tokens) {
+	tokens.clear();
+	string token;
+	for (char ch : line) {
+		if (ch == ';') break;
+		if (ch == ',' || ch == ' ' || ch == '\t' || ch == '\r') {
+			if (!token.empty()) tokens.push_back(token);
+			token.clear();
+		} else {
+			token += ch;
+			if (ch == ':') {  // A label ends at its colon, even without a space after it
+				tokens.push_back(token);
+				token.clear();
+			}
+		}
+	}
+	if (!token.empty()) tokens.push_back(token);
+}
+
+// Function to parse "r0".."r15"; -1 if the token is not a register
+static int parseRegister(const string& token) {
+	if (token.size() < 2 || token.size() > 3 || (token[0] != 'r' && token[0] != 'R')) return -1;
+	int n = 0;
+	for (size_t i = 1; i < token.size(); i++) {
+		if (token[i] < '0' || token[i] > '9') return -1;
+		n = n * 10 + (token[i] - '0');
+	}
+	return n < VMProgram::REGISTERS ? n : -1;
+}
+
+// Function to parse a 32-bit integer (decimal, or hex with 0x)
+static bool parseInteger(const string& token, int32_t& value) {
+	char* end;
+	long long n = strtoll(token.c_str(), &end, 0);
+	if (token.empty() || *end != '\0' || n < INT32_MIN || n > INT32_MAX) return false;
+	value = (int32_t)n;
+	return true;
+}
+
+bool VMProgram::assemble(const string& source, string& error) {
+	code.clear();
+	map<string, int> labels;
+	vector<pair<size_t, string>> fixups;  // Instruction index and label of each jump
+	vector<int> lines;                     // Source line of each instruction
+	vector<string> tokens;
+	size_t start = 0;
+	for (int lineNumber = 1; start <= source.size(); lineNumber++) {
+		size_t end = source.find('\n', start);
+		if (end == string::npos) end = source.size();
+		tokenize(source.substr(start, end - start), tokens);
+		start = end + 1;
+		auto fail = [&](const string& message) {
+			error = "line " + to_string(lineNumber) + ": " + message;
+			code.clear();
+			return false;
+		};
+		size_t t = 0;
+		while (t < tokens.size() && tokens[t].back() == ':') {
+			string label = tokens[t].substr(0, tokens[t].size() - 1);
+			if (label.empty() || labels.count(label)) return fail("bad or repeated label '" + label + "'");
+			labels[label] = (int)code.size();
+			t++;
+		}
+		if (t == tokens.size()) continue;
+
+		int op = 0;
+		while (op < VM_OP_COUNT && tokens[t] != OP_NAMES[op]) op++;
+		if (op == VM_OP_COUNT) return fail("unknown instruction '" + tokens[t] + "'");
+		const char* operands = OP_OPERANDS[op];
+		if (tokens.size() - t - 1 != strlen(operands)) {
+			return fail("'" + tokens[t] + "' takes " + to_string(strlen(operands)) + " operands");
+		}
+		if ((int)code.size() >= MAX_INSTRUCTIONS - 1) return fail("program too long");
+		VMInstruction instruction = { (uint8_t)op, 0, 0, 0, 0 };
+		int registers = 0;
+		for (size_t k = 0; operands[k]; k++) {
+			const string& token = tokens[t + 1 + k];
+			if (operands[k] == 'R') {
+				int r = parseRegister(token);
+				if (r < 0) return fail("expected a register r0..r15, got '" + token + "'");
+				(registers == 0 ? instruction.a : registers == 1 ? instruction.b : instruction.c) = (uint8_t)r;
+				registers++;
+			} else if (operands[k] == 'I') {
+				if (!parseInteger(token, instruction.value)) return fail("expected an integer, got '" + token + "'");
+			} else if (operands[k] == 'L') {
+				fixups.push_back(make_pair(code.size(), token));
+			} else {
+				int q = 0;
+				while (q < QUERY_COUNT && token != QUERY_NAMES[q]) q++;
+				if (q == QUERY_COUNT) return fail("unknown query '" + token + "'");
+				instruction.value = q;
+			}
+		}
+		code.push_back(instruction);
+		lines.push_back(lineNumber);
+	}
+	code.push_back(VMInstruction{ VM_HALT, 0, 0, 0, 0 });  // Running off the end keeps direction
+	for (const auto& fixup : fixups) {
+		auto found = labels.find(fixup.second);
+		if (found == labels.end()) {
+			error = "line " + to_string(lines[fixup.first]) + ": unknown label '" + fixup.second + "'";
+			code.clear();
+			return false;
+		}
+		code[fixup.first].value = found->second;
+	}
+	return verify(error);
+}
+
+bool VMProgram::verify(string& error) const {
+	if (code.empty() || (int)code.size() > MAX_INSTRUCTIONS || code.back().op != VM_HALT) {
+		error = "program must hold 1.." + to_string(MAX_INSTRUCTIONS) + " instructions and end in halt";
+		return false;
+	}
+	for (size_t i = 0; i < code.size(); i++) {
+		const VMInstruction& in = code[i];
+		bool ok = in.op < VM_OP_COUNT && in.a < REGISTERS && in.b < REGISTERS && in.c < REGISTERS;
+		if (ok && (in.op == VM_JMP || in.op == VM_JZ || in.op == VM_JNZ)) ok = in.value >= 0 && (size_t)in.value < code.size();
+		if (ok && in.op == VM_GET) ok = in.value >= 0 && in.value < QUERY_COUNT;
+		if (!ok) {
+			error = "instruction " + to_string(i) + " is malformed";
+			return false;
+		}
+	}
+	return true;
+}
+
+// Wrapping arithmetic, so no program can trigger undefined behaviour
+static inline int32_t wrap(uint32_t v) { return (int32_t)v; }
+static inline int32_t divide(int32_t b, int32_t c) { return c == 0 ? 0 : (c == -1 ? wrap(0u - (uint32_t)b) : b / c); }
+static inline int32_t modulo(int32_t b, int32_t c) { return c == 0 || c == -1 ? 0 : b % c; }
+
+int VMProgram::run(const Engine& engine, int snake, int32_t* memory, int budget, int& executed) const {
+	int32_t r[REGISTERS] = {};
+	const EngineSnake& self = engine.snakes[snake];
+	const EngineSnake& other = engine.snakes[1 - snake];
+	const int board = engine.rules.cellCount;
+	const int32_t query[QUERY_COUNT] = { board, (int32_t)engine.tick, self.head().x, self.head().y, self.direction,
+		self.length, self.score, other.head().x, other.head().y, other.direction, other.length, other.score,
+		engine.food.x, engine.food.y, engine.showPowerup ? engine.powerup.x : -1, engine.showPowerup ? engine.powerup.y : -1 };
+	const uint8_t* mine = engine.occupancy[snake].data();
+	const uint8_t* theirs = engine.occupancy[1 - snake].data();
+	const VMInstruction* base = code.data();
+	const VMInstruction* pc = base;
+	int remaining = budget;
+	int result = -1;
+
+#define RA r[pc->a]
+#define RB r[pc->b]
+#define RC r[pc->c]
+#if defined(VM_COMPUTED_GOTO)
+	static const void* const targets[VM_OP_COUNT] = {
+#define VM_TARGET(name, mnemonic, operands) &&op_##name,
+		VM_OPS(VM_TARGET)
+#undef VM_TARGET
+	};
+#define VM_CASE(name) op_##name:
+#define VM_NEXT() do { if (--remaining < 0) goto exhausted; goto *targets[pc->op]; } while (0)
+	VM_NEXT();
+#else
+#define VM_CASE(name) case VM_##name:
+#define VM_NEXT() goto dispatch
+dispatch:
+	if (--remaining < 0) goto exhausted;
+	switch (pc->op) {
+#endif
+	VM_CASE(HALT) goto done;
+	VM_CASE(RET) result = RA >= 0 && RA < 4 ? RA : -1; goto done;
+	VM_CASE(LOADI) RA = pc->value; pc++; VM_NEXT();
+	VM_CASE(MOV) RA = RB; pc++; VM_NEXT();
+	VM_CASE(ADD) RA = wrap((uint32_t)RB + (uint32_t)RC); pc++; VM_NEXT();
+	VM_CASE(ADDI) RA = wrap((uint32_t)RB + (uint32_t)pc->value); pc++; VM_NEXT();
+	VM_CASE(SUB) RA = wrap((uint32_t)RB - (uint32_t)RC); pc++; VM_NEXT();
+	VM_CASE(MUL) RA = wrap((uint32_t)RB * (uint32_t)RC); pc++; VM_NEXT();
+	VM_CASE(DIV) RA = divide(RB, RC); pc++; VM_NEXT();
+	VM_CASE(MOD) RA = modulo(RB, RC); pc++; VM_NEXT();
+	VM_CASE(AND) RA = RB & RC; pc++; VM_NEXT();
+	VM_CASE(OR) RA = RB | RC; pc++; VM_NEXT();
+	VM_CASE(XOR) RA = RB ^ RC; pc++; VM_NEXT();
+	VM_CASE(SHL) RA = wrap((uint32_t)RB << (RC & 31)); pc++; VM_NEXT();
+	VM_CASE(SHR) RA = RB >> (RC & 31); pc++; VM_NEXT();
+	VM_CASE(MIN) RA = RB < RC ? RB : RC; pc++; VM_NEXT();
+	VM_CASE(MAX) RA = RB > RC ? RB : RC; pc++; VM_NEXT();
+	VM_CASE(ABS) RA = RB < 0 ? wrap(0u - (uint32_t)RB) : RB; pc++; VM_NEXT();
+	VM_CASE(LT) RA = RB < RC; pc++; VM_NEXT();
+	VM_CASE(LE) RA = RB <= RC; pc++; VM_NEXT();
+	VM_CASE(EQ) RA = RB == RC; pc++; VM_NEXT();
+	VM_CASE(NE) RA = RB != RC; pc++; VM_NEXT();
+	VM_CASE(JMP) pc = base + pc->value; VM_NEXT();
+	VM_CASE(JZ) pc = RA == 0 ? base + pc->value : pc + 1; VM_NEXT();
+	VM_CASE(JNZ) pc = RA != 0 ? base + pc->value : pc + 1; VM_NEXT();
+	VM_CASE(LOAD) RA = memory[RB & (MEMORY - 1)]; pc++; VM_NEXT();
+	VM_CASE(STORE) memory[RB & (MEMORY - 1)] = RA; pc++; VM_NEXT();
+	VM_CASE(GET) RA = query[pc->value]; pc++; VM_NEXT();
+	VM_CASE(CELL) {
+		int32_t x = RB, y = RC;
+		if (x < 0 || y < 0 || x >= board || y >= board) RA = VM_CELL_WALL;
+		else {
+			int index = y * board + x;
+			Cell c = Cell{ x, y };
+			RA = mine[index] ? VM_CELL_SELF : theirs[index] ? VM_CELL_OPPONENT : c == engine.food ? VM_CELL_FOOD :
+				engine.showPowerup && c == engine.powerup ? VM_CELL_POWERUP : VM_CELL_EMPTY;
+		}
+		pc++;
+		VM_NEXT();
+	}
+	VM_CASE(SEGX) {
+		const EngineSnake* s = RB == 0 ? &self : RB == 1 ? &other : nullptr;
+		RA = s && RC >= 0 && RC < s->length ? s->segment(RC).x : -1;
+		pc++;
+		VM_NEXT();
+	}
+	VM_CASE(SEGY) {
+		const EngineSnake* s = RB == 0 ? &self : RB == 1 ? &other : nullptr;
+		RA = s && RC >= 0 && RC < s->length ? s->segment(RC).y : -1;
+		pc++;
+		VM_NEXT();
+	}
+#if !defined(VM_COMPUTED_GOTO)
+	default: goto done;  // Not reachable with verified code
+	}
+#endif
+#undef VM_CASE
+#undef VM_NEXT
+#undef RA
+#undef RB
+#undef RC
+exhausted:
+	executed = budget;
+	return RUN_EXHAUSTED;
+done:
+	executed = budget - remaining;
+	return result;
+}
+
+shared_ptr<const VMProgram> loadProgram(const string& path) {
+	static mutex lock;
+	static map<string, shared_ptr<const VMProgram>> loaded;
+	lock_guard<mutex> guard(lock);
+	auto found = loaded.find(path);
+	if (found != loaded.end()) return found->second;
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file) return nullptr;
+	string source;
+	char buffer[4096];
+	size_t n;
+	while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) source.append(buffer, n);
+	fclose(file);
+	shared_ptr<VMProgram> program = make_shared<VMProgram>();
+	string error;
+	if (!program->assemble(source, error)) {
+		fprintf(stderr, "%s: %s\n", path.c_str(), error.c_str());
+		return nullptr;
+	}
+	loaded[path] = program;
+	return program;
+}
+
+static atomic<uint64_t> movesTotal(0), instructionsTotal(0), exhaustedTotal(0);
+
+VMStats vmStats() {
+	VMStats s;
+	s.moves = movesTotal.load();
+	s.instructions = instructionsTotal.load();
+	s.exhausted = exhaustedTotal.load();
+	return s;
+}
+
+VMBot::VMBot(shared_ptr<const VMProgram> loaded, int instructions) : program(loaded), budget(instructions), memory() {}
+
+VMBot::~VMBot() {
+	movesTotal.fetch_add(totals.moves, memory_order_relaxed);
+	instructionsTotal.fetch_add(totals.instructions, memory_order_relaxed);
+	exhaustedTotal.fetch_add(totals.exhausted, memory_order_relaxed);
+}
+
+Dir VMBot::chooseMove(const Engine& engine, int snake) {
+	int executed;
+	int move = program->run(engine, snake, memory, budget, executed);
+	totals.moves++;
+	totals.instructions += executed;
+	totals.exhausted += move == RUN_EXHAUSTED;
+	return move >= 0 ? (Dir)move : engine.snakes[snake].direction;
+}
@@ -0,0 +1,109 @@
+#pragma once
+// Sandboxed bytecode VM for untrusted bots ("vm:PATH" in createBot plays an assembly file).
+// A program runs once per move on 16 int32 registers, cleared each move, and 64 memory words that
+// keep their values for the whole match. It can read the board but not change it, and it gets a
+// fixed instruction budget per move. A program that runs out of budget, halts, or returns anything
+// but a direction keeps the snake's direction.
+//
+// Safety rests on the verifier: every register operand is below 16, every jump lands inside the
+// program, every query id exists, and the program ends in HALT. A verified program cannot touch
+// anything outside its registers and memory words (memory addresses are masked). Arithmetic wraps,
+// and division by zero gives 0. Execution never allocates. With GCC and Clang, dispatch uses computed
+// goto; other compilers get a switch.
+//
+// Assembly: one instruction per line, `;` starts a comment, `name:` defines a label. Operands are
+// registers r0..r15, integers, labels (jumps) or query names (get):
+//   halt                      keep direction               ret rA          return direction rA
+//   loadi rA, N               rA = N                       mov rA, rB      rA = rB
+//   add|sub|mul|div|mod|and|or|xor|shl|shr|min|max|lt|le|eq|ne rA, rB, rC   rA = rB op rC (compares give 0/1)
+//   addi rA, rB, N            rA = rB + N                  abs rA, rB      rA = |rB|
+//   jmp L | jz rA, L | jnz rA, L                           jump (if rA is zero / not zero)
+//   load rA, rB               rA = memory[rB & 63]         store rA, rB    memory[rB & 63] = rA
+//   get rA, QUERY             board, tick, head_x, head_y, direction, length, score, the same with an
+//                             opp_ prefix for the opponent, food_x, food_y, powerup_x, powerup_y (-1 if hidden)
+//   cell rA, rX, rY           what is at (rX, rY): VM_CELL_* below
+//   segx|segy rA, rS, rI      x or y of segment rI (0 is the head) of snake rS (0 self, 1 opponent); -1 if none
+#include <cstdint>       // For fixed-width integer types
+#include <memory>        // For sharing a loaded program
+#include <string>        // For sources and errors
+#include <vector>        // For the code
+#include "Bot.h"
+
+// Operations: X(name, mnemonic, operands), operands being R register, I integer, L label, Q query
+#define VM_OPS(X) \
+	X(HALT, "halt", "") X(RET, "ret", "R") X(LOADI, "loadi", "RI") X(MOV, "mov", "RR") \
+	X(ADD, "add", "RRR") X(ADDI, "addi", "RRI") X(SUB, "sub", "RRR") X(MUL, "mul", "RRR") \
+	X(DIV, "div", "RRR") X(MOD, "mod", "RRR") X(AND, "and", "RRR") X(OR, "or", "RRR") \
+	X(XOR, "xor", "RRR") X(SHL, "shl", "RRR") X(SHR, "shr", "RRR") X(MIN, "min", "RRR") \
+	X(MAX, "max", "RRR") X(ABS, "abs", "RR") X(LT, "lt", "RRR") X(LE, "le", "RRR") \
+	X(EQ, "eq", "RRR") X(NE, "ne", "RRR") X(JMP, "jmp", "L") X(JZ, "jz", "RL") X(JNZ, "jnz", "RL") \
+	X(LOAD, "load", "RR") X(STORE, "store", "RR") X(GET, "get", "RQ") X(CELL, "cell", "RRR") \
+	X(SEGX, "segx", "RRR") X(SEGY, "segy", "RRR")
+
+enum VMOp : uint8_t {
+#define VM_ENUM(name, mnemonic, operands) VM_##name,
+	VM_OPS(VM_ENUM)
+#undef VM_ENUM
+	VM_OP_COUNT
+};
+
+// Results of the cell instruction
+enum VMCell : int32_t { VM_CELL_EMPTY = 0, VM_CELL_FOOD = 1, VM_CELL_POWERUP = 2, VM_CELL_SELF = 3, VM_CELL_OPPONENT = 4, VM_CELL_WALL = 5 };
+
+struct VMInstruction {
+	uint8_t op;     // VMOp
+	uint8_t a;      // Register operands
+	uint8_t b;
+	uint8_t c;
+	int32_t value;  // Integer, jump target or query id
+};
+
+class VMProgram {
+public:
+	static const int REGISTERS = 16;          // Registers per move
+	static const int MEMORY = 64;             // Memory words kept across moves
+	static const int MAX_INSTRUCTIONS = 4096; // Longest program
+
+	std::vector<VMInstruction> code;
+
+	// Function to assemble source text and verify the result; on failure error names the line
+	bool assemble(const std::string& source, std::string& error);
+
+	// Function to check that code is safe to run (see the top of this file)
+	bool verify(std::string& error) const;
+
+	// Function to run one move and count the instructions executed; returns the direction, -1 if the
+	// program halts without one, or -2 if it runs out of budget
+	int run(const Engine& engine, int snake, int32_t* memory, int budget, int& executed) const;
+};
+
+// Function to load and assemble a program file once per path; nullptr with a message on stderr if it
+// cannot be read or does not assemble
+std::shared_ptr<const VMProgram> loadProgram(const std::string& path);
+
+// Totals over all VM bots whose matches have finished
+struct VMStats {
+	uint64_t moves = 0;         // Moves run
+	uint64_t instructions = 0;  // Instructions executed
+	uint64_t exhausted = 0;     // Moves that ran out of budget
+};
+
+// Function to read the totals so far
+VMStats vmStats();
+
+// Bot that runs a program every move ("vm:PATH", or "vm:BUDGET:PATH" to change the default budget)
+class VMBot : public Bot {
+public:
+	static const int DEFAULT_BUDGET = 10000;  // Instructions per move
+
+	VMBot(std::shared_ptr<const VMProgram> loaded, int budget);
+	~VMBot() override;
+
+	Dir chooseMove(const Engine& engine, int snake) override;
+
+private:
+	std::shared_ptr<const VMProgram> program;
+	int budget;
+	int32_t memory[VMProgram::MEMORY];
+	VMStats totals;  // Added to vmStats() when the bot is destroyed
+};
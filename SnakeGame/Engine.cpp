@@ -0,0 +1,327 @@
+#include "Engine.h"
+#include <algorithm>     // For min and max
+using namespace std;
+
+// Constructor: random draws happen in the same order as the Game member initializers
+Engine::Engine(const Rules& gameRules, uint64_t seed) {
+	restart(gameRules, seed);
+}
+
+// Function to start a fresh match exactly like a newly constructed engine, reusing the buffers
+void Engine::restart(const Rules& gameRules, uint64_t seed) {
+	rules = gameRules;
+	rng = SimRng(seed);
+	int cells = rules.cellCount * rules.cellCount;
+	unsigned capacity = 4;
+	while (capacity < (unsigned)cells + 2) capacity <<= 1;  // Room for a full board plus an out-of-bounds head
+	for (int i = 0; i < 2; i++) {
+		EngineSnake& s = snakes[i];
+		s.ring.resize(capacity);  // Contents do not matter, only segments [0, length) are read
+		s.mask = capacity - 1;
+		s.headIndex = 0;
+		s.length = 0;
+		s.addSegment = false;
+		s.score = 0;
+		s.bodySum = 0;
+		s.boostUntil = 0;
+		occupancy[i].assign(cells, 0);
+	}
+	running = true;
+	showPowerup = false;
+	winner = NO_WINNER;
+	tick = step = 0;
+	moved = 0;
+	powerupOnTime = powerupOffTime = 0;
+	deathCause[0] = deathCause[1] = DEATH_NONE;
+	schedule = decltype(schedule)();
+	rules.stepsPerTick = max(rules.stepsPerTick, 1);
+	resetSnake(0, rules.start1, rules.dir1);
+	resetSnake(1, rules.start2, rules.dir2);
+	food = genRandPos();
+	powerup = genRandPos();
+	powerupTimeGap = rng.randomValue(rules.powerupGapMin, rules.powerupGapMax);
+	if (rules.stepsPerTick > 1) {
+		scheduleMove(0, rules.stepsPerTick);
+		scheduleMove(1, rules.stepsPerTick);
+	}
+}
+
+// Function to add a segment in front of the head
+void Engine::pushHead(int snake, Cell c) {
+	EngineSnake& s = snakes[snake];
+	s.headIndex = (s.headIndex - 1) & s.mask;
+	s.ring[s.headIndex] = c;
+	s.length++;
+	s.bodySum += segmentKey(snake, c);
+	if (inBounds(c)) occupancy[snake][cellIndex(c)]++;
+}
+
+// Function to remove the tail segment
+void Engine::popTail(int snake) {
+	EngineSnake& s = snakes[snake];
+	Cell c = s.tail();
+	s.length--;
+	s.bodySum -= segmentKey(snake, c);
+	if (inBounds(c)) occupancy[snake][cellIndex(c)]--;
+}
+
+// Function to place a snake at its start position with three segments
+void Engine::resetSnake(int snake, Cell startPos, Dir startDirection) {
+	EngineSnake& s = snakes[snake];
+	while (s.length > 0) popTail(snake);
+	Cell back = dirDelta(oppositeDir(startDirection));
+	s.direction = startDirection;
+	pushHead(snake, Cell{ startPos.x + 2 * back.x, startPos.y + 2 * back.y });
+	pushHead(snake, Cell{ startPos.x + back.x, startPos.y + back.y });
+	pushHead(snake, startPos);
+}
+
+// Function to change a snake's direction with the same reversal guard as the keyboard handler
+bool Engine::setDirection(int snake, Dir d) {
+	if (d == oppositeDir(snakes[snake].direction)) return false;
+	snakes[snake].direction = d;
+	return true;
+}
+
+// Function to generate a random free cell; draws the same sequence as the rejection loop in the reference
+Cell Engine::genRandPos() {
+	Cell position;
+	do {
+		position.x = rng.randomValue(0, rules.cellCount - 1);
+		position.y = rng.randomValue(0, rules.cellCount - 1);
+	} while (occupied(position));
+	return position;
+}
+
+// Function to put a snake's next move on the schedule
+void Engine::scheduleMove(int snake, int64_t at) {
+	snakes[snake].nextMove = at;
+	schedule.push(ScheduledMove{ at, snake });
+}
+
+// Function to get a snake's move period: the tick, shortened by growth and by a power-up boost
+int Engine::movePeriod(int snake) const {
+	const EngineSnake& s = snakes[snake];
+	int period = rules.stepsPerTick;
+	if (rules.speedupLength > 0) {
+		period = max(period - (s.length - 3) / rules.speedupLength, min(rules.minPeriod, period));
+	}
+	if (rules.boostPeriod > 0 && tick < s.boostUntil) period = min(period, rules.boostPeriod);
+	return max(period, 1);
+}
+
+// Function to advance the match to the next scheduled move
+uint32_t Engine::update() {
+	if (!running) return 0;
+	unsigned movers = 3;  // Bit i set when snake i moves at this sub-step
+	if (rules.stepsPerTick == 1) {
+		step++;  // Every snake moves on every tick; the schedule is not used
+	} else {
+		step = schedule.top().step;
+		movers = 0;
+		while (!schedule.empty() && schedule.top().step == step) {
+			movers |= 1u << schedule.top().snake;
+			schedule.pop();
+		}
+	}
+	int64_t previousTick = tick;
+	tick = step / rules.stepsPerTick;  // A snake moves at least once per tick, so this advances by at most one
+	moved = movers;
+	moveSnakes(movers);
+	uint32_t events = rules.simultaneous ? resolveSimultaneous(movers) : resolveSequential(movers);
+	if (!running) {
+		events |= EVENT_GAME_OVER;
+		for (int i = 0; i < 2; i++) deathCause[i] = (movers >> i & 1) ? collisionCause(i) : DEATH_NONE;
+	}
+	if (tick != previousTick) updatePowerupTimers();
+	for (int i = 0; i < 2 && rules.stepsPerTick > 1; i++) {
+		if (movers >> i & 1) scheduleMove(i, step + movePeriod(i));
+	}
+	return events;
+}
+
+// Function to move the scheduled snakes one cell (no snake looks at another while moving)
+void Engine::moveSnakes(unsigned movers) {
+	for (int i = 0; i < 2; i++) {
+		if (!(movers >> i & 1)) continue;
+		EngineSnake& s = snakes[i];
+		pushHead(i, stepCell(s.head(), s.direction));
+		if (!s.addSegment) {
+			popTail(i);
+		} else {
+			s.addSegment = false;
+		}
+	}
+}
+
+// Function to let a snake eat the food if its head is on it
+void Engine::eatFood(int snake, uint32_t& events) {
+	if (snakes[snake].head() == food) {
+		food = genRandPos();
+		snakes[snake].addSegment = true;
+		snakes[snake].score += rules.foodScore;
+		events |= snake == 0 ? EVENT_FOOD1 : EVENT_FOOD2;
+	}
+}
+
+// Function to let a snake eat the power-up if its head is on it
+void Engine::eatPowerup(int snake, uint32_t& events) {
+	if (snakes[snake].head() == powerup) {
+		powerup = Cell{ -1, -1 };
+		showPowerup = false;
+		snakes[snake].addSegment = true;
+		snakes[snake].score += rules.powerupScore;
+		if (rules.boostPeriod > 0) snakes[snake].boostUntil = tick + rules.boostTicks;  // Speed boost
+		events |= snake == 0 ? EVENT_POWERUP1 : EVENT_POWERUP2;
+	}
+}
+
+// Function to resolve a tick in the original order: food, power-up, then collisions
+uint32_t Engine::resolveSequential(unsigned movers) {
+	uint32_t events = 0;
+	bool moved1 = movers & 1;
+	bool moved2 = (movers & 2) != 0;
+	if (moved1) eatFood(0, events);
+	if (moved2) eatFood(1, events);
+	if (moved1) eatPowerup(0, events);
+	if (moved2) eatPowerup(1, events);
+
+	// The original checks run in a fixed order and the last one to fire names the winner
+	// (only snakes that moved this sub-step are checked)
+	Cell head1 = snakes[0].head();
+	Cell head2 = snakes[1].head();
+	bool inside1 = inBounds(head1);
+	bool inside2 = inBounds(head2);
+	bool check1 = moved1 && inside1;
+	bool check2 = moved2 && inside2;
+	int index1 = inside1 ? cellIndex(head1) : 0;
+	int index2 = inside2 ? cellIndex(head2) : 0;
+	int lastWinner = NO_WINNER;
+	if (moved1 && !inside1) lastWinner = 2;
+	if (moved2 && !inside2) lastWinner = 1;
+	if (check1 && occupancy[0][index1] > 1) lastWinner = 2;
+	if (check2 && occupancy[1][index2] > 1) lastWinner = 1;
+	if (check1 && occupancy[1][index1] > 0) lastWinner = 2;
+	if (check2 && occupancy[0][index2] > 0) lastWinner = 1;
+	if (lastWinner != NO_WINNER) declareWinner(lastWinner);
+	return events;
+}
+
+// Function to check if a snake's head is out of bounds or shares its cell with any other segment
+bool Engine::headCollides(int snake) const {
+	Cell head = snakes[snake].head();
+	if (!inBounds(head)) return true;
+	int index = cellIndex(head);
+	return occupancy[0][index] + occupancy[1][index] > 1;  // The head itself counts once
+}
+
+// Function to classify what a snake's head ran into (DEATH_NONE if nothing)
+DeathCause Engine::collisionCause(int snake) const {
+	Cell head = snakes[snake].head();
+	if (!inBounds(head)) return DEATH_WALL;
+	if (head == snakes[1 - snake].head()) return DEATH_HEAD_ON;
+	int index = cellIndex(head);
+	if (occupancy[snake][index] > 1) return DEATH_SELF;
+	if (occupancy[1 - snake][index] > 0) return DEATH_OPPONENT;
+	return DEATH_NONE;
+}
+
+// Function to resolve a tick simultaneously: all collisions from the occupancy grid, then food
+uint32_t Engine::resolveSimultaneous(unsigned movers) {
+	uint32_t events = 0;
+	bool moved[2] = { (movers & 1) != 0, (movers & 2) != 0 };
+	bool dead[2] = { moved[0] && headCollides(0), moved[1] && headCollides(1) };
+	if (dead[0] && dead[1]) declareWinner(DRAW);
+	else if (dead[0]) declareWinner(2);
+	else if (dead[1]) declareWinner(1);
+
+	// Two live heads never share a cell, so at most one snake can be on each item
+	for (int i = 0; i < 2; i++) {
+		if (moved[i] && !dead[i]) eatFood(i, events);
+	}
+	for (int i = 0; i < 2; i++) {
+		if (moved[i] && !dead[i] && showPowerup) eatPowerup(i, events);
+	}
+	return events;
+}
+
+// Function to expire and respawn the power-up
+void Engine::updatePowerupTimers() {
+	if (showPowerup && tick - powerupOnTime >= rules.powerupLifetime) {
+		powerupOnTime = tick;
+		showPowerup = false;
+		powerup = Cell{ -1, -1 };
+	}
+	if (!showPowerup && tick - powerupOffTime >= powerupTimeGap) {
+		powerupOffTime = tick;
+		showPowerup = true;
+		powerupOnTime = tick;
+		powerup = genRandPos();
+	}
+}
+
+// Function to declare the winner and end the match
+void Engine::declareWinner(int player) {
+	running = false;
+	winner = player;
+}
+
+// Function to reset the match to the initial state (timers, growth flags and the power-up gap carry over)
+void Engine::reset() {
+	resetSnake(0, rules.start1, rules.dir1);
+	resetSnake(1, rules.start2, rules.dir2);
+	food = genRandPos();
+	powerup = Cell{ -1, -1 };
+	showPowerup = false;
+	snakes[0].score = snakes[1].score = 0;
+	deathCause[0] = deathCause[1] = DEATH_NONE;
+	running = true;
+	winner = NO_WINNER;
+	schedule = decltype(schedule)();  // Both snakes restart together on the next tick
+	for (int i = 0; i < 2; i++) {
+		snakes[i].boostUntil = 0;
+		if (rules.stepsPerTick > 1) scheduleMove(i, (tick + 1) * rules.stepsPerTick);
+	}
+}
+
+// Function to hash what is on the board: bodies, directions, pending growth, scores, the food and a
+// visible power-up. The tick, the power-up timers and the random generator are left out, so a snake
+// circling without eating comes back to the same hash. With sub-steps the time to each snake's next
+// move and its remaining boost are included. O(1), like stateHash().
+uint64_t Engine::positionHash() const {
+	const EngineSnake& a = snakes[0];
+	const EngineSnake& b = snakes[1];
+	Cell shown = showPowerup ? powerup : Cell{ -1, -1 };
+	uint64_t hash = foldHash(0xbb67ae8584caa73bULL, a.bodySum);
+	hash = foldHash(hash, b.bodySum);
+	hash = foldHash(hash, packCell(a.head()) << 32 | packCell(b.head()));
+	hash = foldHash(hash, packCell(food) << 32 | packCell(shown));
+	hash = foldHash(hash, (uint64_t)(uint16_t)a.score << 48 | (uint64_t)(uint16_t)b.score << 32 | (uint64_t)(uint16_t)a.length << 16 |
+		(uint16_t)b.length);
+	hash = foldHash(hash, (uint64_t)a.direction << 4 | (uint64_t)b.direction << 2 | (uint64_t)a.addSegment << 1 | (uint64_t)b.addSegment);
+	for (int i = 0; i < 2 && rules.stepsPerTick > 1; i++) {
+		const EngineSnake& s = snakes[i];
+		hash = foldHash(hash, (uint64_t)(s.nextMove - step) << 32 | (uint64_t)max<int64_t>(s.boostUntil - tick, 0));
+	}
+	return mix64(hash);
+}
+
+// Function to hash the full state from the incrementally maintained body sums
+uint64_t Engine::stateHash() const {
+	SnakeDigest digests[2];
+	for (int i = 0; i < 2; i++) {
+		const EngineSnake& s = snakes[i];
+		digests[i] = SnakeDigest{ s.bodySum, s.head(), s.tail(), s.length, s.direction, s.addSegment, s.score };
+	}
+	MatchDigest match = { food, powerup, showPowerup, running, winner, tick, powerupOnTime, powerupOffTime };
+	uint64_t hash = hashState(digests, match);
+	if (rules.stepsPerTick > 1) {  // The schedule only differs from the reference game's tick with sub-steps
+		hash = foldHash(hash, (uint64_t)step);
+		for (int i = 0; i < 2; i++) {
+			hash = foldHash(hash, (uint64_t)snakes[i].nextMove);
+			hash = foldHash(hash, (uint64_t)snakes[i].boostUntil);
+		}
+		hash = mix64(hash);
+	}
+	return hash;
+}
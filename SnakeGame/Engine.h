@@ -0,0 +1,122 @@
+#pragma once
+// Optimized headless game engine.
+// Bodies live in fixed-capacity ring buffers and every cell keeps a per-snake occupancy count, so a
+// tick costs O(1) no matter how long the snakes are. The per-tick state hash is maintained
+// incrementally. Rules must match ReferenceGame exactly; run `snake_sim --golden-master` after
+// touching anything in here.
+//
+// Two tick resolutions are supported:
+//  - sequential (Rules::simultaneous == false): the original Game::update() order. Snake 1 eats
+//    before snake 2, a hidden power-up is still edible and the last collision check names the winner.
+//  - simultaneous: every snake moves, then every head is tested against the occupancy grid at once
+//    (out of bounds, or any other segment on its cell, kills it), then the survivors eat. The result
+//    does not depend on snake order, so snakes can be resolved in parallel. If every snake dies in
+//    the same tick (including head-on) the match is a DRAW, and only a visible power-up can be eaten.
+//
+// Snakes can also move at their own speed (Rules::stepsPerTick > 1 with length speedup or power-up
+// boosts). Each snake then has a move period in sub-steps and a priority queue keyed by the sub-step
+// of its next move (ties broken by snake index) picks who moves next. update() advances to that
+// sub-step and resolves only the snakes that move there; power-up timers run when the tick changes.
+// With the default rules both snakes move on every tick exactly as before.
+#include <functional>    // For greater
+#include <queue>         // For the move schedule
+#include <vector>        // For ring buffers and the occupancy grid
+#include "SimCore.h"
+
+// Snake body stored as a ring buffer, head first
+class EngineSnake {
+public:
+	std::vector<Cell> ring;       // Segment storage (power-of-two capacity)
+	unsigned mask = 0;            // Capacity - 1
+	unsigned headIndex = 0;       // Ring index of the head
+	int length = 0;               // Number of segments
+	Dir direction = DIR_RIGHT;    // Current moving direction
+	bool addSegment = false;      // Flag to grow on the next move
+	int score = 0;                // Current score
+	uint64_t bodySum = 0;         // Sum of segmentKey over all segments
+	int64_t nextMove = 0;         // Sub-step of the next move
+	int64_t boostUntil = 0;       // Tick the power-up speed boost runs out
+
+	Cell segment(int i) const { return ring[(headIndex + i) & mask]; }  // Segment i, 0 is the head
+	Cell head() const { return ring[headIndex]; }
+	Cell tail() const { return ring[(headIndex + length - 1) & mask]; }
+};
+
+// One entry of the move schedule
+struct ScheduledMove {
+	int64_t step;  // Sub-step the move happens at
+	int snake;     // Snake that moves (breaks ties so equal steps always pop in the same order)
+
+	bool operator>(const ScheduledMove& other) const {
+		return step != other.step ? step > other.step : snake > other.snake;
+	}
+};
+
+class Engine {
+public:
+	Rules rules;                        // Rules of the match
+	SimRng rng;                         // Random generator standing in for GetRandomValue
+	EngineSnake snakes[2];              // Both snakes
+	std::vector<uint8_t> occupancy[2];  // Per-cell segment counts of each snake
+	Cell food;                          // Food position
+	Cell powerup;                       // Power-up position ({ -1, -1 } when taken or expired)
+	bool running = true;                // Flag to check if the match is running
+	bool showPowerup = false;           // Flag to display the power-up
+	int winner = NO_WINNER;             // Winner once the match is over
+	int64_t tick = 0;                   // Ticks since construction
+	int64_t step = 0;                   // Scheduler sub-steps since construction
+	unsigned moved = 0;                 // Bit i set when snake i moved in the last update
+	int64_t powerupOnTime = 0;          // Tick the power-up appeared or expired
+	int64_t powerupOffTime = 0;         // Tick the power-up last appeared
+	int powerupTimeGap = 0;             // Ticks between power-up appearances
+	DeathCause deathCause[2] = { DEATH_NONE, DEATH_NONE };  // Set for both snakes when the match ends
+
+	Engine(const Rules& rules, uint64_t seed);
+
+	void restart(const Rules& rules, uint64_t seed);  // Same as constructing anew, without reallocating
+
+	bool setDirection(int snake, Dir d);  // Change direction unless it reverses the snake
+	uint32_t update();                    // Advance to the next scheduled move (one tick by default), returning EVENT_* bits
+	void reset();                         // Restart the match (timers and the power-up gap carry over)
+	uint64_t stateHash() const;           // Hash of the full state (see hashState)
+	uint64_t positionHash() const;        // Hash of the board position without the tick, timers or random state
+	int movePeriod(int snake) const;      // Current move period of a snake in sub-steps
+
+	// Function to get the sub-step of the next scheduled move
+	int64_t nextStep() const { return rules.stepsPerTick == 1 ? step + 1 : schedule.top().step; }
+
+	// Function to get the wall-clock seconds from the last update to the next one
+	double secondsToNextStep() const { return (double)(nextStep() - step) * rules.tickSeconds / rules.stepsPerTick; }
+
+	// Function to check if a cell is inside the grid
+	bool inBounds(Cell c) const {
+		return c.x >= 0 && c.x < rules.cellCount && c.y >= 0 && c.y < rules.cellCount;
+	}
+
+	// Function to get the grid index of an in-bounds cell
+	int cellIndex(Cell c) const { return c.y * rules.cellCount + c.x; }
+
+	// Function to check if an in-bounds cell holds any snake segment
+	bool occupied(Cell c) const {
+		int index = cellIndex(c);
+		return (occupancy[0][index] | occupancy[1][index]) != 0;
+	}
+
+private:
+	std::priority_queue<ScheduledMove, std::vector<ScheduledMove>, std::greater<ScheduledMove>> schedule;
+
+	void scheduleMove(int snake, int64_t at);
+	void resetSnake(int snake, Cell startPos, Dir startDirection);
+	void pushHead(int snake, Cell c);
+	void popTail(int snake);
+	Cell genRandPos();
+	void moveSnakes(unsigned movers);
+	uint32_t resolveSequential(unsigned movers);
+	uint32_t resolveSimultaneous(unsigned movers);
+	void eatFood(int snake, uint32_t& events);
+	void eatPowerup(int snake, uint32_t& events);
+	bool headCollides(int snake) const;
+	DeathCause collisionCause(int snake) const;
+	void updatePowerupTimers();
+	void declareWinner(int player);
+};
@@ -0,0 +1,30 @@
+// Greedy bot plugin ("plugin:./greedy.so"): steps to the free neighbour closest to the food.
+// Plays the same moves as greedy.vm and greedy_process.c.
+// Build with `gcc -O2 -shared -fPIC -I SnakeGame -o greedy.so SnakeGame/Examples/greedy_plugin.c`.
+#include <stdlib.h>      // For abs
+#include "SnakePlugin.h"
+
+SNAKE_PLUGIN_EXPORT int32_t snake_plugin_abi(void) { return SNAKE_PLUGIN_ABI; }
+
+// The bot keeps no state between moves
+SNAKE_PLUGIN_EXPORT void* snake_plugin_init(uint64_t seed) { (void)seed; return NULL; }
+
+SNAKE_PLUGIN_EXPORT void snake_plugin_shutdown(void* bot) { (void)bot; }
+
+SNAKE_PLUGIN_EXPORT int32_t snake_plugin_choose_move(void* bot, const SnakePluginState* state) {
+	static const int dx[4] = { 0, 1, 0, -1 }, dy[4] = { -1, 0, 1, 0 };
+	const SnakePluginSnake* self = &state->snakes[state->you];
+	SnakePluginCell head = snake_plugin_segment(self, 0);
+	int best = -1, bestDistance = 1000000;
+	(void)bot;
+	for (int d = 0; d < 4; d++) {
+		int x = head.x + dx[d], y = head.y + dy[d];
+		if (snake_plugin_blocked(state, x, y)) continue;
+		int distance = abs(x - state->food.x) + abs(y - state->food.y);
+		if (distance < bestDistance) {
+			bestDistance = distance;
+			best = d;
+		}
+	}
+	return best;  // -1 keeps the current direction
+}
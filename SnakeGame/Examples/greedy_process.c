@@ -0,0 +1,46 @@
+// Greedy bot process ("process:./greedy_process"): steps to the free neighbour closest to the food.
+// Plays the same moves as greedy.vm and greedy_plugin.c.
+// Build with `gcc -O2 -I SnakeGame -o greedy_process SnakeGame/Examples/greedy_process.c` (Linux only).
+#include <stdio.h>       // For fprintf
+#include <stdlib.h>      // For abs
+#include "SnakeShm.h"
+
+// Function to check if a cell is off the board or holds any snake segment
+static int blocked(const SnakeShmSlot* slot, int x, int y) {
+	if (x < 0 || y < 0 || x >= slot->board || y >= slot->board) return 1;
+	for (int s = 0; s < 2; s++) {
+		for (int i = 0; i < slot->snakes[s].length; i++) {
+			if (slot->snakes[s].body[i][0] == x && slot->snakes[s].body[i][1] == y) return 1;
+		}
+	}
+	return 0;
+}
+
+// Function to pick the move of the snake to move
+static int chooseMove(const SnakeShmSlot* slot) {
+	static const int dx[4] = { 0, 1, 0, -1 }, dy[4] = { -1, 0, 1, 0 };
+	const SnakeShmSnake* self = &slot->snakes[slot->you];
+	int best = -1, bestDistance = 1000000;
+	for (int d = 0; d < 4; d++) {
+		int x = self->body[0][0] + dx[d], y = self->body[0][1] + dy[d];
+		if (blocked(slot, x, y)) continue;
+		int distance = abs(x - slot->food[0]) + abs(y - slot->food[1]);
+		if (distance < bestDistance) {
+			bestDistance = distance;
+			best = d;
+		}
+	}
+	return best;  // -1 keeps the current direction
+}
+
+int main(void) {
+	SnakeShmChannel* channel = snake_shm_attach();
+	if (!channel) {
+		fprintf(stderr, "greedy_process: run me as process:COMMAND from snake_sim\n");
+		return 1;
+	}
+	const SnakeShmSlot* slot;
+	uint32_t sequence = 0;
+	while ((slot = snake_shm_next(channel, &sequence)) != NULL) snake_shm_reply(channel, sequence, chooseMove(slot));
+	return 0;
+}
@@ -0,0 +1,263 @@
+#include "GoldenMaster.h"
+#include <algorithm>     // For max
+#include <atomic>        // For the shared work counter
+#include <chrono>        // For timing the run
+#include <mutex>         // For recording the first failure
+#include <thread>        // For worker threads
+#include <vector>        // For the worker list
+#include "Engine.h"
+#include "ReferenceGame.h"
+#include "SnakeCodec.h"
+using namespace std;
+
+// Function to draw fuzzed rules for a match
+static Rules fuzzRules(SimRng& fuzz, const GoldenMasterOptions& options) {
+	Rules rules = Rules::forBoard(fuzz.randomValue(options.minBoard, options.maxBoard));
+	rules.foodScore = fuzz.randomValue(1, 3);
+	rules.powerupScore = fuzz.randomValue(1, 9);
+	rules.powerupLifetime = fuzz.randomValue(1, 60);
+	rules.powerupGapMin = fuzz.randomValue(1, 80);
+	rules.powerupGapMax = rules.powerupGapMin + fuzz.randomValue(0, 5);
+	rules.simultaneous = fuzz.randomValue(0, 1) == 1;
+	return rules;
+}
+
+// Function to draw fuzzed rules with per-snake speeds for a scheduler match
+static Rules fuzzSpeedRules(SimRng& fuzz, const GoldenMasterOptions& options) {
+	Rules rules = fuzzRules(fuzz, options);
+	rules.stepsPerTick = fuzz.randomValue(2, 8);
+	rules.speedupLength = fuzz.randomValue(0, 4);
+	rules.minPeriod = fuzz.randomValue(1, rules.stepsPerTick);
+	rules.boostPeriod = fuzz.randomValue(0, rules.stepsPerTick);
+	rules.boostTicks = fuzz.randomValue(1, 60);
+	return rules;
+}
+
+// Function to check if a move leads into a free in-bounds cell
+static bool safeMove(const Engine& engine, int snake, Dir d) {
+	Cell next = stepCell(engine.snakes[snake].head(), d);
+	return engine.inBounds(next) && !engine.occupied(next);
+}
+
+// Function to pick a scripted input: mostly food-seeking and wall-avoiding, sometimes random or idle
+static Dir scriptedMove(const Engine& engine, int snake, SimRng& fuzz) {
+	const EngineSnake& s = engine.snakes[snake];
+	int roll = fuzz.randomValue(0, 99);
+	if (roll < 10) return (Dir)fuzz.randomValue(0, 3);  // Random key press (may be rejected as a reversal)
+	if (roll < 25) return s.direction;                   // No key press
+	Cell head = s.head();
+	Dir preferred[2] = {
+		engine.food.x < head.x ? DIR_LEFT : DIR_RIGHT,
+		engine.food.y < head.y ? DIR_UP : DIR_DOWN
+	};
+	if (engine.food.x == head.x) preferred[0] = preferred[1];
+	if (engine.food.y == head.y) preferred[1] = preferred[0];
+	for (Dir d : preferred) {
+		if (d != oppositeDir(s.direction) && safeMove(engine, snake, d)) return d;
+	}
+	int first = fuzz.randomValue(0, 3);
+	for (int i = 0; i < 4; i++) {
+		Dir d = (Dir)((first + i) & 3);
+		if (d != oppositeDir(s.direction) && safeMove(engine, snake, d)) return d;
+	}
+	return s.direction;
+}
+
+// Function to check that both snakes survive a trip through the packed wire encoding
+static bool codecRoundTrips(const Engine& engine) {
+	for (int i = 0; i < 2; i++) {
+		const EngineSnake& s = engine.snakes[i];
+		vector<uint8_t> bytes;
+		writePackedSnake(packSnake(s), bytes);
+		PackedSnake packed;
+		size_t offset = 0;
+		if (!readPackedSnake(bytes.data(), bytes.size(), offset, packed) || packed.length != s.length) return false;
+		vector<Cell> cells(s.length);
+		decodeCells(packed, cells.data());
+		for (int k = 0; k < s.length; k++) {
+			if (cells[k] != s.segment(k)) return false;
+		}
+
+		// Grid indices (the SSE2 path where available), for the whole snake and for shorter prefixes
+		// so every remainder of the four-segment steps and every short tail is covered
+		int n = engine.rules.cellCount;
+		vector<int32_t> indices(s.length);
+		for (int length = 1; length <= s.length; length++) {
+			if (length > 9 && length < s.length - 3) continue;
+			packed.length = length;
+			decodeCellIndices(packed, n, indices.data());
+			for (int k = 0; k < length; k++) {
+				Cell c = s.segment(k);
+				if (indices[k] != c.y * n + c.x) return false;
+			}
+		}
+	}
+	return true;
+}
+
+int64_t runGoldenMatch(uint64_t matchSeed, const GoldenMasterOptions& options, string* detail) {
+	SimRng fuzz(matchSeed);
+	Rules rules = fuzzRules(fuzz, options);
+	uint64_t gameSeed = fuzz.next();
+	ReferenceGame reference(rules, gameSeed);
+	Engine engine(rules, gameSeed);
+	int cells = rules.cellCount * rules.cellCount;
+
+	int64_t ticks = 0;
+	while (ticks < options.maxMatchTicks) {
+		if (!engine.running) {
+			if (fuzz.randomValue(0, 3) != 0) break;  // Usually stop; sometimes exercise reset()
+			reference.reset();
+			engine.reset();
+		}
+		// Rejection sampling for food never ends on a full board, so stop well before that
+		if (engine.snakes[0].length + engine.snakes[1].length > cells * 3 / 4) break;
+
+		for (int i = 0; i < 2; i++) {
+			Dir d = scriptedMove(engine, i, fuzz);
+			bool accepted = reference.setDirection(i, d);
+			if (engine.setDirection(i, d) != accepted) {
+				if (detail) *detail = "direction guard differs";
+				return -(ticks + 1);
+			}
+		}
+		uint32_t referenceEvents = reference.update();
+		uint32_t engineEvents = engine.update();
+		ticks++;
+		if (referenceEvents != engineEvents || reference.stateHash() != engine.stateHash()) {
+			if (detail) {
+				*detail = "board " + to_string(rules.cellCount) + ", tick " + to_string(reference.tick) +
+					", events " + to_string(referenceEvents) + " vs " + to_string(engineEvents);
+			}
+			return -ticks;
+		}
+	}
+	if (!codecRoundTrips(engine)) {
+		if (detail) *detail = "packed snake encoding does not round-trip";
+		return -ticks;
+	}
+	return ticks;
+}
+
+int64_t runScheduledMatch(uint64_t matchSeed, const GoldenMasterOptions& options, uint64_t* fingerprint, string* detail) {
+	SimRng fuzz(matchSeed);
+	Rules rules = fuzzSpeedRules(fuzz, options);
+	uint64_t gameSeed = fuzz.next();
+	Engine engine(rules, gameSeed);
+	Engine replay(Rules::forBoard(options.minBoard), ~gameSeed);  // Restarted below, so it must end up identical
+	replay.restart(rules, gameSeed);
+	int cells = rules.cellCount * rules.cellCount;
+	uint64_t hash = matchSeed;
+
+	int64_t steps = 0;
+	while (engine.tick < options.maxMatchTicks) {
+		if (!engine.running) {
+			if (fuzz.randomValue(0, 3) != 0) break;  // Usually stop; sometimes exercise reset()
+			engine.reset();
+			replay.reset();
+		}
+		if (engine.snakes[0].length + engine.snakes[1].length > cells * 3 / 4) break;
+
+		for (int i = 0; i < 2; i++) {
+			Dir d = scriptedMove(engine, i, fuzz);
+			engine.setDirection(i, d);
+			replay.setDirection(i, d);
+		}
+		// The next move belongs to the snakes with the earliest scheduled step
+		int64_t expectedStep = min(engine.snakes[0].nextMove, engine.snakes[1].nextMove);
+		unsigned expectedMovers = 0;
+		for (int i = 0; i < 2; i++) {
+			if (engine.snakes[i].nextMove == expectedStep) expectedMovers |= 1u << i;
+		}
+		int64_t previousTick = engine.tick;
+		uint32_t events = engine.update();
+		uint32_t replayEvents = replay.update();
+		steps++;
+
+		const char* failure = nullptr;
+		if (engine.step != expectedStep || engine.moved != expectedMovers) failure = "wrong snakes moved";
+		else if (engine.tick - previousTick > 1) failure = "a tick passed without a move";
+		for (int i = 0; i < 2 && !failure; i++) {
+			int64_t wait = engine.snakes[i].nextMove - engine.step;
+			if (wait < 1 || wait > rules.stepsPerTick) failure = "next move out of range";
+			else if ((engine.moved >> i & 1) && wait != engine.movePeriod(i)) failure = "next move ignores the move period";
+		}
+		if (!failure && (events != replayEvents || engine.stateHash() != replay.stateHash())) failure = "restarted engine differs";
+		if (failure) {
+			if (detail) {
+				*detail = string(failure) + " (board " + to_string(rules.cellCount) + ", " +
+					to_string(rules.stepsPerTick) + " sub-steps per tick, step " + to_string(engine.step) + ")";
+			}
+			return -steps;
+		}
+		hash = mix64(hash ^ engine.stateHash());
+	}
+	if (fingerprint) *fingerprint = hash;
+	return steps;
+}
+
+GoldenMasterReport runGoldenMaster(const GoldenMasterOptions& options) {
+	GoldenMasterReport report;
+	auto startTime = chrono::steady_clock::now();
+	int threadCount = options.threads > 0 ? options.threads : (int)max(1u, thread::hardware_concurrency());
+
+	atomic<uint64_t> nextMatch(0);
+	atomic<uint64_t> ticksDone(0);
+	atomic<uint64_t> matchesDone(0);
+	atomic<bool> failed(false);
+	atomic<uint64_t> nextScheduled(0);
+	atomic<uint64_t> schedulerSteps(0);
+	atomic<uint64_t> schedulerFingerprint(0);
+	mutex failureMutex;
+
+	// Function to record the first failure of either pass
+	auto recordFailure = [&](uint64_t matchSeed, int64_t at, const string& detail) {
+		lock_guard<mutex> lock(failureMutex);
+		if (!failed.exchange(true)) {
+			report.passed = false;
+			report.failingSeed = matchSeed;
+			report.failingTick = at;
+			report.detail = detail;
+		}
+	};
+
+	auto worker = [&]() {
+		while (!failed.load(memory_order_relaxed) && ticksDone.load(memory_order_relaxed) < options.ticks) {
+			uint64_t matchSeed = mix64(options.seed ^ mix64(nextMatch.fetch_add(1)));
+			string detail;
+			int64_t result = runGoldenMatch(matchSeed, options, &detail);
+			if (result < 0) {
+				recordFailure(matchSeed, -result, detail);
+				result = -result;
+			}
+			ticksDone.fetch_add(result, memory_order_relaxed);
+			matchesDone.fetch_add(1, memory_order_relaxed);
+		}
+
+		// The scheduler pass plays a fixed set of matches, so its fingerprint is repeatable
+		uint64_t index;
+		while (!failed.load(memory_order_relaxed) && (index = nextScheduled.fetch_add(1)) < (uint64_t)options.schedulerMatches) {
+			uint64_t matchSeed = mix64(~options.seed ^ mix64(index));
+			string detail;
+			uint64_t fingerprint = 0;
+			int64_t result = runScheduledMatch(matchSeed, options, &fingerprint, &detail);
+			if (result < 0) {
+				recordFailure(matchSeed, -result, "scheduler: " + detail);
+				break;
+			}
+			schedulerSteps.fetch_add(result, memory_order_relaxed);
+			schedulerFingerprint.fetch_xor(mix64(fingerprint + index), memory_order_relaxed);  // Order-independent
+		}
+	};
+
+	vector<thread> workers;
+	for (int i = 0; i < threadCount; i++) workers.emplace_back(worker);
+	for (thread& t : workers) t.join();
+
+	report.ticks = ticksDone.load();
+	report.matches = matchesDone.load();
+	report.schedulerSteps = schedulerSteps.load();
+	report.schedulerFingerprint = schedulerFingerprint.load();
+	report.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	return report;
+}
@@ -0,0 +1,41 @@
+#pragma once
+// Golden-master determinism harness.
+// Runs seeded matches with fuzzed inputs, board sizes and power-up timings through the frozen
+// ReferenceGame and the optimized Engine side by side and compares their state hashes every tick.
+// A second pass plays a fixed number of multi-speed matches (Rules::stepsPerTick > 1), which the
+// reference does not model: it checks the sub-step scheduler against its invariants, replays each
+// match on a restarted engine, and folds the states into a fingerprint that only depends on the seed.
+#include <cstdint>       // For fixed-width integer types
+#include <string>        // For the mismatch description
+
+struct GoldenMasterOptions {
+	uint64_t ticks = 100000000;  // Total ticks to check across all matches
+	int threads = 0;             // Worker threads (0 = hardware concurrency)
+	uint64_t seed = 1;           // Master seed; match i uses a seed derived from it
+	int minBoard = 10;           // Smallest fuzzed board size
+	int maxBoard = 40;           // Largest fuzzed board size
+	int maxMatchTicks = 4000;    // Tick cap per match
+	int schedulerMatches = 2000; // Multi-speed matches for the scheduler pass
+};
+
+struct GoldenMasterReport {
+	uint64_t ticks = 0;          // Ticks compared
+	uint64_t matches = 0;        // Matches played
+	bool passed = true;          // False once a mismatch was found
+	uint64_t failingSeed = 0;    // Seed of the first failing match
+	int64_t failingTick = -1;    // Tick of the first mismatch in that match
+	std::string detail;          // Human-readable description of the mismatch
+	double seconds = 0;          // Wall-clock time
+	uint64_t schedulerSteps = 0; // Sub-steps checked in the scheduler pass
+	uint64_t schedulerFingerprint = 0;  // Combined state hashes of the scheduler pass (same for any thread count)
+};
+
+// Function to run one fuzzed match; returns the number of ticks checked or -(tick) on a mismatch
+int64_t runGoldenMatch(uint64_t matchSeed, const GoldenMasterOptions& options, std::string* detail);
+
+// Function to run one fuzzed multi-speed match; returns the number of sub-steps checked or -(step) on a
+// failure, and sets fingerprint to a hash of every state the match went through
+int64_t runScheduledMatch(uint64_t matchSeed, const GoldenMasterOptions& options, uint64_t* fingerprint, std::string* detail);
+
+// Function to run the whole harness across worker threads
+GoldenMasterReport runGoldenMaster(const GoldenMasterOptions& options);
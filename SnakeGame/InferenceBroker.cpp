@@ -0,0 +1,140 @@
+#include "InferenceBroker.h"
+#include <algorithm>     // For max
+#include <cstring>       // For memcpy
+#include <map>           // For the shared brokers
+#include <vector>        // For the batch buffers
+using namespace std;
+
+InferenceBroker::InferenceBroker(shared_ptr<const PolicyNet> weights, int batch, double wait)
+	: net(weights), maxBatch(max(1, batch)),
+	maxWait(chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(max(0.0, wait)))),
+	queue(4096), outstanding(0), parked(false), stopping(false), requestCount(0), batchCount(0), fullCount(0) {
+	worker = thread(&InferenceBroker::run, this);
+}
+
+InferenceBroker::~InferenceBroker() {
+	{
+		lock_guard<mutex> lock(parkMutex);
+		stopping.store(true);
+	}
+	wake.notify_one();
+	worker.join();
+}
+
+void InferenceBroker::evaluate(const uint8_t* features, float* logits) {
+	Request request;
+	request.features = features;
+	request.logits = logits;
+	future<void> done = request.done.get_future();
+	Request* pointer = &request;
+	while (!queue.tryPush(pointer)) this_thread::yield();
+
+	// Count the request before looking at the flag; the parked thread sets the flag before it
+	// checks the count, so one of the two sees the other
+	outstanding.fetch_add(1);
+	if (parked.load()) {
+		lock_guard<mutex> lock(parkMutex);
+		wake.notify_one();
+	}
+	done.wait();
+}
+
+BrokerStats InferenceBroker::stats() const {
+	BrokerStats s;
+	s.requests = requestCount.load(memory_order_relaxed);
+	s.batches = batchCount.load(memory_order_relaxed);
+	s.fullBatches = fullCount.load(memory_order_relaxed);
+	return s;
+}
+
+// Function run by the inference thread: collect a batch, score it, wake its callers
+void InferenceBroker::run() {
+	vector<Request*> pending;
+	pending.reserve(maxBatch);
+	vector<uint8_t> features((size_t)maxBatch * PolicyNet::INPUTS);
+	vector<float> logits((size_t)maxBatch * PolicyNet::OUTPUTS);
+	int idle = 0;
+	while (true) {
+		Request* request;
+		if (!queue.tryPop(request)) {
+			// Spin briefly, since under load the next request is usually close, then sleep
+			if (++idle < 64) { this_thread::yield(); continue; }
+			unique_lock<mutex> lock(parkMutex);
+			parked.store(true);
+			wake.wait(lock, [&]() { return outstanding.load() > 0 || stopping.load(); });
+			parked.store(false);
+			if (stopping.load() && outstanding.load() <= 0) return;
+			idle = 0;
+			continue;
+		}
+		idle = 0;
+
+		// Collect until the batch is full or the window since the first request closes
+		auto deadline = chrono::steady_clock::now() + maxWait;
+		pending.push_back(request);
+		while ((int)pending.size() < maxBatch) {
+			if (queue.tryPop(request)) pending.push_back(request);
+			else if (chrono::steady_clock::now() >= deadline) break;
+			else this_thread::yield();
+		}
+		int count = (int)pending.size();
+		outstanding.fetch_sub(count);
+
+		for (int i = 0; i < count; i++) memcpy(&features[(size_t)i * PolicyNet::INPUTS], pending[i]->features, PolicyNet::INPUTS);
+		net->evaluate(features.data(), count, logits.data());
+		for (int i = 0; i < count; i++) {
+			memcpy(pending[i]->logits, &logits[(size_t)i * PolicyNet::OUTPUTS], PolicyNet::OUTPUTS * sizeof(float));
+			// The caller may return as soon as the future is ready, so fulfil a promise moved off its stack
+			promise<void> done = move(pending[i]->done);
+			done.set_value();
+		}
+		pending.clear();
+		requestCount.fetch_add(count, memory_order_relaxed);
+		batchCount.fetch_add(1, memory_order_relaxed);
+		if (count == maxBatch) fullCount.fetch_add(1, memory_order_relaxed);
+	}
+}
+
+// Shared brokers, one per weights path, and the settings for new ones
+static mutex brokersMutex;
+static map<string, shared_ptr<InferenceBroker>> brokers;
+static int batchingSize = 0;
+static double batchingWait = 0;
+
+void enablePolicyBatching(int maxBatch, double maxWait) {
+	lock_guard<mutex> lock(brokersMutex);
+	batchingSize = maxBatch;
+	batchingWait = maxWait;
+	brokers.clear();  // Bots still playing keep their broker alive until they are destroyed
+}
+
+shared_ptr<InferenceBroker> policyBroker(const string& path) {
+	lock_guard<mutex> lock(brokersMutex);
+	if (batchingSize < 2) return nullptr;
+	auto found = brokers.find(path);
+	if (found != brokers.end()) return found->second;
+	shared_ptr<const PolicyNet> net = loadPolicy(path);
+	if (!net) return nullptr;
+	shared_ptr<InferenceBroker> broker = make_shared<InferenceBroker>(net, batchingSize, batchingWait);
+	brokers[path] = broker;
+	return broker;
+}
+
+BrokerStats policyBatchingStats() {
+	lock_guard<mutex> lock(brokersMutex);
+	BrokerStats total;
+	for (auto& entry : brokers) {
+		BrokerStats s = entry.second->stats();
+		total.requests += s.requests;
+		total.batches += s.batches;
+		total.fullBatches += s.fullBatches;
+	}
+	return total;
+}
+
+Dir BrokeredPolicyBot::chooseMove(const Engine& engine, int snake) {
+	float logits[PolicyNet::OUTPUTS];
+	PolicyNet::observe(engine, snake, features);
+	broker->evaluate(features, logits);
+	return policyMove(engine, snake, logits);
+}
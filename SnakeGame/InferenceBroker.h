@@ -0,0 +1,92 @@
+#pragma once
+// Batched inference for neural-network bots playing in many threads at once.
+// A PolicyBot scores one observation per move, which leaves most of the batch width of
+// PolicyNet::evaluate unused. With a broker, a bot pushes its observation into a lock-free queue and
+// blocks on a future. One inference thread collects requests until it holds maxBatch of them or
+// maxWait has passed since the first one, runs a single forward pass over the batch and fulfils the
+// futures. When the queue stays empty the thread parks on a condition variable, and the next request
+// wakes it.
+//
+// A match thread waits for every move it asks for, so a batch holds at most one request per match
+// thread: run at least maxBatch threads to fill batches. enablePolicyBatching() makes every "nn:PATH"
+// bot from createBot() go through one shared broker per weights file.
+#include <atomic>              // For the stop flag, the request count and the statistics
+#include <chrono>              // For the batching window
+#include <condition_variable>  // For parking the idle inference thread
+#include <cstdint>             // For fixed-width integer types
+#include <future>              // For waiting on a result
+#include <memory>              // For the shared weights
+#include <mutex>               // For parking the idle inference thread
+#include <string>              // For the weights path
+#include <thread>              // For the inference thread
+#include "LockFreeQueue.h"
+#include "Policy.h"
+
+// Totals over a broker's lifetime
+struct BrokerStats {
+	uint64_t requests = 0;     // Observations scored
+	uint64_t batches = 0;      // Forward passes run
+	uint64_t fullBatches = 0;  // Passes that reached maxBatch before the window closed
+};
+
+class InferenceBroker {
+public:
+	// Constructor: starts the inference thread; maxWait is in seconds
+	InferenceBroker(std::shared_ptr<const PolicyNet> weights, int maxBatch, double maxWait);
+	~InferenceBroker();
+
+	InferenceBroker(const InferenceBroker&) = delete;
+	InferenceBroker& operator=(const InferenceBroker&) = delete;
+
+	// Function to score one observation (PolicyNet::INPUTS bytes) into OUTPUTS logits; blocks until
+	// the batch holding it has run. Safe to call from any number of threads.
+	void evaluate(const uint8_t* features, float* logits);
+
+	// Function to read the totals so far
+	BrokerStats stats() const;
+
+private:
+	// A waiting caller's observation, result buffer and promise; lives on the caller's stack
+	struct Request {
+		const uint8_t* features = nullptr;
+		float* logits = nullptr;
+		std::promise<void> done;
+	};
+
+	std::shared_ptr<const PolicyNet> net;
+	int maxBatch;                                    // Largest batch
+	std::chrono::steady_clock::duration maxWait;     // Batching window, from the first request
+	LockFreeQueue<Request*> queue;                   // Requests not yet taken by the inference thread
+	std::atomic<int> outstanding;                    // Requests pushed and not yet taken
+	std::atomic<bool> parked;                        // Set while the inference thread sleeps
+	std::atomic<bool> stopping;                      // Set by the destructor
+	std::mutex parkMutex;                            // Guards sleeping and waking
+	std::condition_variable wake;                    // Signals a request or shutdown to the parked thread
+	std::atomic<uint64_t> requestCount, batchCount, fullCount;
+	std::thread worker;                              // Inference thread (started last)
+
+	void run();
+};
+
+// Function to make createBot() give "nn:PATH" bots a shared broker per weights file; maxBatch < 2
+// turns batching off again for bots created afterwards
+void enablePolicyBatching(int maxBatch, double maxWait);
+
+// Function to get the shared broker for a weights file; nullptr if batching is off or the file cannot
+// be read
+std::shared_ptr<InferenceBroker> policyBroker(const std::string& path);
+
+// Function to sum the statistics of all shared brokers
+BrokerStats policyBatchingStats();
+
+// Bot that plays the policy's best safe move, scored through a broker
+class BrokeredPolicyBot : public Bot {
+public:
+	explicit BrokeredPolicyBot(std::shared_ptr<InferenceBroker> shared) : broker(shared) {}
+
+	Dir chooseMove(const Engine& engine, int snake) override;
+
+private:
+	std::shared_ptr<InferenceBroker> broker;
+	alignas(64) uint8_t features[PolicyNet::INPUTS];
+};
@@ -0,0 +1,79 @@
+#pragma once
+// Bounded lock-free multi-producer/multi-consumer queue (Vyukov's sequence-numbered ring).
+// Each slot carries a sequence number that tells producers and consumers whose turn it is, so a
+// push or pop is one compare-and-swap on the shared position plus a store to the slot.
+#include <atomic>        // For positions and slot sequence numbers
+#include <cstddef>       // For size_t
+#include <cstdint>       // For intptr_t
+#include <vector>        // For the slot ring
+
+template <class T>
+class LockFreeQueue {
+public:
+	// Constructor: capacity is rounded up to a power of two
+	explicit LockFreeQueue(size_t capacity) {
+		size_t size = 2;
+		while (size < capacity) size <<= 1;
+		slots = std::vector<Slot>(size);
+		mask = size - 1;
+		for (size_t i = 0; i < size; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+		enqueuePos.store(0, std::memory_order_relaxed);
+		dequeuePos.store(0, std::memory_order_relaxed);
+	}
+
+	// Function to add an item; returns false if the queue is full
+	bool tryPush(const T& item) {
+		size_t pos = enqueuePos.load(std::memory_order_relaxed);
+		while (true) {
+			Slot& slot = slots[pos & mask];
+			size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+			if (diff == 0) {
+				if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					slot.value = item;
+					slot.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Function to take the oldest item; returns false if the queue is empty
+	bool tryPop(T& item) {
+		size_t pos = dequeuePos.load(std::memory_order_relaxed);
+		while (true) {
+			Slot& slot = slots[pos & mask];
+			size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+			if (diff == 0) {
+				if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					item = slot.value;
+					slot.sequence.store(pos + mask + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+private:
+	struct Slot {
+		std::atomic<size_t> sequence;
+		T value;
+
+		Slot() : sequence(0), value() {}
+		Slot(const Slot&) : sequence(0), value() {}  // Only used while sizing the ring
+	};
+
+	std::vector<Slot> slots;
+	size_t mask = 0;
+	alignas(64) std::atomic<size_t> enqueuePos;  // Separate cache lines for producers and consumers
+	alignas(64) std::atomic<size_t> dequeuePos;
+};
@@ -0,0 +1,28 @@
+#pragma once
+// Read-only memory-mapped file (MapViewOfFile on Windows, mmap elsewhere).
+#include <cstddef>       // For size_t
+#include <string>        // For the path
+
+class MappedFile {
+public:
+	MappedFile() {}
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& path);  // Map the whole file; false if missing or empty
+	void close();                        // Unmap (safe to call twice)
+
+	const unsigned char* data() const { return bytes; }
+	size_t size() const { return length; }
+	bool isOpen() const { return bytes != nullptr; }
+
+private:
+	const unsigned char* bytes = nullptr;  // Start of the mapping
+	size_t length = 0;                     // Mapped bytes
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
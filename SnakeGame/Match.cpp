@@ -0,0 +1,176 @@
+#include "Match.h"
+#include <algorithm>     // For max
+#include "Analytics.h"
+#include "Bitboard.h"
+using namespace std;
+
+// Function to add the neighbours of every cell in `from` to it, keeping only cells set in `within`
+static void spread(const Bitboard& within, const Bitboard& from, Bitboard& to) {
+	Bitboard grown(from.cellCount);
+	for (int y = 1; y <= from.cellCount; y++) {
+		uint64_t row = from.rows[y];
+		grown.rows[y] = (row | row << 1 | row >> 1 | from.rows[y - 1] | from.rows[y + 1]) & within.rows[y];
+	}
+	to = grown;
+}
+
+// Function to check cheaply whether the free cells next to a snake's head form a region of at most
+// `limit` cells; stops as soon as the region grows past the limit
+static bool smallRegion(const Engine& engine, int snake, int limit) {
+	const int MAX_LIMIT = 255;
+	if (limit < 0) return false;
+	if (limit > MAX_LIMIT) return true;  // Leave long snakes to the full check
+	Cell queue[MAX_LIMIT + 1];
+	Bitboard seen(engine.rules.cellCount);
+	Cell head = engine.snakes[snake].head();
+	seen.set(head);
+	int count = 0;
+	for (int i = -1; i < count; i++) {
+		Cell from = i < 0 ? head : queue[i];
+		for (int d = 0; d < 4; d++) {
+			Cell next = stepCell(from, (Dir)d);
+			if (!engine.inBounds(next) || seen.test(next) || engine.occupied(next)) continue;
+			if (count == limit) return false;
+			seen.set(next);
+			queue[count++] = next;
+		}
+	}
+	return true;
+}
+
+int decidedWinner(const Engine& engine) {
+	int cells = engine.rules.cellCount;
+	if (!engine.running || engine.rules.stepsPerTick != 1 || cells > Bitboard::MAX_CELLS) return NO_WINNER;
+	bool small[2];
+	for (int i = 0; i < 2; i++) {
+		small[i] = engine.inBounds(engine.snakes[i].head()) && smallRegion(engine, i, engine.snakes[i].length - 2);
+	}
+	if (!small[0] && !small[1]) return NO_WINNER;  // Nearly every tick ends here
+	Bitboard free = freeCells(engine);
+	Bitboard board(cells);
+	uint64_t columns = cells == 64 ? ~0ULL : (1ULL << cells) - 1;
+	for (int y = 1; y <= cells; y++) board.rows[y] = columns;
+
+	for (int loser = 0; loser < 2; loser++) {
+		if (!small[loser]) continue;
+		const EngineSnake& sealed = engine.snakes[loser];
+		Cell head = sealed.head();
+		Bitboard region(cells);
+		for (int d = 0; d < 4; d++) {
+			Cell next = stepCell(head, (Dir)d);
+			if (engine.inBounds(next) && free.test(next)) region.set(next);
+		}
+		floodFill(free, region);
+		int area = region.count();
+		// Within area + 1 ticks every cell the snake enters stays part of its body
+		if (area + 2 > sealed.length) continue;
+
+		// A segment among the last area + 1 of either snake may move away in time to open an exit
+		Bitboard border = region;
+		border.set(head);
+		spread(board, border, border);
+		bool open = false;
+		for (int s = 0; s < 2 && !open; s++) {
+			const EngineSnake& snake = engine.snakes[s];
+			for (int t = 0; t <= area && t < snake.length && !open; t++) {
+				Cell c = snake.segment(snake.length - 1 - t);
+				open = engine.inBounds(c) && border.test(c);
+			}
+		}
+		if (open) continue;
+
+		// The sealed snake crashes by its (area + 1)th move; the other one must be able to make that many
+		const EngineSnake& other = engine.snakes[1 - loser];
+		if (!engine.inBounds(other.head())) continue;
+		Bitboard room = free;
+		for (int y = 1; y <= cells; y++) room.rows[y] &= ~region.rows[y];
+		Bitboard layer(cells);
+		layer.set(other.head());
+		Bitboard reached = layer;
+		int depth = 0;
+		while (depth <= area) {
+			spread(room, layer, layer);
+			bool any = false;
+			for (int y = 1; y <= cells; y++) {
+				layer.rows[y] &= ~reached.rows[y];
+				reached.rows[y] |= layer.rows[y];
+				any |= layer.rows[y] != 0;
+			}
+			if (!any) break;
+			depth++;
+		}
+		if (depth > area) return loser == 0 ? 2 : 1;
+	}
+	return NO_WINNER;
+}
+
+int PositionHistory::record(uint64_t hash) {
+	if ((used + 1) * 2 > slots.size()) {  // Keep the table at most half full
+		vector<Slot> old(max<size_t>(slots.size() * 2, 256), Slot{ 0, 0, 0 });
+		old.swap(slots);
+		size_t mask = slots.size() - 1;
+		for (const Slot& entry : old) {
+			if (entry.epoch != epoch) continue;
+			size_t index = entry.hash & mask;
+			while (slots[index].epoch == epoch) index = (index + 1) & mask;
+			slots[index] = entry;
+		}
+	}
+	size_t mask = slots.size() - 1;
+	size_t index = hash & mask;  // Position hashes are already mixed
+	while (slots[index].epoch == epoch && slots[index].hash != hash) index = (index + 1) & mask;
+	Slot& slot = slots[index];
+	if (slot.epoch != epoch) {
+		slot = Slot{ hash, epoch, 0 };
+		used++;
+	}
+	return (int)++slot.count;
+}
+
+MatchResult playMatch(const Rules& rules, Bot& bot1, Bot& bot2, uint64_t seed, const MatchLimits& limits,
+	AnalyticsAccumulator* analytics) {
+	Engine engine(rules, seed);
+	return playMatch(engine, rules, bot1, bot2, seed, limits, analytics);
+}
+
+MatchResult playMatch(Engine& engine, const Rules& rules, Bot& bot1, Bot& bot2, uint64_t seed,
+	const MatchLimits& limits, AnalyticsAccumulator* analytics) {
+	engine.restart(rules, seed);
+	MatchResult result;
+	result.seed = seed;
+	PositionHistory history;
+	if (analytics) analytics->beginMatch(engine);
+	while (engine.running && engine.tick < limits.maxTicks) {
+		if (limits.adjudicateEvery > 0 && engine.tick % limits.adjudicateEvery == 0) {
+			result.winner = decidedWinner(engine);
+			result.adjudicated = result.winner != NO_WINNER;
+			if (result.adjudicated) break;
+		}
+		if (limits.repetitions > 0 && history.record(engine.positionHash()) >= limits.repetitions) {
+			result.winner = DRAW;
+			result.repeated = true;
+			break;
+		}
+		Dir move1 = bot1.chooseMove(engine, 0);
+		Dir move2 = bot2.chooseMove(engine, 1);
+		engine.setDirection(0, move1);
+		engine.setDirection(1, move2);
+		uint32_t events = engine.update();
+		if (analytics) analytics->observe(engine, events);
+		if (events & (EVENT_FOOD1 | EVENT_FOOD2 | EVENT_POWERUP1 | EVENT_POWERUP2)) history.clear();
+	}
+	if (engine.running && engine.tick >= limits.maxTicks && limits.drawAtCap) result.winner = DRAW;
+	if (result.winner != NO_WINNER && engine.running) {  // Ended here rather than by a crash
+		if (analytics) analytics->observeEnd(engine, result.winner);
+	} else {
+		result.winner = engine.winner;
+	}
+	result.ticks = (int)engine.tick;
+	for (int i = 0; i < 2; i++) {
+		result.score[i] = engine.snakes[i].score;
+		result.length[i] = engine.snakes[i].length;
+		result.deathCause[i] = engine.deathCause[i];
+		if (result.adjudicated && result.winner != i + 1) result.deathCause[i] = DEATH_SEALED;  // Sealed in, not crashed yet
+	}
+	return result;
+}
@@ -0,0 +1,73 @@
+#pragma once
+// Headless bot-vs-bot matches.
+//
+// With adjudication on, a match ends as soon as reachability proves its result (see decidedWinner):
+// the winner is the side that wins with correct play, so a bot that would still blunder a won position
+// gets credited with the win. The tick count is then the tick of the adjudication, not of the crash.
+// A sealed snake crashes within fewer ticks than its length, so only bots that take real time per move
+// gain from checking every tick; for cheap bots a check every few ticks keeps the overhead small.
+//
+// Bots can also chase each other around forever. With a repetition limit, every tick's position hash
+// (Engine::positionHash, kept up incrementally) goes into a per-match history, and a position that comes
+// up that many times ends the match as a DRAW. Eating makes a snake longer for good, so no earlier
+// position can come back and the history is emptied; it only ever holds the positions since the last
+// meal. The tick cap can also be scored as a DRAW, so every match ends with a result in bounded time.
+#include <cstdint>       // For fixed-width integer types
+#include <vector>        // For the position history
+#include "Bot.h"
+
+class AnalyticsAccumulator;
+
+struct MatchResult {
+	uint64_t seed = 0;        // Engine seed of the match
+	int winner = NO_WINNER;   // 1, 2, DRAW, or NO_WINNER if the tick cap was hit
+	int ticks = 0;            // Ticks played
+	int score[2] = { 0, 0 };  // Final scores
+	int length[2] = { 0, 0 }; // Final lengths
+	DeathCause deathCause[2] = { DEATH_NONE, DEATH_NONE };  // What each snake ran into (DEATH_SEALED if adjudicated)
+	bool adjudicated = false; // Ended early by decidedWinner() (the loser has not crashed yet)
+	bool repeated = false;    // Drawn because a position came up MatchLimits::repetitions times
+};
+
+// Limits of a headless match
+struct MatchLimits {
+	int maxTicks = 5000;      // Tick cap
+	int adjudicateEvery = 0;  // Check decidedWinner() every this many ticks (0 = never)
+	int repetitions = 0;      // Draw when one position comes up this many times (0 = never)
+	bool drawAtCap = false;   // Score a match that reaches maxTicks as a DRAW instead of NO_WINNER
+};
+
+// Occurrence counts of position hashes: an open-addressing table that doubles when half full.
+// clear() only starts a new epoch; slots stamped with an older one count as free.
+class PositionHistory {
+public:
+	void clear() { epoch++; used = 0; }  // Forget every position
+	int record(uint64_t hash);           // Count one more occurrence of a position and return its count
+
+private:
+	struct Slot {
+		uint64_t hash;   // Position hash
+		uint32_t epoch;  // Epoch the slot was filled in (0 = never)
+		uint32_t count;  // Occurrences in that epoch
+	};
+
+	std::vector<Slot> slots;  // Allocated on first use
+	uint32_t epoch = 1;       // Current epoch
+	size_t used = 0;          // Slots filled in the current epoch
+};
+
+// Function to find a provably decided position (one move per tick only, boards up to
+// Bitboard::MAX_CELLS wide). A snake is sealed when its head region of free cells is smaller than its
+// length and no segment that can move away within that many ticks borders the region, so it must crash
+// however it moves; the match is decided if the other snake can outlive it on a shortest path through
+// cells the sealed snake can never reach. Returns the winner (1 or 2) or NO_WINNER if nothing is proven.
+int decidedWinner(const Engine& engine);
+
+// Function to play one match between two bots; bot1 controls the first snake. Every tick is fed
+// to analytics when one is given.
+MatchResult playMatch(const Rules& rules, Bot& bot1, Bot& bot2, uint64_t seed, const MatchLimits& limits,
+	AnalyticsAccumulator* analytics = nullptr);
+
+// Function to play one match on a pooled engine (restarted with the rules and seed first)
+MatchResult playMatch(Engine& engine, const Rules& rules, Bot& bot1, Bot& bot2, uint64_t seed,
+	const MatchLimits& limits, AnalyticsAccumulator* analytics = nullptr);
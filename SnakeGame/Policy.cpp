@@ -0,0 +1,369 @@
+#include "Policy.h"
+#if defined(__AVX512BW__)
+#include <immintrin.h>   // For the 64-byte dot products
+#define POLICY_AVX512 1
+#elif defined(__AVX2__)
+#include <immintrin.h>   // For the 32-byte dot products
+#define POLICY_AVX2 1
+#endif
+#include <algorithm>     // For min, max and swap
+#include <cmath>         // For exp, sqrt and lround
+#include <cstdio>        // For the weights file
+#include <cstring>       // For memset, memcmp and memcpy
+#include <map>           // For the weights cache
+#include <mutex>         // For the weights cache
+using namespace std;
+
+static const char POLICY_MAGIC[8] = { 'S', 'N', 'A', 'K', 'E', 'N', 'E', 'T' };
+
+// Header of a weights file; the layers follow in declaration order, native byte order
+struct PolicyHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t window;
+	uint32_t inputs;
+	uint32_t hidden1;
+	uint32_t hidden2;
+	uint32_t outputs;
+};
+
+PolicyNet::PolicyNet() : weights1(), scale1(), bias1(), weights2(), bias2(), weights3(), bias3() {}
+
+bool PolicyNet::load(const string& path) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file) return false;
+	PolicyHeader header;
+	bool ok = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, POLICY_MAGIC, sizeof(POLICY_MAGIC)) == 0 &&
+		header.version == 1 && header.window == WINDOW && header.inputs == INPUTS && header.hidden1 == HIDDEN1 &&
+		header.hidden2 == HIDDEN2 && header.outputs == OUTPUTS;
+	ok = ok && fread(weights1, sizeof(weights1), 1, file) == 1 && fread(scale1, sizeof(scale1), 1, file) == 1 &&
+		fread(bias1, sizeof(bias1), 1, file) == 1 && fread(weights2, sizeof(weights2), 1, file) == 1 &&
+		fread(bias2, sizeof(bias2), 1, file) == 1 && fread(weights3, sizeof(weights3), 1, file) == 1 &&
+		fread(bias3, sizeof(bias3), 1, file) == 1;
+	fclose(file);
+	return ok;
+}
+
+bool PolicyNet::save(const string& path) const {
+	FILE* file = fopen(path.c_str(), "wb");
+	if (!file) return false;
+	PolicyHeader header = {};
+	memcpy(header.magic, POLICY_MAGIC, sizeof(POLICY_MAGIC));
+	header.version = 1;
+	header.window = WINDOW;
+	header.inputs = INPUTS;
+	header.hidden1 = HIDDEN1;
+	header.hidden2 = HIDDEN2;
+	header.outputs = OUTPUTS;
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(weights1, sizeof(weights1), 1, file) == 1 &&
+		fwrite(scale1, sizeof(scale1), 1, file) == 1 && fwrite(bias1, sizeof(bias1), 1, file) == 1 &&
+		fwrite(weights2, sizeof(weights2), 1, file) == 1 && fwrite(bias2, sizeof(bias2), 1, file) == 1 &&
+		fwrite(weights3, sizeof(weights3), 1, file) == 1 && fwrite(bias3, sizeof(bias3), 1, file) == 1;
+	return fclose(file) == 0 && ok;
+}
+
+// Function to set four flags for the side a target lies on, in Dir order
+static void sideFlags(Cell from, Cell target, uint8_t* flags) {
+	flags[DIR_UP] = target.y < from.y;
+	flags[DIR_RIGHT] = target.x > from.x;
+	flags[DIR_DOWN] = target.y > from.y;
+	flags[DIR_LEFT] = target.x < from.x;
+}
+
+void PolicyNet::observe(const Engine& engine, int snake, uint8_t* features) {
+	const int half = WINDOW / 2;
+	const int plane = WINDOW * WINDOW;
+	memset(features, 0, INPUTS);
+	Cell head = engine.snakes[snake].head();
+	Cell shown = engine.showPowerup ? engine.powerup : Cell{ -1, -1 };
+	for (int dy = -half; dy <= half; dy++) {
+		for (int dx = -half; dx <= half; dx++) {
+			Cell c = Cell{ head.x + dx, head.y + dy };
+			int i = (dy + half) * WINDOW + dx + half;
+			if (!engine.inBounds(c)) {
+				features[2 * plane + i] = 1;
+				continue;
+			}
+			int index = engine.cellIndex(c);
+			features[i] = engine.occupancy[snake][index] != 0;
+			features[plane + i] = engine.occupancy[1 - snake][index] != 0;
+			features[3 * plane + i] = c == engine.food || c == shown;
+		}
+	}
+	uint8_t* extra = features + CHANNELS * plane;
+	extra[engine.snakes[snake].direction] = 1;
+	sideFlags(head, engine.food, extra + 4);
+	sideFlags(head, engine.snakes[1 - snake].head(), extra + 8);
+}
+
+// Function to take the dot products of one weight row with four observations
+static inline void dotRow(const int8_t* row, const uint8_t* const in[4], int32_t out[4]) {
+#if defined(POLICY_AVX512)
+	__m512i sums[4] = { _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512(), _mm512_setzero_si512() };
+#if !defined(__AVX512VNNI__)
+	const __m512i ones = _mm512_set1_epi16(1);
+#endif
+	for (int i = 0; i < PolicyNet::INPUTS; i += 64) {
+		__m512i w = _mm512_load_si512((const void*)(row + i));
+		for (int k = 0; k < 4; k++) {
+			__m512i x = _mm512_loadu_si512((const void*)(in[k] + i));
+#if defined(__AVX512VNNI__)
+			sums[k] = _mm512_dpbusd_epi32(sums[k], x, w);
+#else
+			sums[k] = _mm512_add_epi32(sums[k], _mm512_madd_epi16(_mm512_maddubs_epi16(x, w), ones));  // 0/1 inputs never saturate
+#endif
+		}
+	}
+	for (int k = 0; k < 4; k++) out[k] = _mm512_reduce_add_epi32(sums[k]);
+#elif defined(POLICY_AVX2)
+	__m256i sums[4] = { _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+	const __m256i ones = _mm256_set1_epi16(1);
+	for (int i = 0; i < PolicyNet::INPUTS; i += 32) {
+		__m256i w = _mm256_load_si256((const __m256i*)(row + i));
+		for (int k = 0; k < 4; k++) {
+			__m256i x = _mm256_loadu_si256((const __m256i*)(in[k] + i));
+			sums[k] = _mm256_add_epi32(sums[k], _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));  // 0/1 inputs never saturate
+		}
+	}
+	for (int k = 0; k < 4; k++) {
+		__m128i s = _mm_add_epi32(_mm256_castsi256_si128(sums[k]), _mm256_extracti128_si256(sums[k], 1));
+		s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+		s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+		out[k] = _mm_cvtsi128_si32(s);
+	}
+#else
+	for (int k = 0; k < 4; k++) {
+		int32_t sum = 0;
+		for (int i = 0; i < PolicyNet::INPUTS; i++) sum += in[k][i] * row[i];
+		out[k] = sum;
+	}
+#endif
+}
+
+void PolicyNet::finish(const int32_t* sums, float* logits) const {
+	float hidden1[HIDDEN1];
+	float hidden2[HIDDEN2];
+	for (int j = 0; j < HIDDEN1; j++) hidden1[j] = max(0.0f, (float)sums[j] * scale1[j] + bias1[j]);
+	for (int i = 0; i < HIDDEN2; i++) hidden2[i] = bias2[i];
+	for (int j = 0; j < HIDDEN1; j++) {
+		float h = hidden1[j];
+		for (int i = 0; i < HIDDEN2; i++) hidden2[i] += h * weights2[j][i];
+	}
+	for (int o = 0; o < OUTPUTS; o++) logits[o] = bias3[o];
+	for (int i = 0; i < HIDDEN2; i++) {
+		float h = max(0.0f, hidden2[i]);
+		for (int o = 0; o < OUTPUTS; o++) logits[o] += h * weights3[i][o];
+	}
+}
+
+void PolicyNet::evaluate(const uint8_t* features, int count, float* logits) const {
+	int32_t sums[4][HIDDEN1];
+	for (int first = 0; first < count; first += 4) {
+		int n = min(4, count - first);
+		const uint8_t* in[4];
+		for (int k = 0; k < 4; k++) in[k] = features + (size_t)(first + min(k, n - 1)) * INPUTS;  // Pad with the last one
+		for (int j = 0; j < HIDDEN1; j++) {
+			int32_t out[4];
+			dotRow(weights1[j], in, out);
+			for (int k = 0; k < 4; k++) sums[k][j] = out[k];
+		}
+		for (int k = 0; k < n; k++) finish(sums[k], logits + (size_t)(first + k) * OUTPUTS);
+	}
+}
+
+void PolicyNet::evaluateScalar(const uint8_t* features, int count, float* logits) const {
+	int32_t sums[HIDDEN1];
+	for (int b = 0; b < count; b++) {
+		const uint8_t* in = features + (size_t)b * INPUTS;
+		for (int j = 0; j < HIDDEN1; j++) {
+			int32_t sum = 0;
+			for (int i = 0; i < INPUTS; i++) sum += in[i] * weights1[j][i];
+			sums[j] = sum;
+		}
+		finish(sums, logits + (size_t)b * OUTPUTS);
+	}
+}
+
+shared_ptr<const PolicyNet> loadPolicy(const string& path) {
+	static mutex lock;
+	static map<string, shared_ptr<const PolicyNet>> loaded;
+	lock_guard<mutex> guard(lock);
+	auto found = loaded.find(path);
+	if (found != loaded.end()) return found->second;
+	shared_ptr<PolicyNet> net = make_shared<PolicyNet>();
+	if (!net->load(path)) return nullptr;
+	loaded[path] = net;
+	return net;
+}
+
+Dir policyMove(const Engine& engine, int snake, const float* logits) {
+	Dir current = engine.snakes[snake].direction;
+	Dir best = current;
+	float bestScore = 0;
+	bool bestSafe = false, found = false;
+	for (int d = 0; d < 4; d++) {
+		if ((Dir)d == oppositeDir(current)) continue;
+		bool safe = isSafeMove(engine, snake, (Dir)d);
+		if (!found || (safe && !bestSafe) || (safe == bestSafe && logits[d] > bestScore)) {
+			best = (Dir)d;
+			bestScore = logits[d];
+			bestSafe = safe;
+			found = true;
+		}
+	}
+	return best;
+}
+
+Dir PolicyBot::chooseMove(const Engine& engine, int snake) {
+	float logits[PolicyNet::OUTPUTS];
+	PolicyNet::observe(engine, snake, features);
+	net->evaluate(features, 1, logits);
+	return policyMove(engine, snake, logits);
+}
+
+bool recordSamples(const Rules& rules, const string& teacher, size_t count, uint64_t seed, PolicySamples& samples) {
+	if (!createBot(teacher, 0)) return false;
+	samples.features.assign(count * PolicyNet::INPUTS, 0);
+	samples.moves.clear();
+	Engine engine(rules, seed);
+	for (uint64_t match = 0; samples.size() < count; match++) {
+		uint64_t matchSeed = mix64(seed ^ mix64(match));
+		unique_ptr<Bot> bots[2] = { createBot(teacher, matchSeed ^ 1), createBot(teacher, matchSeed ^ 2) };
+		engine.restart(rules, matchSeed);
+		while (engine.running && engine.tick < 5000 && samples.size() < count) {
+			Dir moves[2];
+			for (int s = 0; s < 2; s++) moves[s] = bots[s]->chooseMove(engine, s);
+			for (int s = 0; s < 2 && samples.size() < count; s++) {
+				PolicyNet::observe(engine, s, &samples.features[samples.size() * PolicyNet::INPUTS]);
+				samples.moves.push_back((uint8_t)moves[s]);
+			}
+			engine.setDirection(0, moves[0]);
+			engine.setDirection(1, moves[1]);
+			engine.update();
+		}
+	}
+	return true;
+}
+
+// Float copy of the network for training; the first layer is input-major so a set input adds one row
+struct TrainingNet {
+	vector<float> weights1, bias1, weights2, bias2, weights3, bias3;
+
+	TrainingNet() : weights1(PolicyNet::INPUTS * PolicyNet::HIDDEN1), bias1(PolicyNet::HIDDEN1),
+		weights2(PolicyNet::HIDDEN1 * PolicyNet::HIDDEN2), bias2(PolicyNet::HIDDEN2),
+		weights3(PolicyNet::HIDDEN2 * PolicyNet::OUTPUTS), bias3(PolicyNet::OUTPUTS) {}
+};
+
+double trainPolicy(const PolicySamples& samples, int epochs, uint64_t seed, PolicyNet& net) {
+	const int H1 = PolicyNet::HIDDEN1, H2 = PolicyNet::HIDDEN2, OUT = PolicyNet::OUTPUTS;
+	size_t count = samples.size();
+	if (count == 0) return 0;
+
+	// Inputs are sparse, so keep the set input indices of every sample
+	vector<uint32_t> starts(count + 1, 0);
+	vector<uint16_t> active;
+	for (size_t n = 0; n < count; n++) {
+		const uint8_t* row = &samples.features[n * PolicyNet::INPUTS];
+		for (int i = 0; i < PolicyNet::INPUTS; i++) {
+			if (row[i]) active.push_back((uint16_t)i);
+		}
+		starts[n + 1] = (uint32_t)active.size();
+	}
+
+	// He-style uniform initialization; the first layer's fan-in is the average number of set inputs
+	SimRng rng(seed);
+	auto uniform = [&](float limit) { return (float)((rng.next() >> 11) * (1.0 / 9007199254740992.0) * 2 - 1) * limit; };
+	TrainingNet t;
+	float fanIn1 = max(1.0f, (float)active.size() / count);
+	for (float& w : t.weights1) w = uniform(sqrt(6.0f / fanIn1));
+	for (float& w : t.weights2) w = uniform(sqrt(6.0f / H1));
+	for (float& w : t.weights3) w = uniform(sqrt(6.0f / H2));
+
+	vector<uint32_t> order(count);
+	for (size_t n = 0; n < count; n++) order[n] = (uint32_t)n;
+	float z1[H1], h1[H1], z2[H2], h2[H2], out[OUT], dz1[H1], dz2[H2], dout[OUT];
+	uint64_t steps = (uint64_t)epochs * count, step = 0;
+	for (int epoch = 0; epoch < epochs; epoch++) {
+		for (size_t n = count - 1; n > 0; n--) swap(order[n], order[rng.next() % (n + 1)]);
+		for (size_t k = 0; k < count; k++, step++) {
+			size_t n = order[k];
+			float rate = 0.02f * (1.0f - 0.9f * (float)step / steps);  // Linear decay to a tenth
+			const uint16_t* set = &active[starts[n]];
+			int setCount = (int)(starts[n + 1] - starts[n]);
+
+			// Forward
+			for (int j = 0; j < H1; j++) z1[j] = t.bias1[j];
+			for (int a = 0; a < setCount; a++) {
+				const float* w = &t.weights1[(size_t)set[a] * H1];
+				for (int j = 0; j < H1; j++) z1[j] += w[j];
+			}
+			for (int j = 0; j < H1; j++) h1[j] = max(0.0f, z1[j]);
+			for (int i = 0; i < H2; i++) z2[i] = t.bias2[i];
+			for (int j = 0; j < H1; j++) {
+				for (int i = 0; i < H2; i++) z2[i] += h1[j] * t.weights2[j * H2 + i];
+			}
+			for (int i = 0; i < H2; i++) h2[i] = max(0.0f, z2[i]);
+			float peak = -1e30f, total = 0;
+			for (int o = 0; o < OUT; o++) {
+				out[o] = t.bias3[o];
+				for (int i = 0; i < H2; i++) out[o] += h2[i] * t.weights3[i * OUT + o];
+				peak = max(peak, out[o]);
+			}
+			for (int o = 0; o < OUT; o++) total += dout[o] = exp(out[o] - peak);
+
+			// Backward (softmax cross-entropy), updating each layer once its gradient is passed on
+			for (int o = 0; o < OUT; o++) dout[o] = dout[o] / total - (o == samples.moves[n]);
+			for (int i = 0; i < H2; i++) {
+				float g = 0;
+				for (int o = 0; o < OUT; o++) {
+					g += t.weights3[i * OUT + o] * dout[o];
+					t.weights3[i * OUT + o] -= rate * h2[i] * dout[o];
+				}
+				dz2[i] = z2[i] > 0 ? g : 0;
+			}
+			for (int o = 0; o < OUT; o++) t.bias3[o] -= rate * dout[o];
+			for (int j = 0; j < H1; j++) {
+				float g = 0;
+				for (int i = 0; i < H2; i++) {
+					g += t.weights2[j * H2 + i] * dz2[i];
+					t.weights2[j * H2 + i] -= rate * h1[j] * dz2[i];
+				}
+				dz1[j] = z1[j] > 0 ? g : 0;
+			}
+			for (int i = 0; i < H2; i++) t.bias2[i] -= rate * dz2[i];
+			for (int a = 0; a < setCount; a++) {
+				float* w = &t.weights1[(size_t)set[a] * H1];
+				for (int j = 0; j < H1; j++) w[j] -= rate * dz1[j];
+			}
+			for (int j = 0; j < H1; j++) t.bias1[j] -= rate * dz1[j];
+		}
+	}
+
+	// Quantize the first layer row by row; the rest stays float
+	for (int j = 0; j < H1; j++) {
+		float peak = 0;
+		for (int i = 0; i < PolicyNet::INPUTS; i++) peak = max(peak, fabs(t.weights1[(size_t)i * H1 + j]));
+		float scale = peak > 0 ? peak / 127 : 1.0f;
+		for (int i = 0; i < PolicyNet::INPUTS; i++) net.weights1[j][i] = (int8_t)lround(t.weights1[(size_t)i * H1 + j] / scale);
+		net.scale1[j] = scale;
+		net.bias1[j] = t.bias1[j];
+	}
+	for (int j = 0; j < H1; j++) {
+		for (int i = 0; i < H2; i++) net.weights2[j][i] = t.weights2[j * H2 + i];
+	}
+	for (int i = 0; i < H2; i++) {
+		net.bias2[i] = t.bias2[i];
+		for (int o = 0; o < OUT; o++) net.weights3[i][o] = t.weights3[i * OUT + o];
+	}
+	for (int o = 0; o < OUT; o++) net.bias3[o] = t.bias3[o];
+
+	// Accuracy of the quantized net
+	vector<float> logits(count * OUT);
+	net.evaluate(samples.features.data(), (int)count, logits.data());
+	size_t matched = 0;
+	for (size_t n = 0; n < count; n++) {
+		const float* l = &logits[n * OUT];
+		matched += (int)(max_element(l, l + OUT) - l) == samples.moves[n];
+	}
+	return (double)matched / count;
+}
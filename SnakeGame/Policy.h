@@ -0,0 +1,88 @@
+#pragma once
+// Neural-network policy bot.
+// A small MLP maps what a snake sees to one score per direction. The input is a 9 x 9 window around
+// the head in four binary planes (own body, opponent body, off the board, food or visible power-up),
+// plus the snake's direction and which way the food and the opponent's head lie, padded to 384 bytes.
+// The first layer (384 -> 64) has int8 weights with a float scale per output. Inputs are 0 or 1, so it
+// runs as unsigned-by-signed byte dot products: 64 bytes per instruction with AVX-512BW (one VNNI
+// instruction per 64 bytes with AVX512-VNNI), 32 with AVX2, scalar otherwise. The two small float
+// layers after it (64 -> 32 -> 4) are plain loops the compiler vectorizes. evaluate() takes a batch of
+// observations and runs four of them against each weight row at a time.
+//
+// Weights come from a binary file (see save()); `snake_sim --nn-train` writes one by imitating a
+// built-in bot, and `snake_sim --nn-bench` checks the SIMD kernels against scalar code and times them.
+#include <cstdint>       // For fixed-width integer types
+#include <memory>        // For the shared weights
+#include <string>        // For the weights path
+#include <vector>        // For training samples
+#include "Bot.h"
+
+class PolicyNet {
+public:
+	static const int WINDOW = 9;                                   // Side of the view around the head
+	static const int CHANNELS = 4;                                 // Own body, opponent body, off board, food
+	static const int EXTRA = 12;                                   // Direction, food side and opponent side flags
+	static const int FEATURES = WINDOW * WINDOW * CHANNELS + EXTRA;// Used input bytes
+	static const int INPUTS = 384;                                 // Input bytes per observation (padded with zeros)
+	static const int HIDDEN1 = 64;                                 // First hidden layer
+	static const int HIDDEN2 = 32;                                 // Second hidden layer
+	static const int OUTPUTS = 4;                                  // One score per Dir
+
+	alignas(64) int8_t weights1[HIDDEN1][INPUTS];  // First layer, quantized
+	float scale1[HIDDEN1];                         // Dequantization scale of each first-layer row
+	float bias1[HIDDEN1];
+	float weights2[HIDDEN1][HIDDEN2];              // Input-major, so each input adds to a contiguous row
+	float bias2[HIDDEN2];
+	float weights3[HIDDEN2][OUTPUTS];
+	float bias3[OUTPUTS];
+
+	PolicyNet();
+
+	bool load(const std::string& path);        // Read a weights file; false if it is missing or malformed
+	bool save(const std::string& path) const;  // Write a weights file
+
+	// Function to write the INPUTS feature bytes of what `snake` sees
+	static void observe(const Engine& engine, int snake, uint8_t* features);
+
+	// Function to score count observations (INPUTS bytes apart) into OUTPUTS logits each
+	void evaluate(const uint8_t* features, int count, float* logits) const;
+
+	// Same as evaluate() without SIMD, for checking the kernels
+	void evaluateScalar(const uint8_t* features, int count, float* logits) const;
+
+private:
+	void finish(const int32_t* sums, float* logits) const;  // Layers after the byte dot products
+};
+
+// Function to load a weights file once per path and share it between bots; nullptr if it cannot be read
+std::shared_ptr<const PolicyNet> loadPolicy(const std::string& path);
+
+// Function to pick the best-scored safe move (or the best non-reversing one if none is safe)
+Dir policyMove(const Engine& engine, int snake, const float* logits);
+
+// Bot that plays the policy's best safe move ("nn:PATH" in createBot)
+class PolicyBot : public Bot {
+public:
+	explicit PolicyBot(std::shared_ptr<const PolicyNet> weights) : net(weights) {}
+
+	Dir chooseMove(const Engine& engine, int snake) override;
+
+private:
+	std::shared_ptr<const PolicyNet> net;
+	alignas(64) uint8_t features[PolicyNet::INPUTS];
+};
+
+// Training samples for imitation: feature rows and the move a teacher bot made
+struct PolicySamples {
+	std::vector<uint8_t> features;  // INPUTS bytes per sample
+	std::vector<uint8_t> moves;     // Teacher's Dir per sample
+	size_t size() const { return moves.size(); }
+};
+
+// Function to record samples from matches of a teacher bot against itself (both snakes, every tick)
+// until `count` samples are stored; returns false if the teacher name is unknown
+bool recordSamples(const Rules& rules, const std::string& teacher, size_t count, uint64_t seed, PolicySamples& samples);
+
+// Function to fit a policy to samples with stochastic gradient descent in float, then quantize its
+// first layer; returns the share of samples whose teacher move the quantized net scores highest
+double trainPolicy(const PolicySamples& samples, int epochs, uint64_t seed, PolicyNet& net);
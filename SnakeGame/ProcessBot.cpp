@@ -0,0 +1,248 @@
+#include "ProcessBot.h"
+#ifdef __linux__
+#include <atomic>        // For the statistics
+#include <cctype>        // For isdigit
+#include <chrono>        // For deadlines
+#include <cstdlib>       // For atof
+#include <cstring>       // For strncmp
+#include <map>           // For the process pools
+#include <mutex>         // For the process pools
+#include <vector>        // For idle processes and the environment
+#include <fcntl.h>       // For FD_CLOEXEC
+#include <signal.h>      // For SIGKILL
+#include <sys/wait.h>    // For waitpid
+#include "SnakeShm.h"
+using namespace std;
+
+extern char** environ;
+
+static atomic<uint64_t> movesTotal(0), timeoutsTotal(0), processesTotal(0), waitNanos(0), longestNanos(0);
+
+// One bot process and the channel it is attached to
+struct BotProcess {
+	SnakeShmChannel* channel = nullptr;
+	int fd = -1;
+	pid_t pid = -1;
+	bool alive = false;      // Cleared once the process is found to have exited
+	uint32_t sequence = 0;   // Last request sent
+
+	~BotProcess() {
+		if (pid > 0) {
+			__atomic_store_n(&channel->closing, 1, __ATOMIC_SEQ_CST);
+			snake_shm_wake(&channel->request);
+			// Give the process a moment to exit on its own, then kill it
+			int status;
+			bool reaped = false;
+			for (int i = 0; i < 50 && !reaped; i++) {
+				reaped = waitpid(pid, &status, WNOHANG) == pid;
+				if (!reaped) usleep(2000);
+			}
+			if (!reaped) {
+				kill(pid, SIGKILL);
+				waitpid(pid, &status, 0);
+			}
+		}
+		if (channel) munmap(channel, sizeof(SnakeShmChannel));
+		if (fd >= 0) close(fd);
+	}
+
+	// Function to check if the process is still running
+	bool running() {
+		int status;
+		if (alive && waitpid(pid, &status, WNOHANG) == pid) {
+			alive = false;
+			pid = -1;  // Reaped
+		}
+		return alive;
+	}
+};
+
+// Function to start a bot process for a shell command and wait for it to attach; nullptr on failure
+static unique_ptr<BotProcess> startProcess(const string& command) {
+	unique_ptr<BotProcess> process(new BotProcess());
+	process->fd = memfd_create("snake_shm", MFD_CLOEXEC);
+	if (process->fd < 0 || ftruncate(process->fd, sizeof(SnakeShmChannel)) != 0) return nullptr;
+	void* memory = mmap(nullptr, sizeof(SnakeShmChannel), PROT_READ | PROT_WRITE, MAP_SHARED, process->fd, 0);
+	if (memory == MAP_FAILED) return nullptr;
+	process->channel = (SnakeShmChannel*)memory;
+	process->channel->magic = SNAKE_SHM_MAGIC;
+	process->channel->abi = SNAKE_SHM_ABI;
+	process->channel->host = (uint32_t)getpid();
+
+	// Everything the child needs is prepared before fork, since only exec may follow it
+	string variable = "SNAKE_SHM_FD=" + to_string(process->fd);
+	vector<char*> environment;
+	for (char** e = environ; *e; e++) {
+		if (strncmp(*e, "SNAKE_SHM_FD=", 13) != 0) environment.push_back(*e);
+	}
+	environment.push_back(&variable[0]);
+	environment.push_back(nullptr);
+	string script = "exec " + command;  // The shell becomes the bot, so pid is the bot's
+	const char* arguments[] = { "sh", "-c", script.c_str(), nullptr };
+	pid_t pid = fork();
+	if (pid < 0) return nullptr;
+	if (pid == 0) {
+		fcntl(process->fd, F_SETFD, 0);  // Only this child inherits this channel
+		execve("/bin/sh", (char* const*)arguments, environment.data());
+		_exit(127);
+	}
+	process->pid = pid;
+	process->alive = true;
+	processesTotal.fetch_add(1, memory_order_relaxed);
+
+	// Wait up to 5 s for the bot to map the channel
+	auto giveUp = chrono::steady_clock::now() + chrono::seconds(5);
+	SnakeShmChannel* channel = process->channel;
+	while (!__atomic_load_n(&channel->ready, __ATOMIC_SEQ_CST)) {
+		if (!process->running() || chrono::steady_clock::now() > giveUp) return nullptr;
+		__atomic_store_n(&channel->hostSleeping, 1, __ATOMIC_SEQ_CST);
+		if (!__atomic_load_n(&channel->ready, __ATOMIC_SEQ_CST)) snake_shm_wait(&channel->ready, 0, 10000000);
+		__atomic_store_n(&channel->hostSleeping, 0, __ATOMIC_SEQ_CST);
+	}
+	return process;
+}
+
+// Idle processes for one "process:" name
+struct ProcessPool {
+	string command;
+	double deadline;  // Seconds per move
+	mutex lock;
+	vector<unique_ptr<BotProcess>> idle;
+};
+
+class ProcessBot : public Bot {
+public:
+	ProcessBot(shared_ptr<ProcessPool> owner, unique_ptr<BotProcess> started, uint64_t seed)
+		: pool(owner), process(move(started)), match(seed) {}
+
+	~ProcessBot() override {
+		if (!process->running()) return;
+		lock_guard<mutex> guard(pool->lock);
+		pool->idle.push_back(move(process));
+	}
+
+	Dir chooseMove(const Engine& engine, int snake) override {
+		Dir keep = engine.snakes[snake].direction;
+		movesTotal.fetch_add(1, memory_order_relaxed);
+		if (!process->alive || engine.rules.cellCount > 64) return keep;
+
+		// Write the position into the next slot, then publish it
+		SnakeShmChannel* channel = process->channel;
+		uint32_t sequence = ++process->sequence;
+		if (sequence == 0) sequence = ++process->sequence;  // 0 means "nothing yet" to the bot
+		SnakeShmSlot& slot = channel->slots[sequence % SNAKE_SHM_SLOTS];
+		slot.move = -1;
+		slot.match = match;
+		slot.tick = engine.tick;
+		slot.board = engine.rules.cellCount;
+		slot.you = snake;
+		slot.food[0] = engine.food.x;
+		slot.food[1] = engine.food.y;
+		slot.powerup[0] = engine.showPowerup ? engine.powerup.x : -1;
+		slot.powerup[1] = engine.showPowerup ? engine.powerup.y : -1;
+		for (int s = 0; s < 2; s++) {
+			const EngineSnake& body = engine.snakes[s];
+			SnakeShmSnake& out = slot.snakes[s];
+			out.length = body.length;
+			out.direction = body.direction;
+			out.score = body.score;
+			for (int i = 0; i < body.length; i++) {
+				Cell c = body.segment(i);
+				out.body[i][0] = (uint8_t)c.x;
+				out.body[i][1] = (uint8_t)c.y;
+			}
+		}
+		__atomic_store_n(&slot.sequence, sequence, __ATOMIC_RELEASE);
+		__atomic_store_n(&channel->request, sequence, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&channel->botSleeping, __ATOMIC_SEQ_CST)) snake_shm_wake(&channel->request);
+
+		// Wait for the reply: spin briefly, then sleep on the futex until the deadline
+		auto start = chrono::steady_clock::now();
+		auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(pool->deadline));
+		int32_t move = -1;
+		int spins = 0;
+		while (true) {
+			uint32_t reply = __atomic_load_n(&channel->reply, __ATOMIC_SEQ_CST);
+			if (reply == sequence) {
+				move = slot.move;
+				break;
+			}
+			if (++spins < 200) continue;
+			auto now = chrono::steady_clock::now();
+			if (now >= deadline) {
+				timeoutsTotal.fetch_add(1, memory_order_relaxed);
+				process->running();
+				break;
+			}
+			__atomic_store_n(&channel->hostSleeping, 1, __ATOMIC_SEQ_CST);
+			if (__atomic_load_n(&channel->reply, __ATOMIC_SEQ_CST) == reply) {
+				snake_shm_wait(&channel->reply, reply, chrono::duration_cast<chrono::nanoseconds>(deadline - now).count());
+			}
+			__atomic_store_n(&channel->hostSleeping, 0, __ATOMIC_SEQ_CST);
+		}
+		uint64_t waited = (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+		waitNanos.fetch_add(waited, memory_order_relaxed);
+		uint64_t longest = longestNanos.load(memory_order_relaxed);
+		while (waited > longest && !longestNanos.compare_exchange_weak(longest, waited, memory_order_relaxed)) {}
+		return move >= 0 && move < 4 ? (Dir)move : keep;
+	}
+
+private:
+	shared_ptr<ProcessPool> pool;
+	unique_ptr<BotProcess> process;
+	uint64_t match;  // Tells the process that a new match started
+};
+
+unique_ptr<Bot> createProcessBot(const string& spec, uint64_t seed) {
+	static mutex lock;
+	static map<string, shared_ptr<ProcessPool>> pools;
+	shared_ptr<ProcessPool> pool;
+	{
+		lock_guard<mutex> guard(lock);
+		shared_ptr<ProcessPool>& entry = pools[spec];
+		if (!entry) {
+			entry = make_shared<ProcessPool>();
+			entry->command = spec;
+			entry->deadline = 0.010;
+			size_t digits = 0;
+			while (digits < spec.size() && isdigit((unsigned char)spec[digits])) digits++;
+			if (digits > 0 && digits < spec.size() && spec[digits] == ':') {
+				entry->deadline = atof(spec.c_str()) / 1000;  // "MS:COMMAND"
+				entry->command = spec.substr(digits + 1);
+			}
+		}
+		pool = entry;
+	}
+	unique_ptr<BotProcess> process;
+	{
+		lock_guard<mutex> guard(pool->lock);
+		if (!pool->idle.empty()) {
+			process = move(pool->idle.back());
+			pool->idle.pop_back();
+		}
+	}
+	if (!process) process = startProcess(pool->command);
+	if (!process) return nullptr;
+	return unique_ptr<Bot>(new ProcessBot(pool, move(process), seed));
+}
+
+ProcessBotStats processBotStats() {
+	ProcessBotStats s;
+	s.moves = movesTotal.load();
+	s.timeouts = timeoutsTotal.load();
+	s.processes = processesTotal.load();
+	s.waitSeconds = waitNanos.load() / 1e9;
+	s.longestWait = longestNanos.load() / 1e9;
+	return s;
+}
+#else
+using namespace std;
+
+unique_ptr<Bot> createProcessBot(const string&, uint64_t) {
+	return nullptr;
+}
+
+ProcessBotStats processBotStats() {
+	return ProcessBotStats();
+}
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+// Bots played by another process over shared memory (see SnakeShm.h for the bot side).
+// "process:COMMAND" starts COMMAND through /bin/sh and hands it a channel; "process:MS:COMMAND" sets
+// the per-move deadline to MS milliseconds (default 10). Each move copies the position into the
+// channel, wakes the process and waits for its reply until the deadline; a move that misses it, or
+// any move of a process that has exited, keeps the snake's direction. Processes are pooled per
+// name, so a tournament starts one per concurrently playing bot rather than one per match.
+//
+// Linux only (futexes and memfd); elsewhere createProcessBot() returns nullptr.
+#include <cstdint>       // For fixed-width integer types
+#include <memory>        // For unique_ptr
+#include <string>        // For the command
+#include "Bot.h"
+
+// Totals over every process bot so far
+struct ProcessBotStats {
+	uint64_t moves = 0;        // Moves requested
+	uint64_t timeouts = 0;     // Moves that missed their deadline
+	uint64_t processes = 0;    // Processes started
+	double waitSeconds = 0;    // Time spent waiting for replies
+	double longestWait = 0;    // Longest single wait in seconds
+};
+
+// Function to create a bot for "COMMAND" or "MS:COMMAND" (the part after "process:"); nullptr if the
+// process cannot be started or does not attach within a few seconds
+std::unique_ptr<Bot> createProcessBot(const std::string& spec, uint64_t seed);
+
+// Function to read the totals so far
+ProcessBotStats processBotStats();
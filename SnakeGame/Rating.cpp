@@ -0,0 +1,120 @@
+#include "Rating.h"
+#include <algorithm>     // For min
+#include <cmath>         // For pow, sqrt, log
+#include <cstdio>        // For rename and remove
+#include <fstream>       // For the table file
+#include <sstream>       // For parsing lines
+using namespace std;
+
+static const double PI = 3.14159265358979323846;
+static const double GLICKO_Q = 0.0057564627324851142;  // ln(10) / 400
+static const double MAX_DEVIATION = 350;
+
+int RatingTable::indexOf(const string& name) {
+	auto found = index.find(name);
+	if (found != index.end()) return found->second;
+	RatingEntry entry;
+	entry.name = name;
+	entries.push_back(entry);
+	index[name] = (int)entries.size() - 1;
+	return (int)entries.size() - 1;
+}
+
+// Function to get Glicko's attenuation factor for an opponent's deviation
+static double glickoG(double deviation) {
+	return 1.0 / sqrt(1.0 + 3.0 * GLICKO_Q * GLICKO_Q * deviation * deviation / (PI * PI));
+}
+
+// Function to get the expected score of a rating against an opponent
+static double glickoExpected(double rating, double opponent, double opponentDeviation) {
+	return 1.0 / (1.0 + pow(10.0, -glickoG(opponentDeviation) * (rating - opponent) / 400.0));
+}
+
+void RatingTable::applyBatch(const vector<RatedResult>& batch) {
+	// Elo: sequential updates in batch order
+	for (const RatedResult& r : batch) {
+		RatingEntry& a = entries[r.player1];
+		RatingEntry& b = entries[r.player2];
+		double expected = 1.0 / (1.0 + pow(10.0, (b.elo - a.elo) / 400.0));
+		a.elo += eloK * (r.score1 - expected);
+		b.elo -= eloK * (r.score1 - expected);
+		a.games++;
+		b.games++;
+		if (r.score1 == 1) { a.wins++; b.losses++; }
+		else if (r.score1 == 0) { a.losses++; b.wins++; }
+		else { a.draws++; b.draws++; }
+	}
+
+	// Glicko: the batch is one rating period, so everyone is rated against pre-batch values
+	size_t count = entries.size();
+	vector<double> before(count), deviation(count), variance(count, 0), improvement(count, 0);
+	vector<bool> played(count, false);
+	for (size_t i = 0; i < count; i++) {
+		before[i] = entries[i].glicko;
+		deviation[i] = min(sqrt(entries[i].deviation * entries[i].deviation + deviationGrowth * deviationGrowth), MAX_DEVIATION);
+	}
+	for (const RatedResult& r : batch) {
+		int players[2] = { r.player1, r.player2 };
+		double scores[2] = { r.score1, 1.0 - r.score1 };
+		for (int side = 0; side < 2; side++) {
+			int self = players[side];
+			int opponent = players[1 - side];
+			double g = glickoG(deviation[opponent]);
+			double expected = glickoExpected(before[self], before[opponent], deviation[opponent]);
+			variance[self] += g * g * expected * (1 - expected);
+			improvement[self] += g * (scores[side] - expected);
+			played[self] = true;
+		}
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (played[i]) {
+			double inverseDSquared = GLICKO_Q * GLICKO_Q * variance[i];
+			double denominator = 1.0 / (deviation[i] * deviation[i]) + inverseDSquared;
+			entries[i].glicko = before[i] + GLICKO_Q / denominator * improvement[i];
+			entries[i].deviation = sqrt(1.0 / denominator);
+		} else {
+			entries[i].deviation = deviation[i];
+		}
+	}
+}
+
+bool RatingTable::load(const string& path) {
+	ifstream in(path);
+	if (!in) return false;
+	string line;
+	while (getline(in, line)) {
+		if (line.empty() || line[0] == '#') continue;
+		if (line.back() == '\r') line.pop_back();
+		istringstream fields(line);
+		RatingEntry entry;
+		if (!(fields >> entry.elo >> entry.glicko >> entry.deviation >> entry.games >> entry.wins >> entry.losses >> entry.draws)) {
+			continue;  // Skip damaged lines rather than losing the whole table
+		}
+		fields.get();
+		getline(fields, entry.name);  // The name is the rest of the line, so names with spaces survive
+		if (entry.name.empty()) continue;
+		entries[indexOf(entry.name)] = entry;
+	}
+	return true;
+}
+
+bool RatingTable::save(const string& path) const {
+	string temporary = path + ".tmp";
+	{
+		ofstream out(temporary, ios::trunc);
+		if (!out) return false;
+		out << "# elo glicko deviation games wins losses draws name\n";
+		out.setf(ios::fixed);
+		out.precision(2);
+		for (const RatingEntry& e : entries) {
+			out << e.elo << ' ' << e.glicko << ' ' << e.deviation << ' ' << e.games << ' ' << e.wins << ' '
+				<< e.losses << ' ' << e.draws << ' ' << e.name << '\n';
+		}
+		if (!out.flush()) return false;
+	}
+	if (rename(temporary.c_str(), path.c_str()) != 0) {
+		remove(path.c_str());  // Windows will not rename over an existing file
+		if (rename(temporary.c_str(), path.c_str()) != 0) return false;
+	}
+	return true;
+}
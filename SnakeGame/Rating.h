@@ -0,0 +1,47 @@
+#pragma once
+// Elo and Glicko ratings for bots, stored in a plain-text table on disk.
+// Results are applied in batches: Elo updates run through the batch in order, while the batch as
+// a whole is one Glicko rating period (every player is rated against the pre-batch ratings).
+#include <map>           // For the name index
+#include <string>        // For bot names and paths
+#include <vector>        // For the table and result batches
+
+struct RatedResult {
+	int player1 = 0;   // Table index of the bot that played snake 1
+	int player2 = 0;   // Table index of the bot that played snake 2
+	double score1 = 0; // 1 = player 1 won, 0.5 = draw, 0 = player 2 won
+};
+
+struct RatingEntry {
+	std::string name;          // Bot name
+	double elo = 1500;         // Elo rating
+	double glicko = 1500;      // Glicko rating
+	double deviation = 350;    // Glicko rating deviation
+	long long games = 0;       // Rated games
+	long long wins = 0;
+	long long losses = 0;
+	long long draws = 0;
+};
+
+class RatingTable {
+public:
+	std::vector<RatingEntry> entries;  // One entry per bot
+	double eloK = 16;                  // Elo K-factor
+	double deviationGrowth = 15;       // Glicko deviation added per rating period
+
+	// Function to find or add a bot; returns its index
+	int indexOf(const std::string& name);
+
+	// Function to apply one batch of results
+	void applyBatch(const std::vector<RatedResult>& batch);
+
+	// Function to load a table written by save(); missing files leave the table empty. Each line holds
+	// the numbers, then the name as the rest of the line (names may contain spaces)
+	bool load(const std::string& path);
+
+	// Function to write the table (to a temporary file first, then renamed over the old one)
+	bool save(const std::string& path) const;
+
+private:
+	std::map<std::string, int> index;  // Name to entry index
+};
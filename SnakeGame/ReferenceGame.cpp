@@ -0,0 +1,195 @@
+#include "ReferenceGame.h"
+using namespace std;
+
+// Function to check if a cell exists in a deque (same linear scan as elementInDeque in the game)
+static bool cellInDeque(Cell element, const deque<Cell>& cells) {
+	for (unsigned int i = 0; i < cells.size(); i++) {
+		if (cells[i] == element) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Constructor: random draws happen in the same order as the Game member initializers
+ReferenceGame::ReferenceGame(const Rules& gameRules, uint64_t seed)
+	: rules(gameRules), rng(seed) {
+	resetSnake(0, rules.start1, rules.dir1);
+	resetSnake(1, rules.start2, rules.dir2);
+	food = genRandPos();      // Food constructor
+	powerup = genRandPos();   // Power-up constructor (hidden, but already at a cell)
+	powerupTimeGap = rng.randomValue(rules.powerupGapMin, rules.powerupGapMax);
+}
+
+// Function to place a snake at its start position with three segments
+void ReferenceGame::resetSnake(int snake, Cell startPos, Dir startDirection) {
+	Cell back = dirDelta(oppositeDir(startDirection));
+	body[snake].clear();
+	direction[snake] = startDirection;
+	body[snake].push_back(startPos);
+	body[snake].push_back(Cell{ startPos.x + back.x, startPos.y + back.y });
+	body[snake].push_back(Cell{ startPos.x + 2 * back.x, startPos.y + 2 * back.y });
+}
+
+// Function to change a snake's direction with the same reversal guard as the keyboard handler
+bool ReferenceGame::setDirection(int snake, Dir d) {
+	if (d == oppositeDir(direction[snake])) return false;
+	direction[snake] = d;
+	return true;
+}
+
+// Function to update the match state by one tick
+uint32_t ReferenceGame::update() {
+	events = 0;
+	if (running) {
+		tick++;
+		moveSnake(0);
+		moveSnake(1);
+		if (rules.simultaneous) {
+			resolveSimultaneous();
+			togglePowerupOff();
+			togglePowerupOn();
+			return events;
+		}
+		checkFoodCollision(0);
+		checkFoodCollision(1);
+		checkPowerupCollision(0);
+		checkPowerupCollision(1);
+		checkCollisions();
+		togglePowerupOff();
+		togglePowerupOn();
+	}
+	return events;
+}
+
+// Function to move a snake one cell (Snake::update)
+void ReferenceGame::moveSnake(int snake) {
+	body[snake].push_front(stepCell(body[snake][0], direction[snake]));
+	if (!addSegment[snake]) {
+		body[snake].pop_back();
+	} else {
+		addSegment[snake] = false;
+	}
+}
+
+// Function to generate a random position not occupied by snakes (Food::GenRandPos)
+Cell ReferenceGame::genRandPos() {
+	Cell position;
+	do {
+		position.x = rng.randomValue(0, rules.cellCount - 1);
+		position.y = rng.randomValue(0, rules.cellCount - 1);
+	} while (cellInDeque(position, body[0]) || cellInDeque(position, body[1]));
+	return position;
+}
+
+// Function to check food collision for a snake
+void ReferenceGame::checkFoodCollision(int snake) {
+	if (body[snake][0] == food) {
+		food = genRandPos();
+		addSegment[snake] = true;
+		events |= snake == 0 ? EVENT_FOOD1 : EVENT_FOOD2;
+		score[snake] += rules.foodScore;
+	}
+}
+
+// Function to check power-up collision for a snake (the power-up is edible even while hidden)
+void ReferenceGame::checkPowerupCollision(int snake) {
+	if (body[snake][0] == powerup) {
+		powerup = Cell{ -1, -1 };
+		showPowerup = false;
+		addSegment[snake] = true;
+		events |= snake == 0 ? EVENT_POWERUP1 : EVENT_POWERUP2;
+		score[snake] += rules.powerupScore;
+	}
+}
+
+// Function to check for collisions involving snakes; the last declared winner stands
+void ReferenceGame::checkCollisions() {
+	if (isOutOfBounds(0)) declareWinner(2);
+	if (isOutOfBounds(1)) declareWinner(1);
+	if (selfCollision(0)) declareWinner(2);
+	if (selfCollision(1)) declareWinner(1);
+	if (cellInDeque(body[0][0], body[1])) declareWinner(2);
+	if (cellInDeque(body[1][0], body[0])) declareWinner(1);
+}
+
+// Function to resolve a tick simultaneously: every snake's death is decided before anyone eats
+void ReferenceGame::resolveSimultaneous() {
+	bool dead[2];
+	for (int i = 0; i < 2; i++) {
+		dead[i] = isOutOfBounds(i) || selfCollision(i) || cellInDeque(body[i][0], body[1 - i]);
+	}
+	if (dead[0] && dead[1]) declareWinner(DRAW);
+	else if (dead[0]) declareWinner(2);
+	else if (dead[1]) declareWinner(1);
+	for (int i = 0; i < 2; i++) {
+		if (!dead[i]) checkFoodCollision(i);
+	}
+	for (int i = 0; i < 2; i++) {
+		if (!dead[i] && showPowerup) checkPowerupCollision(i);
+	}
+}
+
+// Function to check if a snake's head is outside the grid
+bool ReferenceGame::isOutOfBounds(int snake) const {
+	Cell head = body[snake][0];
+	return head.x < 0 || head.x >= rules.cellCount || head.y < 0 || head.y >= rules.cellCount;
+}
+
+// Function to check if a snake has collided with itself
+bool ReferenceGame::selfCollision(int snake) const {
+	deque<Cell> headlessBody = body[snake];
+	headlessBody.pop_front();
+	return cellInDeque(body[snake][0], headlessBody);
+}
+
+// Function to manage power-up disappearance
+void ReferenceGame::togglePowerupOff() {
+	if (showPowerup && tick - powerupOnTime >= rules.powerupLifetime) {
+		powerupOnTime = tick;
+		showPowerup = false;
+		powerup = Cell{ -1, -1 };
+	}
+}
+
+// Function to manage power-up appearance
+void ReferenceGame::togglePowerupOn() {
+	if (!showPowerup && tick - powerupOffTime >= powerupTimeGap) {
+		powerupOffTime = tick;
+		showPowerup = true;
+		powerupOnTime = tick;
+		powerup = genRandPos();
+	}
+}
+
+// Function to declare the winner and end the match
+void ReferenceGame::declareWinner(int player) {
+	running = false;
+	winner = player;
+	events |= EVENT_GAME_OVER;
+}
+
+// Function to reset the match to the initial state (timers, growth flags and the power-up gap carry over)
+void ReferenceGame::reset() {
+	resetSnake(0, rules.start1, rules.dir1);
+	resetSnake(1, rules.start2, rules.dir2);
+	food = genRandPos();
+	powerup = Cell{ -1, -1 };
+	showPowerup = false;
+	score[0] = score[1] = 0;
+	running = true;
+	winner = NO_WINNER;
+}
+
+// Function to hash the full state from scratch
+uint64_t ReferenceGame::stateHash() const {
+	SnakeDigest digests[2];
+	for (int i = 0; i < 2; i++) {
+		uint64_t sum = 0;
+		for (const Cell& segment : body[i]) sum += segmentKey(i, segment);
+		digests[i] = SnakeDigest{ sum, body[i].front(), body[i].back(), (int)body[i].size(),
+			direction[i], addSegment[i], score[i] };
+	}
+	MatchDigest match = { food, powerup, showPowerup, running, winner, tick, powerupOnTime, powerupOffTime };
+	return hashState(digests, match);
+}
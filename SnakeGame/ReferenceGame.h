@@ -0,0 +1,50 @@
+#pragma once
+// Frozen reference implementation of the game rules.
+// This is a literal headless transcription of the original Game::update() (deque bodies, linear
+// scans, sequential snake-by-snake checks) and is the oracle the golden-master harness compares
+// the optimized Engine against. Do not optimize or "fix" it: its quirks are the rules.
+// The simultaneous resolution (Rules::simultaneous) is written out just as plainly.
+#include <deque>         // For the snake bodies
+#include "SimCore.h"
+
+class ReferenceGame {
+public:
+	Rules rules;                 // Rules of the match
+	SimRng rng;                  // Random generator standing in for GetRandomValue
+	std::deque<Cell> body[2];    // Body segments of both snakes, head first
+	Dir direction[2];            // Moving direction of both snakes
+	bool addSegment[2] = { false, false };  // Growth flags of both snakes
+	int score[2] = { 0, 0 };     // Scores of both snakes
+	Cell food;                   // Food position
+	Cell powerup;                // Power-up position
+	bool running = true;         // Flag to check if the match is running
+	bool showPowerup = false;    // Flag to display the power-up
+	int winner = NO_WINNER;      // Winner once the match is over
+	int64_t tick = 0;            // Ticks since construction (stands in for GetTime())
+	int64_t powerupOnTime = 0;   // Tick the power-up appeared
+	int64_t powerupOffTime = 0;  // Tick the power-up timer was last restarted
+	int powerupTimeGap;          // Ticks between power-up appearances
+
+	ReferenceGame(const Rules& rules, uint64_t seed);
+
+	bool setDirection(int snake, Dir d);  // Change direction unless it reverses the snake
+	uint32_t update();                    // Advance one tick, returning EVENT_* bits
+	void reset();                         // Restart the match like Game::reset()
+	uint64_t stateHash() const;           // Hash of the full state (see hashState)
+
+private:
+	uint32_t events = 0;  // Events raised during the current tick
+
+	void resetSnake(int snake, Cell startPos, Dir startDirection);
+	void moveSnake(int snake);
+	Cell genRandPos();
+	void checkFoodCollision(int snake);
+	void checkPowerupCollision(int snake);
+	void checkCollisions();
+	void resolveSimultaneous();
+	bool isOutOfBounds(int snake) const;
+	bool selfCollision(int snake) const;
+	void togglePowerupOff();
+	void togglePowerupOn();
+	void declareWinner(int player);
+};
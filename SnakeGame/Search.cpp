@@ -0,0 +1,158 @@
+#include "Search.h"
+#include <cstdlib>       // For abs
+using namespace std;
+
+static const int WIN = 1000000;  // Score of a won position, less the plies it takes to get there
+
+Dir MinimaxBot::chooseMove(const Engine& engine, int snake) {
+	auto start = chrono::steady_clock::now();
+	double limit = timeLimit > 0 ? timeLimit : engine.rules.tickSeconds * 0.5;
+	deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(limit));
+
+	// Fall back to the first safe move: used if even depth 1 runs out of time, and on boards too
+	// wide for a bitboard
+	const EngineSnake& self = engine.snakes[snake];
+	Dir best = self.direction;
+	for (int i = 0; i < 3; i++) {
+		Dir d = (Dir)((self.direction + 3 + i) & 3);  // Left turn, straight on, right turn
+		if (isSafeMove(engine, snake, d)) {
+			best = d;
+			if (d == self.direction) break;
+		}
+	}
+	if (engine.rules.cellCount > Bitboard::MAX_CELLS) return best;
+
+	free = freeCells(engine);
+	heads[0] = self.head();
+	heads[1] = engine.snakes[1 - snake].head();
+	directions[0] = self.direction;
+	directions[1] = engine.snakes[1 - snake].direction;
+	food = engine.food;
+	nodes = 0;
+	aborted = false;
+	previous.length = 0;
+	lastDepth = 0;
+	for (int depth = 1; depth <= MAX_DEPTH; depth++) {
+		int score = searchMine(depth, 0, -WIN - 1, WIN + 1, true);
+		if (aborted) break;
+		previous = lines[0];
+		if (previous.length > 0) best = previous.moves[0];
+		lastDepth = depth;
+		lastScore = score;
+		if (abs(score) >= WIN - MAX_DEPTH) break;  // Won or lost whatever happens
+		double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		if (elapsed * 3 > limit) break;  // The next iteration would most likely be cut off
+	}
+
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	stats.nodes += nodes;
+	stats.moves++;
+	stats.depthSum += lastDepth;
+	stats.seconds += seconds;
+	stats.longestMove = max(stats.longestMove, seconds);
+	return best;
+}
+
+// Function to list the moves of a snake that do not reverse it, the previous iteration's choice first
+// and moves into free cells before the rest
+int MinimaxBot::orderMoves(int snake, int half, bool onPrevious, Dir* moves) const {
+	int count = 0;
+	bool hasPrevious = onPrevious && half < previous.length;
+	if (hasPrevious) moves[count++] = previous.moves[half];
+	for (int pass = 0; pass < 2; pass++) {
+		for (int d = 0; d < 4; d++) {
+			if (d == oppositeDir(directions[snake]) || (hasPrevious && moves[0] == d)) continue;
+			Cell next = stepCell(heads[snake], (Dir)d);
+			bool open = next.x >= 0 && next.x < free.cellCount && next.y >= 0 && next.y < free.cellCount && free.test(next);
+			if (open == (pass == 0)) moves[count++] = (Dir)d;
+		}
+	}
+	return count;
+}
+
+// Function to record move as the best one at a half-ply, followed by the best line below it
+void MinimaxBot::setLine(int half, Dir move) {
+	Line& line = lines[half];
+	const Line& below = lines[half + 1];
+	line.moves[0] = move;
+	for (int i = 0; i < below.length; i++) line.moves[i + 1] = below.moves[i];
+	line.length = below.length + 1;
+}
+
+int MinimaxBot::searchMine(int depth, int ply, int alpha, int beta, bool onPrevious) {
+	if ((++nodes & 63) == 0 && chrono::steady_clock::now() >= deadline) aborted = true;
+	if (aborted) return 0;
+	int half = 2 * ply;
+	lines[half].length = 0;
+	if (depth == 0) return evaluate();
+
+	Dir moves[3];
+	int count = orderMoves(0, half, onPrevious, moves);
+	int best = -WIN - 1;
+	for (int i = 0; i < count; i++) {
+		bool follows = onPrevious && half < previous.length && moves[i] == previous.moves[half];
+		int value = searchTheirs(moves[i], depth, ply, alpha, beta, follows);
+		if (aborted) return 0;
+		if (value > best) {
+			best = value;
+			setLine(half, moves[i]);
+		}
+		alpha = max(alpha, value);
+		if (alpha >= beta) break;
+	}
+	return best;
+}
+
+int MinimaxBot::searchTheirs(Dir mine, int depth, int ply, int alpha, int beta, bool onPrevious) {
+	int half = 2 * ply + 1;
+	lines[half].length = 0;
+	int n = free.cellCount;
+	Cell myNext = stepCell(heads[0], mine);
+	bool myDead = myNext.x < 0 || myNext.x >= n || myNext.y < 0 || myNext.y >= n || !free.test(myNext);
+
+	Dir moves[3];
+	int count = orderMoves(1, half, onPrevious, moves);
+	int best = WIN + 1;
+	for (int i = 0; i < count; i++) {
+		Cell theirNext = stepCell(heads[1], moves[i]);
+		bool theirDead = theirNext.x < 0 || theirNext.x >= n || theirNext.y < 0 || theirNext.y >= n || !free.test(theirNext);
+		int value;
+		if (myNext == theirNext || (myDead && theirDead)) value = 0;  // Head-on or both crash: draw
+		else if (myDead) value = -WIN + ply;
+		else if (theirDead) value = WIN - ply;
+		else {
+			// Make both moves, search, then take them back
+			Cell oldHeads[2] = { heads[0], heads[1] };
+			Dir oldDirections[2] = { directions[0], directions[1] };
+			free.clear(myNext);
+			free.clear(theirNext);
+			heads[0] = myNext;
+			heads[1] = theirNext;
+			directions[0] = mine;
+			directions[1] = moves[i];
+			bool follows = onPrevious && half < previous.length && moves[i] == previous.moves[half];
+			value = searchMine(depth - 1, ply + 1, alpha, beta, follows);
+			free.set(myNext);
+			free.set(theirNext);
+			heads[0] = oldHeads[0];
+			heads[1] = oldHeads[1];
+			directions[0] = oldDirections[0];
+			directions[1] = oldDirections[1];
+			if (aborted) return 0;
+		}
+		if (value < best) {
+			best = value;
+			setLine(half, moves[i]);
+		}
+		beta = min(beta, value);
+		if (alpha >= beta) break;
+	}
+	return best;
+}
+
+// Function to score a leaf from the bot's point of view: territory first, then closeness to the food
+int MinimaxBot::evaluate() {
+	territory.compute(free, heads, 2);
+	int score = 8 * (territory.cells[0] - territory.cells[1]);
+	return score - abs(heads[0].x - food.x) - abs(heads[0].y - food.y);
+}
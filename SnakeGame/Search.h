@@ -0,0 +1,61 @@
+#pragma once
+// Minimax bot with time control.
+// The search sees the board as the bitboard of free cells (bodies, tails included, stay solid) and
+// both heads. A ply is one simultaneous move of both snakes, searched paranoid-style: the bot picks a
+// move, then the opponent answers knowing it, with alpha-beta pruning over both. Moving off the board
+// or into a body loses, and a head-on crash or both snakes dying is a draw. Leaves are scored by
+// Voronoi territory (see Territory in Bitboard.h).
+//
+// Iterative deepening searches depth 1, 2, ... until the per-move time limit runs out; an unfinished
+// iteration is thrown away, and each iteration tries the previous iteration's principal variation
+// first. The clock is checked every 64 nodes, so a move overruns its limit by well under a millisecond.
+#include <chrono>        // For the search deadline
+#include "Bitboard.h"
+#include "Bot.h"
+
+// Search totals, summed over every move a bot has made
+struct SearchStats {
+	uint64_t nodes = 0;       // Positions visited
+	uint64_t moves = 0;       // Moves chosen
+	uint64_t depthSum = 0;    // Sum of the depth reached on each move
+	double seconds = 0;       // Time spent searching
+	double longestMove = 0;   // Longest single move in seconds
+};
+
+class MinimaxBot : public Bot {
+public:
+	static const int MAX_DEPTH = 64;  // Deepest iteration
+
+	double timeLimit;    // Seconds per move; 0 means half of the engine's Rules::tickSeconds
+	SearchStats stats;   // Totals over all moves so far
+	int lastDepth = 0;   // Depth of the last finished iteration of the last move
+	int lastScore = 0;   // Its score, from the bot's point of view
+
+	explicit MinimaxBot(double seconds = 0) : timeLimit(seconds) {}
+
+	Dir chooseMove(const Engine& engine, int snake) override;
+
+private:
+	// Moves of the best line found below a half-ply (the bot's move or the opponent's answer)
+	struct Line {
+		int length = 0;
+		Dir moves[2 * MAX_DEPTH];
+	};
+
+	Bitboard free;                     // Free cells of the position being searched
+	Cell heads[2];                     // Heads, the bot's snake first
+	Dir directions[2];                 // Their directions
+	Cell food;                         // Food position, for the leaf score
+	Territory territory;               // Scratch for the leaf score
+	Line lines[2 * MAX_DEPTH + 2];     // Best line below each half-ply of the current iteration
+	Line previous;                     // Principal variation of the last finished iteration
+	uint64_t nodes = 0;                // Nodes of the current move
+	bool aborted = false;              // Set when the deadline passes
+	std::chrono::steady_clock::time_point deadline;
+
+	int searchMine(int depth, int ply, int alpha, int beta, bool onPrevious);
+	int searchTheirs(Dir mine, int depth, int ply, int alpha, int beta, bool onPrevious);
+	int evaluate();
+	int orderMoves(int snake, int half, bool onPrevious, Dir* moves) const;
+	void setLine(int half, Dir move);
+};
@@ -0,0 +1,329 @@
+#include "SelfPlay.h"
+#include <algorithm>     // For min
+#include <chrono>        // For stall times
+#include <cstdio>        // For shard files
+#include <cstring>       // For memcpy and memcmp
+#include <memory>        // For the bots
+using namespace std;
+
+static const char SHARD_MAGIC[8] = { 'S', 'N', 'A', 'K', 'E', 'S', 'H', 'D' };
+static const uint32_t SHARD_VERSION = 1;
+
+// Function to append an unsigned LEB128 varint
+static void putVarint(vector<uint8_t>& out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((uint8_t)value);
+}
+
+void SelfPlayRecorder::begin(int board) {
+	cellCount = board;
+	count = 0;
+	frames.clear();
+	for (Bitboard& plane : previous) plane = Bitboard(board);
+}
+
+void SelfPlayRecorder::record(const Engine& engine, int snake, Dir move) {
+	if (snake == 1) {
+		// Snake 1 finishes the position the snake 0 call started
+		uint8_t moves = (uint8_t)(engine.snakes[0].direction | engine.snakes[1].direction << 2 | firstMove << 4 | move << 6);
+		frames.push_back(moves);
+		count++;
+		return;
+	}
+	firstMove = move;
+	int n = cellCount;
+	for (Bitboard& plane : current) plane = Bitboard(n);
+	for (int s = 0; s < 2; s++) {
+		const EngineSnake& body = engine.snakes[s];
+		for (int i = 0; i < body.length; i++) {
+			Cell c = body.segment(i);
+			if (engine.inBounds(c)) current[PLANE_BODY1 + s].set(c);
+		}
+		if (engine.inBounds(body.head())) current[PLANE_HEAD1 + s].set(body.head());
+	}
+	if (engine.inBounds(engine.food)) current[PLANE_FOOD].set(engine.food);
+	if (engine.showPowerup && engine.inBounds(engine.powerup)) current[PLANE_POWERUP].set(engine.powerup);
+
+	// Changed bits: the count, then the gaps between their indexes
+	int changed = 0;
+	for (int p = 0; p < PLANE_COUNT; p++) {
+		for (int y = 1; y <= n; y++) changed += bitCount(current[p].rows[y] ^ previous[p].rows[y]);
+	}
+	putVarint(frames, (uint64_t)changed);
+	int64_t last = -1;
+	for (int p = 0; p < PLANE_COUNT; p++) {
+		for (int y = 0; y < n; y++) {
+			uint64_t word = current[p].rows[y + 1] ^ previous[p].rows[y + 1];
+			while (word) {
+				int64_t index = ((int64_t)p * n + y) * n + lowestBit(word);
+				putVarint(frames, (uint64_t)(index - last - 1));
+				last = index;
+				word &= word - 1;
+			}
+		}
+		previous[p] = current[p];
+	}
+}
+
+void SelfPlayRecorder::finish(uint64_t seed, int winner, vector<uint8_t>& out) const {
+	out.clear();
+	putVarint(out, count);
+	out.push_back((uint8_t)winner);
+	for (int i = 0; i < 8; i++) out.push_back((uint8_t)(seed >> (8 * i)));
+	out.insert(out.end(), frames.begin(), frames.end());
+}
+
+ShardWriter::ShardWriter(const string& path, int cells, uint32_t bytes)
+	: prefix(path), board(cells), shardBytes(bytes) {
+	for (Buffer& buffer : buffers) buffer.bytes.reserve(shardBytes - sizeof(ShardHeader));
+	writer = thread(&ShardWriter::writerLoop, this);
+}
+
+ShardWriter::~ShardWriter() {
+	finish();
+}
+
+bool ShardWriter::add(const vector<uint8_t>& match, uint32_t positions) {
+	size_t capacity = shardBytes - sizeof(ShardHeader);
+	unique_lock<std::mutex> guard(mutex);
+	if (match.size() > capacity) {
+		totals.dropped++;
+		return false;
+	}
+	if (filling->bytes.size() + match.size() > capacity) handOver(guard);
+	filling->bytes.insert(filling->bytes.end(), match.begin(), match.end());
+	filling->matches++;
+	filling->positions += positions;
+	totals.matches++;
+	totals.positions += positions;
+	totals.payloadBytes += match.size();
+	return true;
+}
+
+void ShardWriter::handOver(unique_lock<std::mutex>& guard) {
+	if (writing) {
+		// The writer is still on the other buffer: the disk is a whole shard behind
+		auto start = chrono::steady_clock::now();
+		drained.wait(guard, [&] { return writing == nullptr; });
+		totals.stalls++;
+		totals.stallSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+	writing = filling;
+	filling = filling == &buffers[0] ? &buffers[1] : &buffers[0];
+	wake.notify_one();
+}
+
+bool ShardWriter::finish() {
+	{
+		unique_lock<std::mutex> guard(mutex);
+		if (stopping) return !failed;
+		if (filling->matches > 0) handOver(guard);
+		stopping = true;
+	}
+	wake.notify_one();
+	writer.join();
+	return !failed;
+}
+
+ShardWriterStats ShardWriter::stats() const {
+	lock_guard<std::mutex> guard(mutex);
+	return totals;
+}
+
+void ShardWriter::writerLoop() {
+	uint32_t index = 0;
+	unique_lock<std::mutex> guard(mutex);
+	while (true) {
+		wake.wait(guard, [&] { return writing != nullptr || stopping; });
+		if (!writing) return;  // Stopping with nothing left to write
+		Buffer* buffer = writing;
+		guard.unlock();
+		bool written = writeShard(*buffer, index++);
+		buffer->bytes.clear();
+		buffer->matches = 0;
+		buffer->positions = 0;
+		guard.lock();
+		if (written) totals.shards++;
+		failed = failed || !written;
+		writing = nullptr;
+		drained.notify_all();
+	}
+}
+
+bool ShardWriter::writeShard(const Buffer& buffer, uint32_t index) {
+	ShardHeader header = {};
+	memcpy(header.magic, SHARD_MAGIC, sizeof(header.magic));
+	header.version = SHARD_VERSION;
+	header.board = (uint32_t)board;
+	header.shardBytes = shardBytes;
+	header.index = index;
+	header.matches = buffer.matches;
+	header.payloadBytes = (uint32_t)buffer.bytes.size();
+	header.positions = buffer.positions;
+
+	char name[32];
+	snprintf(name, sizeof(name), "-%05u.shard", index);
+	string path = prefix + name;
+	string temporary = path + ".tmp";  // Readers never see a partial shard
+	FILE* f = fopen(temporary.c_str(), "wb");
+	if (!f) return false;
+	vector<uint8_t> padding(shardBytes - sizeof(ShardHeader) - buffer.bytes.size(), 0);
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+		&& fwrite(buffer.bytes.data(), 1, buffer.bytes.size(), f) == buffer.bytes.size()
+		&& fwrite(padding.data(), 1, padding.size(), f) == padding.size();
+	ok = fclose(f) == 0 && ok;
+	if (!ok) {
+		remove(temporary.c_str());
+		return false;
+	}
+	if (rename(temporary.c_str(), path.c_str()) != 0) {
+		remove(path.c_str());  // Windows will not rename over an existing file
+		if (rename(temporary.c_str(), path.c_str()) != 0) return false;
+	}
+	return true;
+}
+
+bool ShardReader::open(const string& path, string& error) {
+	FILE* f = fopen(path.c_str(), "rb");
+	if (!f) {
+		error = "cannot open '" + path + "'";
+		return false;
+	}
+	bool ok = fread(&head, sizeof(head), 1, f) == 1 && memcmp(head.magic, SHARD_MAGIC, sizeof(head.magic)) == 0
+		&& head.version == SHARD_VERSION && head.board >= 1 && head.board <= (uint32_t)Bitboard::MAX_CELLS
+		&& head.payloadBytes <= head.shardBytes - sizeof(ShardHeader);
+	if (ok) {
+		bytes.resize(head.payloadBytes);
+		ok = fread(bytes.data(), 1, bytes.size(), f) == bytes.size();
+	}
+	fclose(f);
+	if (!ok) {
+		error = "'" + path + "' is not a valid shard";
+		return false;
+	}
+	offset = 0;
+	remaining = 0;
+	problem.clear();
+	return true;
+}
+
+bool ShardReader::readVarint(uint64_t& value) {
+	value = 0;
+	for (int shift = 0; shift < 64 && offset < bytes.size(); shift += 7) {
+		uint8_t b = bytes[offset++];
+		value |= (uint64_t)(b & 0x7f) << shift;
+		if (!(b & 0x80)) return true;
+	}
+	problem = "truncated varint";
+	return false;
+}
+
+bool ShardReader::nextMatch(uint64_t& seed, int& winner, uint32_t& positions) {
+	while (remaining > 0) {  // Skip what is left of the current match
+		SelfPlayPosition skipped;
+		if (!nextPosition(skipped)) return false;
+	}
+	if (offset >= bytes.size()) return false;
+	uint64_t count;
+	if (!readVarint(count) || count > 0xffffffffULL || bytes.size() - offset < 9) {
+		if (problem.empty()) problem = "truncated match header";
+		return false;
+	}
+	winner = bytes[offset++];
+	seed = 0;
+	for (int i = 0; i < 8; i++) seed |= (uint64_t)bytes[offset++] << (8 * i);
+	positions = remaining = (uint32_t)count;
+	tick = 0;
+	for (int s = 0; s < 2; s++) outcome[s] = winner == s + 1 ? 1 : winner == 2 - s ? -1 : 0;
+	for (Bitboard& plane : planes) plane = Bitboard((int)head.board);
+	return true;
+}
+
+bool ShardReader::nextPosition(SelfPlayPosition& position) {
+	if (remaining == 0) return false;
+	int n = (int)head.board;
+	uint64_t changed;
+	if (!readVarint(changed)) return false;
+	int64_t index = -1;
+	for (uint64_t i = 0; i < changed; i++) {
+		uint64_t gap;
+		if (!readVarint(gap)) return false;
+		index += (int64_t)gap + 1;
+		if (gap >= (uint64_t)PLANE_COUNT * n * n || index >= (int64_t)PLANE_COUNT * n * n) {
+			problem = "bit index outside the planes";
+			return false;
+		}
+		int p = (int)(index / (n * n)), cell = (int)(index % (n * n));
+		planes[p].rows[cell / n + 1] ^= 1ULL << (cell % n);
+	}
+	if (offset >= bytes.size()) {
+		problem = "truncated position";
+		return false;
+	}
+	uint8_t moves = bytes[offset++];
+	position.tick = tick++;
+	for (int p = 0; p < PLANE_COUNT; p++) position.planes[p] = planes[p];
+	for (int s = 0; s < 2; s++) {
+		position.direction[s] = (Dir)(moves >> (2 * s) & 3);
+		position.move[s] = (Dir)(moves >> (4 + 2 * s) & 3);
+		position.outcome[s] = outcome[s];
+	}
+	remaining--;
+	return true;
+}
+
+// Bot that passes its inner bot's moves through and records them
+class RecordingBot : public Bot {
+public:
+	RecordingBot(Bot& played, SelfPlayRecorder& into) : inner(played), recorder(into) {}
+
+	Dir chooseMove(const Engine& engine, int snake) override {
+		Dir move = inner.chooseMove(engine, snake);
+		recorder.record(engine, snake, move);
+		return move;
+	}
+
+private:
+	Bot& inner;
+	SelfPlayRecorder& recorder;
+};
+
+bool runSelfPlay(const SelfPlayOptions& options, ThreadPool& pool, ShardWriterStats& stats, string& error) {
+	int board = options.rules.cellCount;
+	if (board > Bitboard::MAX_CELLS) {
+		error = "boards wider than " + to_string(Bitboard::MAX_CELLS) + " cells are not supported";
+		return false;
+	}
+	if (!createBot(options.bot, 0)) {
+		error = "unknown bot '" + options.bot + "'";
+		return false;
+	}
+	ShardWriter writer(options.prefix, board, options.shardBytes);
+	vector<Engine> engines(pool.size(), Engine(options.rules, 0));  // One pooled engine per worker
+	vector<SelfPlayRecorder> recorders(pool.size());
+	vector<vector<uint8_t>> encoded(pool.size());
+	int count = (int)min<uint64_t>(options.matches, 0x7fffffff);
+
+	pool.parallelFor(count, [&](int begin, int end, int worker) {
+		Engine& engine = engines[worker];
+		SelfPlayRecorder& recorder = recorders[worker];
+		for (int i = begin; i < end; i++) {
+			uint64_t seed = mix64(options.seed ^ mix64((uint64_t)i));
+			unique_ptr<Bot> bot1 = createBot(options.bot, seed ^ 1);
+			unique_ptr<Bot> bot2 = createBot(options.bot, seed ^ 2);
+			RecordingBot recorded1(*bot1, recorder), recorded2(*bot2, recorder);
+			recorder.begin(board);
+			MatchResult r = playMatch(engine, options.rules, recorded1, recorded2, seed, options.limits);
+			recorder.finish(seed, r.winner, encoded[worker]);
+			writer.add(encoded[worker], recorder.positions());  // Counted as dropped if it is too large
+		}
+	});
+
+	bool written = writer.finish();
+	stats = writer.stats();
+	if (!written) error = "cannot write shards to '" + options.prefix + "-*.shard'";
+	return written;
+}
@@ -0,0 +1,174 @@
+#pragma once
+// Self-play training data: matches of a bot against itself, recorded into fixed-size binary shards.
+// Every tick of a match is one position, and each position gives two samples (observation, action,
+// outcome), one per snake.
+//
+// A position is six bit-packed planes over the board (both bodies, both heads, the food and the
+// visible power-up), both directions and both moves. Matches are stored whole, so every shard decodes
+// on its own. Consecutive positions of a match differ in a few cells, so each one is delta coded
+// against the one before: the count of changed plane bits, then the gaps between their indexes, all as
+// LEB128 varints, followed by one byte with the directions and moves. The first position is coded
+// against empty planes. A position then takes about 15 bytes on a 25 x 25 board, against 470 for the
+// bit-packed planes or 3750 with a byte per cell.
+//
+// Shard layout (little-endian): a 64-byte ShardHeader, the matches back to back, and zero padding up
+// to the shard size. A match is varint positions, one byte winner (NO_WINNER, 1, 2 or DRAW), the
+// 8-byte engine seed and then its positions. Bit index of cell (x, y) in plane p: (p * n + y) * n + x.
+// Direction byte: direction1 | direction2 << 2 | move1 << 4 | move2 << 6.
+//
+// Workers encode their own matches and hand them to a ShardWriter, which only copies them into the
+// shard being filled. A full shard is swapped with the spare buffer and written by the writer's own
+// thread while workers fill the other, so they only wait when the disk is a whole shard behind.
+#include <condition_variable>  // For handing shards to the writer thread
+#include <cstdint>             // For fixed-width integer types
+#include <mutex>               // For the shard buffers
+#include <string>              // For paths
+#include <thread>              // For the writer thread
+#include <vector>              // For the buffers
+#include "Bitboard.h"
+#include "Match.h"
+#include "ThreadPool.h"
+
+// Planes of a position
+enum SelfPlayPlane { PLANE_BODY1, PLANE_BODY2, PLANE_HEAD1, PLANE_HEAD2, PLANE_FOOD, PLANE_POWERUP, PLANE_COUNT };
+
+struct ShardHeader {
+	char magic[8];           // "SNAKESHD"
+	uint32_t version;
+	uint32_t board;          // Board side (at most Bitboard::MAX_CELLS)
+	uint32_t shardBytes;     // Size of the file, header and padding included
+	uint32_t index;          // Shard number within the run
+	uint32_t matches;
+	uint32_t payloadBytes;   // Bytes of matches after the header
+	uint64_t positions;      // Positions in all the matches (two samples each)
+	uint8_t reserved[24];
+};
+
+// One decoded position of a match
+struct SelfPlayPosition {
+	int tick = 0;
+	Bitboard planes[PLANE_COUNT];
+	Dir direction[2] = { DIR_RIGHT, DIR_RIGHT };  // Before the move
+	Dir move[2] = { DIR_RIGHT, DIR_RIGHT };       // What each bot played
+	int outcome[2] = { 0, 0 };                    // 1 won, -1 lost, 0 drawn or unfinished
+};
+
+// Function to delta-code the positions of one match (see the top of this file); keep one per worker,
+// its buffers are reused
+class SelfPlayRecorder {
+public:
+	// Function to start a new match on a board
+	void begin(int board);
+
+	// Function to record the move of `snake` in the current position; snake 0 is asked first
+	void record(const Engine& engine, int snake, Dir move);
+
+	// Function to write the whole match (header and positions) to out
+	void finish(uint64_t seed, int winner, std::vector<uint8_t>& out) const;
+
+	uint32_t positions() const { return count; }
+
+private:
+	int cellCount = 0;
+	uint32_t count = 0;
+	std::vector<uint8_t> frames;           // Positions so far
+	Bitboard previous[PLANE_COUNT];        // Planes of the last position
+	Bitboard current[PLANE_COUNT];
+	Dir firstMove = DIR_RIGHT;             // Move of snake 0 in the current position
+};
+
+// Totals of a ShardWriter
+struct ShardWriterStats {
+	uint64_t shards = 0;
+	uint64_t matches = 0;
+	uint64_t positions = 0;
+	uint64_t payloadBytes = 0;  // Match bytes, without headers and padding
+	uint64_t dropped = 0;       // Matches too large for an empty shard
+	uint64_t stalls = 0;        // Times a worker waited for the writer
+	double stallSeconds = 0;    // Time workers spent waiting
+};
+
+class ShardWriter {
+public:
+	// Constructor: starts the writer thread; shards are PREFIX-00000.shard, PREFIX-00001.shard, ...
+	ShardWriter(const std::string& prefix, int board, uint32_t shardBytes);
+	~ShardWriter();
+
+	ShardWriter(const ShardWriter&) = delete;
+	ShardWriter& operator=(const ShardWriter&) = delete;
+
+	// Function to add one encoded match from any thread; false if it does not fit in an empty shard
+	bool add(const std::vector<uint8_t>& match, uint32_t positions);
+
+	// Function to write the last shard and stop the writer thread; false if any shard failed to write
+	bool finish();
+
+	ShardWriterStats stats() const;
+
+private:
+	struct Buffer {
+		std::vector<uint8_t> bytes;  // Matches so far
+		uint32_t matches = 0;
+		uint64_t positions = 0;
+	};
+
+	std::string prefix;
+	int board;
+	uint32_t shardBytes;
+	mutable std::mutex mutex;              // Guards everything below
+	std::condition_variable wake;          // Signals the writer that a shard is ready or to stop
+	std::condition_variable drained;       // Signals workers that the spare buffer is free again
+	Buffer buffers[2];                     // Double buffer: one filling, one being written
+	Buffer* filling = &buffers[0];
+	Buffer* writing = nullptr;             // Handed to the writer thread, nullptr when it is idle
+	bool stopping = false;
+	bool failed = false;
+	ShardWriterStats totals;
+	std::thread writer;
+
+	void handOver(std::unique_lock<std::mutex>& guard);  // Give the filling buffer to the writer
+	void writerLoop();
+	bool writeShard(const Buffer& buffer, uint32_t index);
+};
+
+// Reader of one shard: open it, then step through its matches and their positions
+class ShardReader {
+public:
+	bool open(const std::string& path, std::string& error);  // Read and check a whole shard file
+
+	const ShardHeader& header() const { return head; }
+
+	// Function to start the next match; false after the last one (or if the shard is damaged, see error)
+	bool nextMatch(uint64_t& seed, int& winner, uint32_t& positions);
+
+	// Function to decode the next position of the current match; false after its last one
+	bool nextPosition(SelfPlayPosition& position);
+
+	const std::string& error() const { return problem; }
+
+private:
+	ShardHeader head = {};
+	std::vector<uint8_t> bytes;
+	size_t offset = 0;         // Next byte of the payload
+	uint32_t remaining = 0;    // Positions left in the current match
+	int tick = 0;
+	int outcome[2] = { 0, 0 };
+	Bitboard planes[PLANE_COUNT];
+	std::string problem;
+
+	bool readVarint(uint64_t& value);
+};
+
+struct SelfPlayOptions {
+	std::string bot = "roomy";      // Bot on both snakes
+	uint64_t matches = 1000;
+	uint64_t seed = 1;
+	uint32_t shardBytes = 1 << 20;  // Size of each shard file
+	std::string prefix = "selfplay";
+	Rules rules;
+	MatchLimits limits;
+};
+
+// Function to play the matches on the pool and write them to shards; false with a message in error if
+// the board is too wide, the bot is unknown or a shard cannot be written
+bool runSelfPlay(const SelfPlayOptions& options, ThreadPool& pool, ShardWriterStats& stats, std::string& error);
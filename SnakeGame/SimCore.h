@@ -0,0 +1,199 @@
+#pragma once
+// Headless simulation core shared by the game, the reference rules and the batch tools.
+// Nothing in here depends on raylib, so it can run without a window or an audio device.
+#include <cstdint>       // For fixed-width integer types
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>      // For _BitScanForward64 and __popcnt64
+#endif
+
+// Grid cell used by the headless engines (integer twin of the Vector2 positions in the game)
+struct Cell {
+	int x;
+	int y;
+};
+
+inline bool operator==(Cell a, Cell b) { return a.x == b.x && a.y == b.y; }
+inline bool operator!=(Cell a, Cell b) { return !(a == b); }
+
+// Moving directions, numbered clockwise so that (d + 2) & 3 is the opposite direction
+enum Dir : uint8_t { DIR_UP = 0, DIR_RIGHT = 1, DIR_DOWN = 2, DIR_LEFT = 3 };
+
+// Function to get the cell offset of one step in a direction
+inline Cell dirDelta(Dir d) {
+	static const Cell deltas[4] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+	return deltas[d];
+}
+
+// Function to get the direction opposite to d
+inline Dir oppositeDir(Dir d) { return (Dir)((d + 2) & 3); }
+
+// Function to step a cell one move in a direction
+inline Cell stepCell(Cell c, Dir d) {
+	Cell delta = dirDelta(d);
+	return Cell{ c.x + delta.x, c.y + delta.y };
+}
+
+// Winner codes reported by the engines (1 and 2 match the player numbers in the game)
+const int NO_WINNER = 0;
+const int DRAW = 3;  // Every snake died in the same tick
+
+// Why a snake's head stopped (recorded for each snake when a match ends). DEATH_SEALED is never set by
+// the engines: playMatch() gives it to the loser of an adjudicated match, which has not crashed yet.
+enum DeathCause : uint8_t { DEATH_NONE = 0, DEATH_WALL = 1, DEATH_SELF = 2, DEATH_OPPONENT = 3, DEATH_HEAD_ON = 4, DEATH_SEALED = 5 };
+
+// Function to get a short name for a death cause ("-" for none or unknown values)
+inline const char* deathCauseName(int cause) {
+	static const char* names[] = { "-", "wall", "self", "opponent", "head-on", "sealed" };
+	return cause > DEATH_NONE && cause <= DEATH_SEALED ? names[cause] : names[0];
+}
+
+// Event bits returned by a tick so front ends can play sounds or collect statistics
+const uint32_t EVENT_FOOD1 = 1u << 0;      // First snake ate food
+const uint32_t EVENT_FOOD2 = 1u << 1;      // Second snake ate food
+const uint32_t EVENT_POWERUP1 = 1u << 2;   // First snake ate the power-up
+const uint32_t EVENT_POWERUP2 = 1u << 3;   // Second snake ate the power-up
+const uint32_t EVENT_GAME_OVER = 1u << 4;  // A winner was declared this tick
+
+// Rules of a match; the defaults reproduce the original game at one tick every 0.2 s
+struct Rules {
+	int cellCount = 25;            // Number of cells in one row or column
+	Cell start1 = { 6, 9 };        // Head position of the first snake
+	Cell start2 = { 18, 9 };       // Head position of the second snake
+	Dir dir1 = DIR_RIGHT;          // Initial direction of the first snake
+	Dir dir2 = DIR_LEFT;           // Initial direction of the second snake
+	int foodScore = 1;             // Points for eating food
+	int powerupScore = 5;          // Points for eating the power-up
+	int powerupLifetime = 50;      // Ticks a power-up stays visible (10 s)
+	int powerupGapMin = 75;        // Minimum ticks between power-up appearances (15 s)
+	int powerupGapMax = 80;        // Maximum ticks between power-up appearances (16 s)
+	bool simultaneous = false;     // Resolve ticks simultaneously instead of snake by snake (see Engine::update)
+	double tickSeconds = 0.2;      // Wall-clock length of one tick (front ends only; the engine counts ticks)
+	int stepsPerTick = 1;          // Scheduler sub-steps per tick; a snake at base speed moves once per tick
+	int speedupLength = 0;         // Every this many segments of growth takes one sub-step off the move period (0 = off)
+	int minPeriod = 1;             // Fastest move period, in sub-steps, reachable through length speedup
+	int boostPeriod = 0;           // Move period, in sub-steps, after eating a power-up (0 = no speed boost)
+	int boostTicks = 0;            // Ticks a power-up speed boost lasts
+
+	// Function to build default rules scaled to another board size (start cells keep their proportions)
+	static Rules forBoard(int cellCount) {
+		Rules rules;
+		rules.cellCount = cellCount;
+		rules.start1 = Cell{ cellCount * 6 / 25, cellCount * 9 / 25 };
+		rules.start2 = Cell{ cellCount - 1 - rules.start1.x, rules.start1.y };
+		return rules;
+	}
+};
+
+// Function to get the index of the lowest set bit of a non-zero word
+inline int lowestBit(uint64_t x) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, x);
+	return (int)index;
+#elif defined(__GNUC__)
+	return __builtin_ctzll(x);
+#else
+	int index = 0;
+	while (!(x & 1)) { x >>= 1; index++; }
+	return index;
+#endif
+}
+
+// Function to count the set bits of a word
+inline int bitCount(uint64_t x) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	return (int)__popcnt64(x);
+#elif defined(__GNUC__)
+	return __builtin_popcountll(x);
+#else
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Function to scramble a 64-bit value (splitmix64 finalizer)
+inline uint64_t mix64(uint64_t z) {
+	z += 0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+// Deterministic random generator used in place of raylib's GetRandomValue
+class SimRng {
+public:
+	uint64_t state;  // Current generator state
+
+	explicit SimRng(uint64_t seed = 0) : state(seed) {}
+
+	// Function to get the next raw 64-bit value
+	uint64_t next() {
+		state += 0x9e3779b97f4a7c15ULL;
+		uint64_t z = state;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+
+	// Function to get a value in [min, max], inclusive like GetRandomValue
+	int randomValue(int min, int max) {
+		uint64_t span = (uint64_t)(max - min) + 1;
+		return min + (int)(next() % span);
+	}
+};
+
+// Function to get the hash key of one body segment; bodies hash as the sum of their segment keys
+inline uint64_t segmentKey(int snake, Cell c) {
+	return mix64(((uint64_t)snake << 40) ^ ((uint64_t)(uint16_t)c.x << 20) ^ (uint64_t)(uint16_t)c.y);
+}
+
+// Everything about one snake that goes into the per-tick state hash
+struct SnakeDigest {
+	uint64_t bodySum;  // Sum of segmentKey over all segments
+	Cell head;         // First segment
+	Cell tail;         // Last segment
+	int length;        // Number of segments
+	Dir direction;     // Current moving direction
+	bool addSegment;   // Growth pending for the next move
+	int score;         // Current score
+};
+
+// Everything about the match outside the snakes that goes into the per-tick state hash
+struct MatchDigest {
+	Cell food;              // Food position
+	Cell powerup;           // Power-up position ({ -1, -1 } when taken or expired)
+	bool showPowerup;       // Whether the power-up is visible
+	bool running;           // Whether the match is still running
+	int winner;             // Winner code
+	int64_t tick;           // Ticks since the engine was created
+	int64_t powerupOnTick;  // Tick the power-up last appeared or expired
+	int64_t powerupOffTick; // Tick the power-up last appeared
+};
+
+// Function to fold one word into a running hash (one multiply; hashState finishes with a full mix64)
+inline uint64_t foldHash(uint64_t h, uint64_t v) {
+	h = (h ^ v) * 0x9e3779b97f4a7c15ULL;
+	return h ^ (h >> 32);
+}
+
+// Function to pack a cell into 32 bits
+inline uint64_t packCell(Cell c) { return (uint64_t)(uint16_t)c.x << 16 | (uint16_t)c.y; }
+
+// Function to hash a full match state; both engines must produce identical values for identical states
+inline uint64_t hashState(const SnakeDigest snakes[2], const MatchDigest& match) {
+	uint64_t h = 0x6a09e667f3bcc908ULL;
+	for (int i = 0; i < 2; i++) {
+		const SnakeDigest& s = snakes[i];
+		h = foldHash(h, s.bodySum);
+		h = foldHash(h, packCell(s.head) << 32 | packCell(s.tail));
+		h = foldHash(h, (uint64_t)(uint32_t)s.score << 32 | (uint64_t)s.length << 3 | (uint64_t)s.direction << 1 | (uint64_t)s.addSegment);
+	}
+	h = foldHash(h, packCell(match.food) << 32 | packCell(match.powerup));
+	h = foldHash(h, (uint64_t)match.showPowerup | (uint64_t)match.running << 1 | (uint64_t)(uint8_t)match.winner << 2);
+	h = foldHash(h, (uint64_t)match.tick);
+	h = foldHash(h, (uint64_t)match.powerupOnTick);
+	h = foldHash(h, (uint64_t)match.powerupOffTick);
+	return mix64(h);
+}
@@ -0,0 +1,98 @@
+#include "SnakeCodec.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>   // For the SSE2 decoder
+#define SNAKE_CODEC_SSE2 1
+#endif
+using namespace std;
+
+void decodeCells(const PackedSnake& packed, Cell* out) {
+	if (packed.length == 0) return;
+	out[0] = packed.head;
+	for (int i = 1; i < packed.length; i++) {
+		out[i] = stepCell(out[i - 1], packed.step(i - 1));
+	}
+}
+
+#ifdef SNAKE_CODEC_SSE2
+// Prefix (dx, dy) pairs for every byte of four codes, as int16 pairs ready for _mm_madd_epi16
+struct PrefixTable {
+	alignas(16) int16_t steps[256][8];
+
+	PrefixTable() {
+		for (int byte = 0; byte < 256; byte++) {
+			int x = 0, y = 0;
+			for (int k = 0; k < 4; k++) {
+				Cell delta = dirDelta((Dir)((byte >> (2 * k)) & 3));
+				x += delta.x;
+				y += delta.y;
+				steps[byte][2 * k] = (int16_t)x;
+				steps[byte][2 * k + 1] = (int16_t)y;
+			}
+		}
+	}
+};
+#endif
+
+void decodeCellIndices(const PackedSnake& packed, int cellCount, int32_t* out) {
+	if (packed.length == 0) return;
+	int32_t index = packed.head.y * cellCount + packed.head.x;
+	out[0] = index;
+	int steps = packed.length - 1;
+	int i = 0;
+#ifdef SNAKE_CODEC_SSE2
+	// Four segments per byte: look up their prefix (dx, dy), fold to index offsets with one
+	// multiply-add against (1, cellCount), then add the index carried from the previous byte
+	static const PrefixTable table;
+	const __m128i strides = _mm_set1_epi32((int)((uint32_t)(uint16_t)cellCount << 16 | 1u));
+	__m128i running = _mm_set1_epi32(index);
+	for (; i + 4 <= steps; i += 4) {
+		uint32_t byte = (uint32_t)(packed.words[i >> 5] >> ((i & 31) * 2)) & 0xff;
+		__m128i prefix = _mm_load_si128((const __m128i*)table.steps[byte]);
+		__m128i indices = _mm_add_epi32(running, _mm_madd_epi16(prefix, strides));
+		_mm_storeu_si128((__m128i*)(out + 1 + i), indices);
+		running = _mm_shuffle_epi32(indices, _MM_SHUFFLE(3, 3, 3, 3));  // Carry the last index
+	}
+	index = _mm_cvtsi128_si32(running);
+#endif
+	static const int dx[4] = { 0, 1, 0, -1 };
+	static const int dy[4] = { -1, 0, 1, 0 };
+	for (; i < steps; i++) {
+		Dir d = packed.step(i);
+		index += dy[d] * cellCount + dx[d];
+		out[1 + i] = index;
+	}
+}
+
+size_t writePackedSnake(const PackedSnake& packed, vector<uint8_t>& out) {
+	size_t start = out.size();
+	uint16_t x = (uint16_t)(int16_t)packed.head.x;
+	uint16_t y = (uint16_t)(int16_t)packed.head.y;
+	uint32_t length = (uint32_t)packed.length;
+	out.push_back((uint8_t)x);
+	out.push_back((uint8_t)(x >> 8));
+	out.push_back((uint8_t)y);
+	out.push_back((uint8_t)(y >> 8));
+	for (int b = 0; b < 4; b++) out.push_back((uint8_t)(length >> (8 * b)));
+	size_t codeBytes = packed.length > 1 ? ((size_t)packed.length - 1 + 3) / 4 : 0;
+	for (size_t b = 0; b < codeBytes; b++) {
+		out.push_back((uint8_t)(packed.words[b >> 3] >> ((b & 7) * 8)));
+	}
+	return out.size() - start;
+}
+
+bool readPackedSnake(const uint8_t* data, size_t size, size_t& offset, PackedSnake& packed) {
+	if (offset > size || size - offset < 8) return false;
+	const uint8_t* p = data + offset;
+	packed.head.x = (int16_t)(p[0] | p[1] << 8);
+	packed.head.y = (int16_t)(p[2] | p[3] << 8);
+	uint32_t length = (uint32_t)p[4] | (uint32_t)p[5] << 8 | (uint32_t)p[6] << 16 | (uint32_t)p[7] << 24;
+	size_t codeBytes = length > 1 ? ((size_t)length - 1 + 3) / 4 : 0;
+	if (length > 0x7fffffff || size - offset - 8 < codeBytes) return false;
+	packed.length = (int)length;
+	packed.words.assign((codeBytes + 7) / 8, 0);
+	for (size_t b = 0; b < codeBytes; b++) {
+		packed.words[b >> 3] |= (uint64_t)p[8 + b] << ((b & 7) * 8);
+	}
+	offset += 8 + codeBytes;
+	return true;
+}
@@ -2,7 +2,13 @@
 #include <iostream>      // For console input and output
 #include <raylib.h>      // For graphical rendering and game development utilities
 #include <raymath.h>     // For vector and matrix operations
-#include <deque>         // For using the deque container from the standard library
+#include <algorithm>     // For max and max_element
+#include <cmath>         // For logf
+#include <ctime>         // For timestamps of finished matches
+#include "Analytics.h"   // For the heatmap counters
+#include "Engine.h"      // For the headless game engine
+#include "Search.h"      // For the computer player
+#include "StatsStore.h"  // For the persistent match statistics
 using namespace std;     // Standard namespace to avoid prefixing std::
 
 // Define colors used in the game
@@ -15,9 +21,12 @@ int cellCount = 25;               // Number of cells in one row or column
 int offset = 75;                  // Offset from window edges to the game grid
 double gameUpdateTime = 0;        // Last game update time
 bool gameOver = false;            // Flag to check if the game is over
-bool allowMove = false;           // Flag to allow snake movement
+bool allowMove[2] = { false, false };  // Flags to allow each snake one turn per move of its own
 string winnerMessage = "";        // Message to display the winner
 
+// Heatmap overlay modes, cycled with the H key
+enum HeatmapMode { HEATMAP_OFF, HEATMAP_DEATHS, HEATMAP_FOOD };
+
 // Function to trigger events based on time interval
 bool eventTriggered(double interval, double& lastUpdateTime) {
 	double currentTime = GetTime();     // Get current time
@@ -28,36 +37,16 @@ bool eventTriggered(double interval, double& lastUpdateTime) {
 	return false;                       // Event not triggered
 }
 
-// Function to check if a vector element exists in a deque
-bool elementInDeque(Vector2 element, deque<Vector2> deque) {
-	for (unsigned int i = 0; i < deque.size(); i++) {
-		if (Vector2Equals(deque[i], element)) {
-			return true;    // Element found
-		}
-	}
-	return false;           // Element not found
-}
-
-// Food class for managing food items in the game
+// Food class for drawing food items in the game
 class Food {
 public:
-	Vector2 pos;          // Position of the food
 	Texture2D texture;    // Texture of the food
 
-	// Constructor for normal food
-	Food(deque<Vector2> snake1_body, deque<Vector2> snake2_body) {
-		Image image = LoadImage("Graphics/food.png"); // Load food image
+	// Constructor to load the food texture (normal food or power-up)
+	Food(const char* imagePath) {
+		Image image = LoadImage(imagePath);            // Load food image
 		texture = LoadTextureFromImage(image);       // Create texture from image
 		UnloadImage(image);                         // Unload the image to free memory
-		pos = GenRandPos(snake1_body, snake2_body); // Generate random position for food
-	}
-
-	// Constructor for power-up food
-	Food(deque<Vector2> snake_body, deque<Vector2> snake_body1, int powerup) {
-		Image image = LoadImage("Graphics/powerup.png"); // Load power-up image
-		texture = LoadTextureFromImage(image);          // Create texture from image
-		UnloadImage(image);                            // Unload the image to free memory
-		pos = GenRandPos(snake_body, snake_body1);     // Generate random position for power-up
 	}
 
 	// Destructor to unload texture
@@ -66,88 +55,60 @@ public:
 	}
 
 	// Function to draw the food on the game screen
-	void draw() {
+	void draw(Cell pos) {
 		DrawTexture(texture, offset + pos.x * cellSize, offset + pos.y * cellSize, WHITE);
 	}
-
-	// Function to generate a random cell position
-	Vector2 randomCell() {
-		float x = GetRandomValue(0, cellCount - 1);
-		float y = GetRandomValue(0, cellCount - 1);
-		return Vector2{ x, y };
-	}
-
-	// Function to generate a random position not occupied by snakes
-	Vector2 GenRandPos(deque<Vector2> snake1_body, deque<Vector2> snake2_body) {
-		Vector2 position = randomCell();
-		while (elementInDeque(position, snake1_body) || elementInDeque(position, snake2_body)) {
-			position = randomCell();  // Keep generating until a free spot is found
-		}
-		return position;
-	}
 };
 
-// Snake class for managing snake objects in the game
+// Snake class for drawing snake objects in the game (movement lives in the Engine)
 class Snake {
 public:
-	deque<Vector2> body;  // Deque to store body segments of the snake
-	Vector2 direction;    // Current moving direction of the snake
 	Color color;          // Color of the snake
-	bool addSegment = false;  // Flag to determine whether to add a new segment
 
 	// Constructor to initialize the snake
-	Snake(Vector2 startPos, Vector2 startDirection, Color snakeColor) {
-		direction = startDirection;  // Set initial direction
+	Snake(Color snakeColor) {
 		color = snakeColor;          // Set snake color
-		body.push_back(startPos);    // Add head to the body
-		body.push_back(Vector2Subtract(startPos, startDirection));  // Add second segment
-		body.push_back(Vector2Subtract(body.back(), startDirection));  // Add third segment
 	}
 
 	// Function to draw the snake on the game screen
-	void Draw() {
-		for (const auto& segment : body) {
-			float x = segment.x;
-			float y = segment.y;
-			Rectangle rect = { offset + x * cellSize, offset + y * cellSize, (float)cellSize, (float)cellSize };
+	void Draw(const EngineSnake& state) {
+		for (int i = 0; i < state.length; i++) {
+			Cell segment = state.segment(i);
+			Rectangle rect = { (float)(offset + segment.x * cellSize), (float)(offset + segment.y * cellSize), (float)cellSize, (float)cellSize };
 			DrawRectangleRounded(rect, 0.5, 6, color);  // Draw each segment as a rounded rectangle
 		}
 	}
-
-	// Function to update the snake's position
-	void update() {
-		body.push_front(Vector2Add(body[0], direction));  // Move the head in the current direction
-		if (!addSegment) {
-			body.pop_back();  // Remove the tail segment if not growing
-		} else {
-			addSegment = false;  // Reset the flag after adding a segment
-		}
-	}
-
-	// Function to reset the snake to the initial state
-	void reset(Vector2 startPos, Vector2 startDirection) {
-		body.clear();  // Clear the existing body
-		direction = startDirection;  // Reset direction
-		body.push_back(startPos);  // Add head
-		body.push_back(Vector2Subtract(startPos, startDirection));  // Add second segment
-		body.push_back(Vector2Subtract(body.back(), startDirection));  // Add third segment
-	}
 };
 
+// Function to build the rules for the window's board
+Rules gameRules() {
+	Rules rules;
+	rules.cellCount = cellCount;  // Board size used by the renderer
+	rules.simultaneous = true;  // Both snakes move at once; a head-on crash is a draw
+	rules.tickSeconds = 0.2;  // One base move every 0.2 seconds
+	rules.stepsPerTick = 6;  // Snake speeds are scheduled in sixths of a tick
+	rules.speedupLength = 8;  // Every 8 segments of growth makes a snake one step faster...
+	rules.minPeriod = 4;  // ...up to 1.5 times the base speed
+	rules.boostPeriod = 3;  // A power-up doubles the eater's speed...
+	rules.boostTicks = 25;  // ...for 5 seconds
+	return rules;
+}
+
 // Game class for managing the overall game logic
 class Game {
 public:
+	Engine engine;  // Headless engine holding the snakes, food, power-up and scores
 	Snake snake1;  // First snake object
 	Snake snake2;  // Second snake object
 	Food food;     // Food object
 	Food powerup;  // Power-up object
-	bool running = true;  // Flag to check if the game is running
-	int score1 = 0;  // Score for first snake
-	int score2 = 0;  // Score for second snake
-	bool showPowerup = false;  // Flag to display the power-up
-	double powerupOnTime = 0;  // Time when the power-up appeared
-	double powerupOffTime = 0;  // Time when the power-up disappeared
-	double powerupTimeGap = GetRandomValue(15, 16);  // Random time gap for the power-up to appear
+	StatsStore stats;  // Log of finished matches with high-score index
+	int64_t matchStartTick = 0;  // Engine tick the current match started at
+	int highScore = 0;  // Best score ever logged
+	AnalyticsAccumulator analytics;  // Per-cell death and food counts for the heatmap overlay
+	int heatmapMode = HEATMAP_OFF;  // Which heatmap is drawn over the grid
+	MinimaxBot bot;  // Computer player for the second snake
+	bool botPlays = false;  // Flag to let the computer steer the second snake
 
 	// Sounds for various game events
 	Sound eatSound;     // Sound when the snake eats food
@@ -156,14 +117,22 @@ public:
 
 	// Constructor to initialize the game
 	Game()
-		: snake1(Vector2{ 6, 9 }, Vector2{ 1, 0 }, DARKGREEN),
-		snake2(Vector2{ 18, 9 }, Vector2{ -1, 0 }, DARKBLUE),
-		food(snake1.body, snake2.body),
-		powerup(snake1.body, snake2.body, 1) {
+		: engine(gameRules(), (uint64_t)GetRandomValue(0, 0x7fffffff)),
+		snake1(DARKGREEN),
+		snake2(DARKBLUE),
+		food("Graphics/food.png"),
+		powerup("Graphics/powerup.png"),
+		analytics(cellCount) {
 		InitAudioDevice();  // Initialize audio device
 		eatSound = LoadSound("Sounds/eat.mp3");  // Load eating sound
 		hitSound = LoadSound("Sounds/wall.mp3");  // Load hitting sound
 		powerupSound = LoadSound("Sounds/powerup.mp3");  // Load power-up sound
+		if (stats.open("stats.log")) {
+			vector<ScoreEntry> best = stats.topScores(1);  // Read the high score from the index
+			highScore = best.empty() ? 0 : best[0].score;
+		}
+		analytics.readReport("analytics.csv");  // Aggregates from `snake_sim --tournament --analytics`, if present
+		analytics.beginMatch(engine);  // This session's matches are added on top
 	}
 
 	// Destructor to unload sounds and close audio device
@@ -172,111 +141,90 @@ public:
 		UnloadSound(hitSound);  // Unload hitting sound
 		UnloadSound(powerupSound);  // Unload power-up sound
 		CloseAudioDevice();  // Close the audio device
+		stats.writeIndex();  // Index this session's matches so the next start does not reparse them
 	}
 
 	// Function to draw game elements
 	void draw() {
-		snake1.Draw();  // Draw first snake
-		snake2.Draw();  // Draw second snake
-		food.draw();  // Draw food
-		if (showPowerup) {
-			powerup.draw();  // Draw power-up if it is visible
+		snake1.Draw(engine.snakes[0]);  // Draw first snake
+		snake2.Draw(engine.snakes[1]);  // Draw second snake
+		food.draw(engine.food);  // Draw food
+		if (engine.showPowerup) {
+			powerup.draw(engine.powerup);  // Draw power-up if it is visible
 		}
 	}
 
-	// Function to update game state
-	void update() {
-		if (running) {
-			snake1.update();  // Update first snake
-			snake2.update();  // Update second snake
-			checkFoodCollision(snake1, score1);  // Check collision with food for first snake
-			checkFoodCollision(snake2, score2);  // Check collision with food for second snake
-			checkPowerupCollision(snake1, score1);  // Check collision with power-up for first snake
-			checkPowerupCollision(snake2, score2);  // Check collision with power-up for second snake
-			checkCollisions();  // Check for any other collisions
-			togglePowerupOff();  // Manage power-up visibility
-			togglePowerupOn();  // Manage power-up appearance
+	// Function to draw the selected heatmap, each cell shaded by its log-scaled count
+	void drawHeatmap() {
+		if (heatmapMode == HEATMAP_OFF) return;
+		const vector<uint64_t>& heat = heatmapMode == HEATMAP_DEATHS ? analytics.deathHeat : analytics.foodHeat;
+		uint64_t peak = heat.empty() ? 0 : *max_element(heat.begin(), heat.end());
+		if (peak == 0) return;  // Nothing recorded yet
+		Color tint = heatmapMode == HEATMAP_DEATHS ? RED : ORANGE;
+		float scale = 1.0f / logf(1.0f + (float)peak);
+		for (int y = 0; y < cellCount; y++) {
+			for (int x = 0; x < cellCount; x++) {
+				uint64_t count = heat[y * cellCount + x];
+				if (count == 0) continue;
+				float level = logf(1.0f + (float)count) * scale;  // Log scale so rare cells stay visible
+				DrawRectangle(offset + x * cellSize, offset + y * cellSize, cellSize, cellSize, ColorAlpha(tint, 0.15f + 0.65f * level));
+			}
 		}
 	}
 
-	// Function to check food collision for a snake
-	void checkFoodCollision(Snake& snake, int& score) {
-		if (Vector2Equals(snake.body[0], food.pos)) {
-			food.pos = food.GenRandPos(snake1.body, snake2.body);  // Generate new food position
-			snake.addSegment = true;  // Flag to add a new segment to the snake
+	// Function to update game state to the next scheduled snake move
+	void update() {
+		uint32_t events = engine.update();  // Move, eat, collide and toggle the power-up
+		analytics.observe(engine, events);  // Count deaths and food for the heatmap
+		if (botPlays && engine.running) {
+			bot.timeLimit = 0.5 * engine.secondsToNextStep();  // Think for at most half the time to the next move
+			engine.setDirection(1, bot.chooseMove(engine, 1));  // Let the computer steer the second snake
+		}
+		if (events & (EVENT_FOOD1 | EVENT_FOOD2)) {
 			PlaySound(eatSound);  // Play eating sound
-			score++;  // Increase score
 		}
-	}
-
-	// Function to check power-up collision for a snake
-	void checkPowerupCollision(Snake& snake, int& score) {
-		if (Vector2Equals(snake.body[0], powerup.pos)) {
-			powerup.pos = { -1, -1 };  // Invalidate power-up position
-			showPowerup = false;  // Hide the power-up
-			snake.addSegment = true;  // Flag to add a new segment to the snake
+		if (events & (EVENT_POWERUP1 | EVENT_POWERUP2)) {
 			PlaySound(powerupSound);  // Play power-up sound
-			score += 5;  // Increase score by 5
 		}
-	}
-
-	// Function to check for collisions involving snakes
-	void checkCollisions() {
-		if (isOutOfBounds(snake1)) declareWinner(2);  // Declare second snake as winner if first snake is out of bounds
-		if (isOutOfBounds(snake2)) declareWinner(1);  // Declare first snake as winner if second snake is out of bounds
-		if (selfCollision(snake1)) declareWinner(2);  // Declare second snake as winner if first snake collides with itself
-		if (selfCollision(snake2)) declareWinner(1);  // Declare first snake as winner if second snake collides with itself
-		if (elementInDeque(snake1.body[0], snake2.body)) declareWinner(2);  // Declare second snake as winner if first snake collides with second snake
-		if (elementInDeque(snake2.body[0], snake1.body)) declareWinner(1);  // Declare first snake as winner if second snake collides with first snake
-	}
-
-	// Function to check if a snake is out of bounds
-	bool isOutOfBounds(Snake& snake) {
-		return snake.body[0].x < 0 || snake.body[0].x >= cellCount ||
-			snake.body[0].y < 0 || snake.body[0].y >= cellCount;  // Return true if the head is outside the game grid
-	}
-
-	// Function to check if a snake has collided with itself
-	bool selfCollision(Snake& snake) {
-		deque<Vector2> headlessBody = snake.body;  // Copy the snake body
-		headlessBody.pop_front();  // Remove the head
-		return elementInDeque(snake.body[0], headlessBody);  // Check if the head collides with any other body segment
-	}
-
-	// Function to manage power-up disappearance
-	void togglePowerupOff() {
-		if (showPowerup && eventTriggered(10, powerupOnTime)) {
-			showPowerup = false;  // Hide the power-up
-			powerup.pos = { -1, -1 };  // Invalidate power-up position
-		}
-	}
-
-	// Function to manage power-up appearance
-	void togglePowerupOn() {
-		if (!showPowerup && eventTriggered(powerupTimeGap, powerupOffTime)) {
-			showPowerup = true;  // Show the power-up
-			powerupOnTime = GetTime();  // Set the appearance time
-			powerup.pos = powerup.GenRandPos(snake1.body, snake2.body);  // Generate new power-up position
+		if (events & EVENT_GAME_OVER) {
+			declareWinner(engine.winner);  // Stop the game and show the winner
 		}
 	}
 
 	// Function to declare the winner and end the game
 	void declareWinner(int winner) {
-		running = false;  // Stop the game
 		gameOver = true;  // Set game over flag
-		winnerMessage = (winner == 1) ? "Player 1 Wins!" : "Player 2 Wins!";  // Set winner message
+		recordMatch(winner);  // Log the finished match
+		if (winner == DRAW) {
+			winnerMessage = "Draw!";  // Both snakes crashed in the same move
+		} else {
+			winnerMessage = (winner == 1) ? "Player 1 Wins!" : "Player 2 Wins!";  // Set winner message
+		}
+	}
+
+	// Function to append the finished match to the statistics log
+	void recordMatch(int winner) {
+		MatchRecord record;
+		record.timestamp = (int64_t)time(nullptr);  // When the match ended
+		record.durationTicks = (int32_t)(engine.tick - matchStartTick);  // How long it lasted
+		record.winner = (uint8_t)winner;
+		for (int i = 0; i < 2; i++) {
+			record.score[i] = engine.snakes[i].score;
+			record.length[i] = engine.snakes[i].length;
+			record.deathCause[i] = engine.deathCause[i];
+			highScore = max(highScore, record.score[i]);  // Keep the on-screen high score current
+		}
+		record.setPlayer(0, "P1");
+		record.setPlayer(1, "P2");
+		stats.append(record);
+		stats.sync();  // Make sure the record survives a crash or a closed window
 	}
 
 	// Function to reset the game to the initial state
 	void reset() {
-		snake1.reset(Vector2{ 6, 9 }, Vector2{ 1, 0 });  // Reset first snake
-		snake2.reset(Vector2{ 18, 9 }, Vector2{ -1, 0 });  // Reset second snake
-		food.pos = food.GenRandPos(snake1.body, snake2.body);  // Generate new food position
-		powerup.pos = { -1, -1 };  // Invalidate power-up position
-		showPowerup = false;  // Hide the power-up
-		score1 = 0;  // Reset first snake's score
-		score2 = 0;  // Reset second snake's score
-		running = true;  // Start the game
+		engine.reset();  // Reset snakes, food, power-up and scores
+		matchStartTick = engine.tick;  // Start timing the new match
+		analytics.beginMatch(engine);  // Start tracking the new match
 		gameOver = false;  // Clear game over flag
 		winnerMessage = "";  // Clear winner message
 	}
@@ -294,12 +242,22 @@ int main() {
 		BeginDrawing();  // Start drawing
 		ClearBackground(light);  // Clear the background with light color
 
-		if (!gameOver && eventTriggered(0.2, gameUpdateTime)) {
-			allowMove = true;  // Allow snake movement
+		if (!gameOver && eventTriggered(game.engine.secondsToNextStep(), gameUpdateTime)) {
 			game.update();  // Update the game
+			for (int i = 0; i < 2; i++) {
+				if (game.engine.moved >> i & 1) allowMove[i] = true;  // Only a snake that stepped may turn again
+			}
 		}
+		if (IsKeyPressed(KEY_H)) {
+			game.heatmapMode = (game.heatmapMode + 1) % 3;  // Cycle off, deaths, food
+		}
+		if (IsKeyPressed(KEY_B)) {
+			game.botPlays = !game.botPlays;  // Toggle the computer player for the second snake
+		}
+		game.drawHeatmap();  // Draw the heatmap under everything else
 		if (gameOver && IsKeyPressed(KEY_SPACE)) {
 			game.reset();  // Reset the game if space key is pressed
+			allowMove[0] = allowMove[1] = true;  // Both snakes start straight, so either may turn
 		}
 		if (gameOver) {
 			DrawText(winnerMessage.c_str(), offset + 100, offset + (cellSize * cellCount) / 2, 40, RED);  // Draw winner message
@@ -307,41 +265,37 @@ int main() {
 		} else {
 			game.draw();  // Draw the game elements
 		}
-		if (!gameOver && allowMove) {
+		if (!gameOver && allowMove[0]) {
 			// Handle input for first snake
-			if (IsKeyPressed(KEY_UP) && game.snake1.direction.y != 1) {
-				game.snake1.direction = { 0, -1 };  // Change direction to up
-				allowMove = false;  // Disallow further movement until next update
+			if (IsKeyPressed(KEY_UP) && game.engine.setDirection(0, DIR_UP)) {  // Change direction to up unless it reverses the snake
+				allowMove[0] = false;  // Disallow further turns until this snake moves
 			}
-			if (IsKeyPressed(KEY_DOWN) && game.snake1.direction.y != -1) {
-				game.snake1.direction = { 0, 1 };  // Change direction to down
-				allowMove = false;  // Disallow further movement until next update
+			if (IsKeyPressed(KEY_DOWN) && game.engine.setDirection(0, DIR_DOWN)) {  // Change direction to down unless it reverses the snake
+				allowMove[0] = false;  // Disallow further turns until this snake moves
 			}
-			if (IsKeyPressed(KEY_RIGHT) && game.snake1.direction.x != -1) {
-				game.snake1.direction = { 1, 0 };  // Change direction to right
-				allowMove = false;  // Disallow further movement until next update
+			if (IsKeyPressed(KEY_RIGHT) && game.engine.setDirection(0, DIR_RIGHT)) {  // Change direction to right unless it reverses the snake
+				allowMove[0] = false;  // Disallow further turns until this snake moves
 			}
-			if (IsKeyPressed(KEY_LEFT) && game.snake1.direction.x != 1) {
-				game.snake1.direction = { -1, 0 };  // Change direction to left
-				allowMove = false;  // Disallow further movement until next update
+			if (IsKeyPressed(KEY_LEFT) && game.engine.setDirection(0, DIR_LEFT)) {  // Change direction to left unless it reverses the snake
+				allowMove[0] = false;  // Disallow further turns until this snake moves
 			}
 
-			// Handle input for second snake
-			if (IsKeyPressed(KEY_W) && game.snake2.direction.y != 1) {
-				game.snake2.direction = { 0, -1 };  // Change direction to up
-				allowMove = false;  // Disallow further movement until next update
-			}
-			if (IsKeyPressed(KEY_S) && game.snake2.direction.y != -1) {
-				game.snake2.direction = { 0, 1 };  // Change direction to down
-				allowMove = false;  // Disallow further movement until next update
-			}
-			if (IsKeyPressed(KEY_D) and game.snake2.direction.x != -1) {
-				game.snake2.direction = { 1, 0 };  // Change direction to right
-				allowMove = false;  // Disallow further movement until next update
-			}
-			if (IsKeyPressed(KEY_A) and game.snake2.direction.x != 1) {
-				game.snake2.direction = { -1, 0 };  // Change direction to left
-				allowMove = false;  // Disallow further movement until next update
+		}
+		if (!gameOver && allowMove[1]) {
+			// Handle input for second snake (unless the computer steers it)
+			if (!game.botPlays) {
+				if (IsKeyPressed(KEY_W) && game.engine.setDirection(1, DIR_UP)) {  // Change direction to up unless it reverses the snake
+					allowMove[1] = false;  // Disallow further turns until this snake moves
+				}
+				if (IsKeyPressed(KEY_S) && game.engine.setDirection(1, DIR_DOWN)) {  // Change direction to down unless it reverses the snake
+					allowMove[1] = false;  // Disallow further turns until this snake moves
+				}
+				if (IsKeyPressed(KEY_D) && game.engine.setDirection(1, DIR_RIGHT)) {  // Change direction to right unless it reverses the snake
+					allowMove[1] = false;  // Disallow further turns until this snake moves
+				}
+				if (IsKeyPressed(KEY_A) && game.engine.setDirection(1, DIR_LEFT)) {  // Change direction to left unless it reverses the snake
+					allowMove[1] = false;  // Disallow further turns until this snake moves
+				}
 			}
 		}
 
@@ -349,9 +303,15 @@ int main() {
 		DrawRectangleLinesEx(Rectangle{ (float)offset - 5, (float)offset - 5, (float)cellSize * cellCount + 10, (float)cellSize * cellCount + 10 }, 5, dark);
 		// Draw the game title
 		DrawText("2-Player Snake ", offset - 5, 20, 40, dark);
+		// Draw the heatmap legend
+		const char* heatmapNames[] = { "off", "deaths", "food" };
+		DrawText(TextFormat("Heatmap (H): %s", heatmapNames[game.heatmapMode]), offset + 560, 35, 20, dark);
+		// Draw who steers the second snake
+		DrawText(TextFormat("P2 (B): %s", game.botPlays ? "computer" : "keys"), offset + 560, 12, 20, dark);
 		// Draw the scores for both players
-		DrawText(TextFormat("P1 Score: %02i", game.score1), offset - 5, offset + cellSize * cellCount + 10, 20, dark);
-		DrawText(TextFormat("P2 Score: %02i", game.score2), offset + 300, offset + cellSize * cellCount + 10, 20, dark);
+		DrawText(TextFormat("P1 Score: %02i", game.engine.snakes[0].score), offset - 5, offset + cellSize * cellCount + 10, 20, dark);
+		DrawText(TextFormat("P2 Score: %02i", game.engine.snakes[1].score), offset + 300, offset + cellSize * cellCount + 10, 20, dark);
+		DrawText(TextFormat("High Score: %02i", game.highScore), offset + 560, offset + cellSize * cellCount + 10, 20, dark);
 
 		EndDrawing();  // End drawing
 	}
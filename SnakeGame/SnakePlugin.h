@@ -0,0 +1,76 @@
+#pragma once
+// C interface for bot plugins (shared libraries loaded by "plugin:PATH" in createBot).
+// This header is all a plugin needs; it is plain C so plugins can be written in C, C++ or anything
+// that can export C functions. A plugin exports four functions:
+//
+//   SNAKE_PLUGIN_EXPORT int32_t snake_plugin_abi(void) { return SNAKE_PLUGIN_ABI; }
+//   SNAKE_PLUGIN_EXPORT void* snake_plugin_init(uint64_t seed);       // One bot, created per match
+//   SNAKE_PLUGIN_EXPORT int32_t snake_plugin_choose_move(void* bot, const SnakePluginState* state);
+//   SNAKE_PLUGIN_EXPORT void snake_plugin_shutdown(void* bot);        // Called when the match ends
+//
+// choose_move returns a direction (0 up, 1 right, 2 down, 3 left); anything else keeps the current
+// one. The state points straight into the engine's memory, so it is only valid during the call and
+// must not be written. Bodies are ring buffers: segment i (0 is the head) is
+// ring[(head + i) & mask], see snake_plugin_segment(). init may return NULL if the plugin keeps no
+// state. Calls for one bot come from one thread at a time, but different bots of the same plugin can
+// run in different threads at once.
+//
+// Build a plugin with e.g. `gcc -O2 -shared -fPIC -o mybot.so mybot.c` (a DLL on Windows).
+#include <stdint.h>      // For fixed-width integer types
+
+#ifdef _WIN32
+#define SNAKE_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define SNAKE_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+#define SNAKE_PLUGIN_ABI 1  // Bumped whenever the structures below change
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct SnakePluginCell {
+	int32_t x;
+	int32_t y;
+} SnakePluginCell;
+
+typedef struct SnakePluginSnake {
+	const SnakePluginCell* ring;  // Body ring buffer
+	uint32_t mask;                // Ring capacity - 1
+	uint32_t head;                // Ring index of the head
+	int32_t length;               // Number of segments
+	int32_t direction;            // Current direction (0 up, 1 right, 2 down, 3 left)
+	int32_t score;                // Current score
+} SnakePluginSnake;
+
+typedef struct SnakePluginState {
+	int32_t board;                   // Cells per row and column
+	int32_t you;                     // Index of the snake to move (0 or 1)
+	int64_t tick;                    // Ticks since the match started
+	SnakePluginCell food;            // Food position
+	SnakePluginCell powerup;         // Visible power-up, or { -1, -1 }
+	SnakePluginSnake snakes[2];      // Both snakes
+	const uint8_t* occupancy[2];     // Per-cell segment counts of each snake, row-major (y * board + x)
+} SnakePluginState;
+
+typedef int32_t (*SnakePluginAbiFn)(void);
+typedef void* (*SnakePluginInitFn)(uint64_t seed);
+typedef int32_t (*SnakePluginChooseMoveFn)(void* bot, const SnakePluginState* state);
+typedef void (*SnakePluginShutdownFn)(void* bot);
+
+// Function to get segment i of a snake (0 is the head)
+static inline SnakePluginCell snake_plugin_segment(const SnakePluginSnake* snake, int32_t i) {
+	return snake->ring[(snake->head + (uint32_t)i) & snake->mask];
+}
+
+// Function to check if a cell is off the board or holds any snake segment
+static inline int snake_plugin_blocked(const SnakePluginState* state, int32_t x, int32_t y) {
+	if (x < 0 || y < 0 || x >= state->board || y >= state->board) return 1;
+	int32_t index = y * state->board + x;
+	return (state->occupancy[0][index] | state->occupancy[1][index]) != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
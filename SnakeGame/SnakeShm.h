@@ -0,0 +1,126 @@
+#pragma once
+// Shared-memory channel between snake_sim and a bot running in another process ("process:COMMAND"
+// in createBot). This header is all the bot side needs; it is plain C (Linux only, GCC or Clang).
+//
+// The host starts COMMAND through /bin/sh with the channel's file descriptor in the environment
+// variable SNAKE_SHM_FD. A bot maps it with snake_shm_attach() and then loops over
+// snake_shm_next() and snake_shm_reply():
+//
+//   SnakeShmChannel* channel = snake_shm_attach();
+//   const SnakeShmSlot* slot;
+//   uint32_t sequence = 0;
+//   while ((slot = snake_shm_next(channel, &sequence)) != NULL) {
+//       snake_shm_reply(channel, sequence, choose(slot));   // 0 up, 1 right, 2 down, 3 left
+//   }
+//
+// Each request is written into the next of SNAKE_SHM_SLOTS slots, so the host can post a new request
+// while a slow bot still reads an old one. A bot always answers the latest request: one that misses
+// its deadline is played as "keep direction" and its late reply is ignored. Both sides spin briefly
+// and then sleep on a futex, and each side only makes the wake-up system call when the other sleeps.
+// One process plays one bot at a time but is reused for later matches; `match` changes when a new
+// match starts. snake_shm_next() returns NULL when snake_sim closes the channel or exits.
+#include <errno.h>       // For ESRCH
+#include <signal.h>      // For checking that snake_sim still runs
+#include <stdint.h>      // For fixed-width integer types
+#include <stdlib.h>      // For getenv and atoi
+#include <linux/futex.h> // For FUTEX_WAIT and FUTEX_WAKE
+#include <sys/mman.h>    // For mapping the channel
+#include <sys/syscall.h> // For the futex system call
+#include <time.h>        // For futex timeouts
+#include <unistd.h>      // For syscall
+
+#define SNAKE_SHM_MAGIC 0x4d485353u  // "SSHM"
+#define SNAKE_SHM_ABI 1              // Bumped whenever the structures below change
+#define SNAKE_SHM_SLOTS 4            // Requests in flight before a slot is reused
+#define SNAKE_SHM_MAX_CELLS 4096     // Largest body (boards up to 64 x 64)
+
+typedef struct SnakeShmSnake {
+	int32_t length;                         // Number of segments
+	int32_t direction;                      // Current direction (0 up, 1 right, 2 down, 3 left)
+	int32_t score;                          // Current score
+	int32_t reserved;
+	uint8_t body[SNAKE_SHM_MAX_CELLS][2];   // Segments head first, as { x, y }
+} SnakeShmSnake;
+
+typedef struct SnakeShmSlot {
+	uint32_t sequence;          // Request written here (written last by the host)
+	int32_t move;               // Reply, written by the bot
+	uint64_t match;             // Changes when a new match starts
+	int64_t tick;               // Ticks since the match started
+	int32_t board;              // Cells per row and column
+	int32_t you;                // Index of the snake to move (0 or 1)
+	int32_t food[2];            // Food { x, y }
+	int32_t powerup[2];         // Visible power-up { x, y }, or { -1, -1 }
+	SnakeShmSnake snakes[2];    // Both snakes
+} SnakeShmSlot;
+
+typedef struct SnakeShmChannel {
+	uint32_t magic;             // SNAKE_SHM_MAGIC
+	uint32_t abi;               // SNAKE_SHM_ABI
+	uint32_t ready;             // Futex word: set to 1 by the bot once attached
+	uint32_t request;           // Futex word: sequence of the latest request (host)
+	uint32_t reply;             // Futex word: sequence of the latest answered request (bot)
+	uint32_t botSleeping;       // Set while the bot sleeps on `request`
+	uint32_t hostSleeping;      // Set while the host sleeps on `reply` or `ready`
+	uint32_t closing;           // Set by the host when the process should exit
+	uint32_t host;              // Process id of snake_sim, so the bot notices if it dies
+	SnakeShmSlot slots[SNAKE_SHM_SLOTS];
+} SnakeShmChannel;
+
+// Function to sleep while *word still holds value, for at most nanoseconds (< 0 waits forever)
+static inline void snake_shm_wait(uint32_t* word, uint32_t value, int64_t nanoseconds) {
+	struct timespec timeout;
+	timeout.tv_sec = (time_t)(nanoseconds / 1000000000);
+	timeout.tv_nsec = (long)(nanoseconds % 1000000000);
+	syscall(SYS_futex, word, FUTEX_WAIT, value, nanoseconds < 0 ? NULL : &timeout, NULL, 0);
+}
+
+// Function to wake every process sleeping on a word
+static inline void snake_shm_wake(uint32_t* word) {
+	syscall(SYS_futex, word, FUTEX_WAKE, 0x7fffffff, NULL, NULL, 0);
+}
+
+// Function to map the channel named by SNAKE_SHM_FD and report it ready; NULL if there is none
+static inline SnakeShmChannel* snake_shm_attach(void) {
+	const char* fd = getenv("SNAKE_SHM_FD");
+	if (!fd) return NULL;
+	void* memory = mmap(NULL, sizeof(SnakeShmChannel), PROT_READ | PROT_WRITE, MAP_SHARED, atoi(fd), 0);
+	if (memory == MAP_FAILED) return NULL;
+	SnakeShmChannel* channel = (SnakeShmChannel*)memory;
+	if (channel->magic != SNAKE_SHM_MAGIC || channel->abi != SNAKE_SHM_ABI) return NULL;
+	__atomic_store_n(&channel->ready, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&channel->hostSleeping, __ATOMIC_SEQ_CST)) snake_shm_wake(&channel->ready);
+	return channel;
+}
+
+// Function to wait for a request newer than *sequence; stores its sequence and returns its slot, or
+// NULL once the host closes the channel
+static inline const SnakeShmSlot* snake_shm_next(SnakeShmChannel* channel, uint32_t* sequence) {
+	int spins = 0;
+	while (1) {
+		if (__atomic_load_n(&channel->closing, __ATOMIC_ACQUIRE)) return NULL;
+		uint32_t latest = __atomic_load_n(&channel->request, __ATOMIC_ACQUIRE);
+		if (latest != *sequence) {
+			const SnakeShmSlot* slot = &channel->slots[latest % SNAKE_SHM_SLOTS];
+			if (__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) == latest) {
+				*sequence = latest;
+				return slot;
+			}
+		}
+		if (++spins < 200) continue;
+		__atomic_store_n(&channel->botSleeping, 1, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&channel->request, __ATOMIC_SEQ_CST) == latest && !__atomic_load_n(&channel->closing, __ATOMIC_SEQ_CST)) {
+			snake_shm_wait(&channel->request, latest, 100000000);
+		}
+		if (kill((pid_t)channel->host, 0) != 0 && errno == ESRCH) return NULL;  // snake_sim is gone
+		__atomic_store_n(&channel->botSleeping, 0, __ATOMIC_SEQ_CST);
+		spins = 0;
+	}
+}
+
+// Function to answer a request
+static inline void snake_shm_reply(SnakeShmChannel* channel, uint32_t sequence, int32_t move) {
+	channel->slots[sequence % SNAKE_SHM_SLOTS].move = move;
+	__atomic_store_n(&channel->reply, sequence, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&channel->hostSleeping, __ATOMIC_SEQ_CST)) snake_shm_wake(&channel->reply);
+}
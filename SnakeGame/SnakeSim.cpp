@@ -0,0 +1,1316 @@
+// Headless command-line tool for the simulation core (no window, no audio)
+#include <cstdio>        // For console output
+#include <cstdlib>       // For string to number conversions
+#include <chrono>        // For timing benchmarks
+#include <cmath>         // For fabs
+#include <cstring>       // For argument comparison
+#include <algorithm>     // For sorting the rating table
+#include <atomic>        // For the inference benchmark clients
+#include <string>        // For bot lists
+#include <thread>        // For the inference benchmark clients
+#include <vector>        // For bot lists
+#include "Arena.h"
+#include "Batch.h"
+#include "Bitboard.h"
+#include "Bitsliced.h"
+#include "BotVM.h"
+#include "Bot.h"
+#include "GoldenMaster.h"
+#include "InferenceBroker.h"
+#include "Search.h"
+#include "SelfPlay.h"
+#include "Match.h"
+#include "Policy.h"
+#include "ProcessBot.h"
+#include "StatsStore.h"
+#include "Sweep.h"
+#include "Tablebase.h"
+#include "ThreadPool.h"
+#include "Tournament.h"
+#include "Tuner.h"
+using namespace std;
+
+// Function to print the command-line usage
+static void printUsage() {
+	printf("Usage:\n");
+	printf("  snake_sim --matches N [--threads T] [--bot1 X] [--bot2 Y] [--seed S] [--board B]\n");
+	printf("            [--format csv|json] [--out FILE] [--food-score F] [--powerup-score P]\n");
+	printf("            [--powerup-life TICKS] [--powerup-gap MIN[,MAX]] [nn batching] [match limits]\n");
+	printf("  snake_sim --golden-master [--ticks N] [--threads T] [--seed S] [--min-board A] [--max-board B] [--max-match-ticks M]\n");
+	printf("                            [--scheduler-matches K]\n");
+	printf("  snake_sim --tournament --bots A,B,... [--matches N] [--threads T] [--seed S] [--ratings FILE] [--batch B] [--stats FILE]\n");
+	printf("                       [--analytics FILE] [nn batching] [match limits]\n");
+	printf("  snake_sim --sweep [--bot1 X] [--bot2 Y] [--matches N] [--threads T] [--seed S] [--board B] [--out FILE]\n");
+	printf("                    [--gap A,B,..] [--gap-spread S] [--life A,B,..] [--powerup-score A,B,..] [--food-score A,B,..]\n");
+	printf("                    [match limits]\n");
+	printf("  snake_sim --stats FILE [--top N] [--day YYYY-MM-DD] [--player NAME] [--reindex]\n");
+	printf("  snake_sim --arena [--snakes N] [--board B] [--foods F] [--ticks T] [--threads T] [--seed S]\n");
+	printf("  snake_sim --bitsliced [--matches N] [--threads T] [--seed S] [--board B] [--max-ticks M] [--sequential] [--verify]\n");
+	printf("  snake_sim --flood [--positions N] [--seed S] [--board B]\n");
+	printf("  snake_sim --search [--matches N] [--millis M] [--opponent X] [--seed S] [--board B] [--sequential]\n");
+	printf("  snake_sim --nn-train --out FILE [--teacher X] [--samples N] [--epochs E] [--seed S] [--board B]\n");
+	printf("  snake_sim --nn-bench --weights FILE [--positions N] [--batch B] [--clients T] [--seed S] [--board B]\n");
+	printf("  snake_sim --vm FILE [--positions N] [--budget B] [--seed S] [--board B]\n");
+	printf("  snake_sim --tablebase --out FILE [--board B] [--max-length L] [--threads T]\n");
+	printf("  snake_sim --tablebase --in FILE --grade BOT [--matches N] [--seed S]\n");
+	printf("  snake_sim --tune --checkpoint FILE [--resume] [--population P] [--generations G] [--matches N]\n");
+	printf("                   [--opponent BOT] [--elite E] [--mutation SD] [--threads T] [--seed S] [--board B] [match limits]\n");
+	printf("  snake_sim --selfplay --out PREFIX [--bot X] [--matches N] [--threads T] [--seed S] [--board B] [--shard-kb K]\n");
+	printf("                       [match limits]\n");
+	printf("  snake_sim --selfplay --in FILE...\n");
+	printf("  nn batching: [--nn-batch N] [--nn-wait MICROSECONDS]\n");
+	printf("  match limits: [--max-ticks M] [--adjudicate EVERY] [--repetitions N] [--draw-at-cap]\n");
+}
+
+// Function to parse a match limit option taking a value; returns false for any other option
+static bool parseLimit(const char* arg, const char* value, MatchLimits& limits) {
+	if (strcmp(arg, "--max-ticks") == 0) limits.maxTicks = atoi(value);
+	else if (strcmp(arg, "--adjudicate") == 0) limits.adjudicateEvery = max(0, atoi(value));
+	else if (strcmp(arg, "--repetitions") == 0) limits.repetitions = max(0, atoi(value));
+	else return false;
+	return true;
+}
+
+// Function to parse an inference batching option for "nn:" bots; returns false for any other option
+static bool parseBatching(const char* arg, const char* value, int& size, double& wait) {
+	if (strcmp(arg, "--nn-batch") == 0) size = atoi(value);
+	else if (strcmp(arg, "--nn-wait") == 0) wait = max(0.0, atof(value)) / 1e6;
+	else return false;
+	return true;
+}
+
+// Function to print how well "nn:" bot moves were batched, how "process:" bots kept up, how much "vm:"
+// bots computed and how often "tablebase:" bots found their position, if any played
+static void printBotTotals(FILE* out) {
+	BrokerStats s = policyBatchingStats();
+	if (s.batches > 0) {
+		fprintf(out, "Inference: %llu moves in %llu batches, %.1f per batch, %.1f%% of batches full\n",
+			(unsigned long long)s.requests, (unsigned long long)s.batches, (double)s.requests / s.batches,
+			100.0 * s.fullBatches / s.batches);
+	}
+	VMStats v = vmStats();
+	if (v.moves > 0) {
+		fprintf(out, "VM bots: %llu moves, %.1f instructions per move, %llu ran out of budget\n", (unsigned long long)v.moves,
+			(double)v.instructions / v.moves, (unsigned long long)v.exhausted);
+	}
+	TablebaseBotStats t = tablebaseBotStats();
+	if (t.moves > 0) {
+		fprintf(out, "Tablebase bots: %llu of %llu moves played from the tables\n", (unsigned long long)t.probed, (unsigned long long)t.moves);
+	}
+	ProcessBotStats p = processBotStats();
+	if (p.moves > 0) {
+		fprintf(out, "Bot processes: %llu started, %llu moves, %.1f us per reply on average, longest %.2f ms, %llu timeouts\n",
+			(unsigned long long)p.processes, (unsigned long long)p.moves, p.waitSeconds * 1e6 / p.moves, p.longestWait * 1000,
+			(unsigned long long)p.timeouts);
+	}
+}
+
+// Function to run the golden-master harness and report the result
+static int goldenMasterMain(int argc, char** argv) {
+	GoldenMasterOptions options;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--ticks") == 0) options.ticks = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--threads") == 0) options.threads = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) options.seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--min-board") == 0) options.minBoard = atoi(value);
+		else if (strcmp(arg, "--max-board") == 0) options.maxBoard = atoi(value);
+		else if (strcmp(arg, "--max-match-ticks") == 0) options.maxMatchTicks = atoi(value);
+		else if (strcmp(arg, "--scheduler-matches") == 0) options.schedulerMatches = atoi(value);
+		else { printUsage(); return 2; }
+		i++;
+	}
+	if (options.minBoard < 10 || options.maxBoard < options.minBoard) {
+		printf("Board sizes must satisfy 10 <= min-board <= max-board\n");
+		return 2;
+	}
+
+	GoldenMasterReport report = runGoldenMaster(options);
+	printf("%llu ticks in %llu matches, %.2f s (%.1f M ticks/s)\n", (unsigned long long)report.ticks,
+		(unsigned long long)report.matches, report.seconds, report.ticks / report.seconds / 1e6);
+	printf("scheduler: %llu sub-steps in %d multi-speed matches, fingerprint %016llx\n",
+		(unsigned long long)report.schedulerSteps, options.schedulerMatches, (unsigned long long)report.schedulerFingerprint);
+	if (!report.passed) {
+		printf("MISMATCH: match seed %llu, tick %lld: %s\n", (unsigned long long)report.failingSeed,
+			(long long)report.failingTick, report.detail.c_str());
+		return 1;
+	}
+	printf("OK: engine matches the reference rules, scheduler keeps its invariants\n");
+	return 0;
+}
+
+// Function to run a many-snake arena and report its throughput
+static int arenaMain(int argc, char** argv) {
+	ArenaOptions options;
+	int ticks = 1000;
+	int threads = 0;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--snakes") == 0) options.snakes = atoi(value);
+		else if (strcmp(arg, "--board") == 0) options.cellCount = atoi(value);
+		else if (strcmp(arg, "--foods") == 0) options.foods = atoi(value);
+		else if (strcmp(arg, "--ticks") == 0) ticks = atoi(value);
+		else if (strcmp(arg, "--threads") == 0) threads = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) options.seed = strtoull(value, nullptr, 10);
+		else { printUsage(); return 2; }
+		i++;
+	}
+	if (options.cellCount < 4 || options.cellCount > 4096 || options.snakes < 1) {
+		printf("Board must be 4..4096 cells wide and there must be at least one snake\n");
+		return 2;
+	}
+
+	ThreadPool pool(threads);
+	Arena arena(options, pool);
+	int64_t deaths = 0;
+	auto startTime = chrono::steady_clock::now();
+	for (int t = 0; t < ticks; t++) {
+		arena.update();
+		deaths += arena.deathsLastTick;
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	printf("%d snakes on %dx%d, %d threads: %d ticks in %.3f s (%.0f ticks/s, %.1f M snake-moves/s)\n",
+		options.snakes, options.cellCount, options.cellCount, pool.size(), ticks, seconds, ticks / seconds,
+		(double)ticks * options.snakes / seconds / 1e6);
+	printf("alive %d, deaths %lld, state hash %016llx\n", arena.aliveCount(), (long long)deaths,
+		(unsigned long long)arena.stateHash());
+	return 0;
+}
+
+// Function to check if two match results agree in every field
+static bool sameResult(const MatchResult& a, const MatchResult& b) {
+	return a.seed == b.seed && a.winner == b.winner && a.ticks == b.ticks && a.score[0] == b.score[0] &&
+		a.score[1] == b.score[1] && a.length[0] == b.length[0] && a.length[1] == b.length[1] &&
+		a.deathCause[0] == b.deathCause[0] && a.deathCause[1] == b.deathCause[1];
+}
+
+// Function to play steady-vs-steady matches on the bit-sliced engine, optionally replaying them on Engine
+static int bitslicedMain(int argc, char** argv) {
+	uint64_t matches = 100000;
+	uint64_t seed = 1;
+	int threads = 0;
+	int board = 25;
+	int maxTicks = 5000;
+	bool sequential = false, verify = false;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strcmp(arg, "--sequential") == 0) { sequential = true; continue; }
+		if (strcmp(arg, "--verify") == 0) { verify = true; continue; }
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--matches") == 0) matches = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--threads") == 0) threads = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else if (strcmp(arg, "--max-ticks") == 0) maxTicks = atoi(value);
+		else { printUsage(); return 2; }
+		i++;
+	}
+	Rules rules = Rules::forBoard(board);
+	rules.simultaneous = !sequential;
+	if (!BitslicedEngine::supports(rules)) {
+		printf("Board must be at most %d cells wide with both starting snakes on it\n", BitslicedEngine::MAX_CELLS);
+		return 2;
+	}
+
+	// Matches run in blocks so memory stays bounded; seeds follow the batch runner
+	ThreadPool pool(threads);
+	const uint64_t blockMatches = 1 << 16;
+	vector<uint64_t> seeds;
+	vector<MatchResult> results;
+	uint64_t ticks = 0, outcomes[4] = { 0, 0, 0, 0 }, mismatches = 0;
+	double seconds = 0, engineSeconds = 0;
+	for (uint64_t first = 0; first < matches; first += blockMatches) {
+		int count = (int)min(blockMatches, matches - first);
+		seeds.resize(count);
+		results.resize(count);
+		for (int i = 0; i < count; i++) seeds[i] = mix64(seed ^ mix64(first + i));
+		auto startTime = chrono::steady_clock::now();
+		pool.parallelFor(count, [&](int begin, int end, int) {
+			playBitsliced(rules, maxTicks, seeds.data() + begin, end - begin, results.data() + begin);
+		});
+		seconds += chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+		for (const MatchResult& r : results) {
+			ticks += r.ticks;
+			outcomes[r.winner & 3]++;
+		}
+		if (!verify) continue;
+
+		vector<uint64_t> failures(pool.size(), 0);
+		startTime = chrono::steady_clock::now();
+		pool.parallelFor(count, [&](int begin, int end, int worker) {
+			Engine engine(rules, 0);
+			unique_ptr<Bot> bot1 = createBot("steady", 0), bot2 = createBot("steady", 0);
+			for (int i = begin; i < end; i++) {
+				MatchResult expected = playMatch(engine, rules, *bot1, *bot2, seeds[i], MatchLimits{ maxTicks });
+				if (sameResult(expected, results[i])) continue;
+				if (failures[worker]++ == 0) {
+					printf("MISMATCH: match %llu (seed %llu): engine winner %d after %d ticks, bit-sliced winner %d after %d ticks\n",
+						(unsigned long long)(first + i), (unsigned long long)seeds[i], expected.winner, expected.ticks,
+						results[i].winner, results[i].ticks);
+				}
+			}
+		});
+		engineSeconds += chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+		for (uint64_t f : failures) mismatches += f;
+	}
+
+	printf("%llu matches (%llu match-ticks) in %.2f s on %d threads: %.1f M match-ticks/s (%.1f M per thread)\n",
+		(unsigned long long)matches, (unsigned long long)ticks, seconds, pool.size(), ticks / seconds / 1e6,
+		ticks / seconds / 1e6 / pool.size());
+	printf("wins %llu / %llu, draws %llu, unfinished %llu\n", (unsigned long long)outcomes[1],
+		(unsigned long long)outcomes[2], (unsigned long long)outcomes[DRAW], (unsigned long long)outcomes[NO_WINNER]);
+	if (!verify) return 0;
+	printf("Engine replay: %.2f s (%.1f M match-ticks/s)\n", engineSeconds, ticks / engineSeconds / 1e6);
+	if (mismatches) {
+		printf("%llu of %llu matches differ from Engine\n", (unsigned long long)mismatches, (unsigned long long)matches);
+		return 1;
+	}
+	printf("OK: bit-sliced results match the engine\n");
+	return 0;
+}
+
+// Position both snakes are about to move from, for the flood-fill benchmark
+struct FloodPosition {
+	Bitboard free;        // Free cells
+	Cell heads[2];        // Heads of both snakes
+	Dir directions[2];    // Their current directions
+};
+
+// Function to get BFS distances from a start cell through the free cells (-1 where unreachable); the
+// start cell itself need not be free (reference for --flood)
+static vector<int> bfsDistances(const Bitboard& free, Cell start) {
+	int n = free.cellCount;
+	vector<int> distance((size_t)n * n, -1);
+	vector<Cell> queue(1, start);
+	distance[start.y * n + start.x] = 0;
+	for (size_t i = 0; i < queue.size(); i++) {
+		for (int d = 0; d < 4; d++) {
+			Cell next = stepCell(queue[i], (Dir)d);
+			if (next.x < 0 || next.x >= n || next.y < 0 || next.y >= n || distance[next.y * n + next.x] >= 0 || !free.test(next)) continue;
+			distance[next.y * n + next.x] = distance[queue[i].y * n + queue[i].x] + 1;
+			queue.push_back(next);
+		}
+	}
+	return distance;
+}
+
+// Function to check bitboard flood fills and territories against BFS on positions from roomy-vs-cautious
+// matches and time them
+static int floodMain(int argc, char** argv) {
+	uint64_t positions = 100000;
+	uint64_t seed = 1;
+	int board = 25;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--positions") == 0) positions = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--seed") == 0) seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else { printUsage(); return 2; }
+		i++;
+	}
+	if (board < 10 || board > Bitboard::MAX_CELLS || positions == 0) {
+		printf("Board must be 10..%d cells wide and positions at least 1\n", Bitboard::MAX_CELLS);
+		return 2;
+	}
+
+	// Collect the positions both snakes move from
+	Rules rules = Rules::forBoard(board);
+	vector<FloodPosition> samples;
+	samples.reserve((size_t)positions);
+	Engine engine(rules, 0);
+	for (uint64_t match = 0; samples.size() < positions; match++) {
+		uint64_t matchSeed = mix64(seed ^ mix64(match));
+		engine.restart(rules, matchSeed);
+		unique_ptr<Bot> bots[2] = { createBot("roomy", matchSeed ^ 1), createBot("cautious", matchSeed ^ 2) };
+		while (engine.running && engine.tick < 5000 && samples.size() < positions) {
+			FloodPosition p = { freeCells(engine), { engine.snakes[0].head(), engine.snakes[1].head() },
+				{ engine.snakes[0].direction, engine.snakes[1].direction } };
+			samples.push_back(p);
+			for (int s = 0; s < 2; s++) engine.setDirection(s, bots[s]->chooseMove(engine, s));
+			engine.update();
+		}
+	}
+
+	uint64_t areaMismatches = 0, territoryMismatches = 0, moves = 0;
+	Territory territory;
+	for (const FloodPosition& p : samples) {
+		for (int s = 0; s < 2; s++) {
+			int areas[4];
+			moveAreas(p.free, p.heads[s], p.directions[s], areas);
+			for (int d = 0; d < 4; d++) {
+				Cell next = stepCell(p.heads[s], (Dir)d);
+				int expected = 0;
+				if (d != oppositeDir(p.directions[s]) && next.x >= 0 && next.x < board && next.y >= 0 && next.y < board && p.free.test(next)) {
+					vector<int> distance = bfsDistances(p.free, next);
+					expected = (int)count_if(distance.begin(), distance.end(), [](int v) { return v >= 0; });
+				}
+				moves += expected > 0;
+				if (areas[d] == expected) continue;
+				if (areaMismatches++ == 0) {
+					printf("MISMATCH: head (%d, %d) move %d: flood fill %d, BFS %d\n", p.heads[s].x, p.heads[s].y, d, areas[d], expected);
+				}
+			}
+		}
+
+		// A cell belongs to the snake strictly closest to it
+		territory.compute(p.free, p.heads, 2);
+		vector<int> distance[2] = { bfsDistances(p.free, p.heads[0]), bfsDistances(p.free, p.heads[1]) };
+		int expected[2] = { 0, 0 };
+		for (int c = 0; c < board * board; c++) {
+			int d1 = distance[0][c], d2 = distance[1][c];
+			if (!p.free.test(Cell{ c % board, c / board })) continue;
+			if (d1 >= 0 && (d2 < 0 || d1 < d2)) expected[0]++;
+			if (d2 >= 0 && (d1 < 0 || d2 < d1)) expected[1]++;
+		}
+		if (territory.cells[0] == expected[0] && territory.cells[1] == expected[1]) continue;
+		if (territoryMismatches++ == 0) {
+			printf("MISMATCH: heads (%d, %d) and (%d, %d): territory %d / %d, BFS %d / %d\n", p.heads[0].x, p.heads[0].y,
+				p.heads[1].x, p.heads[1].y, territory.cells[0], territory.cells[1], expected[0], expected[1]);
+		}
+	}
+
+	// Time both kernels over every position, repeated until the run is long enough to measure
+	uint64_t areaCalls = 0, territoryCalls = 0, checksum = 0;
+	auto startTime = chrono::steady_clock::now();
+	double areaSeconds = 0, territorySeconds = 0;
+	while (areaSeconds < 0.5) {
+		for (const FloodPosition& p : samples) {
+			int areas[4];
+			moveAreas(p.free, p.heads[0], p.directions[0], areas);
+			checksum += areas[0] + areas[1] + areas[2] + areas[3];
+		}
+		areaCalls += samples.size();
+		areaSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	}
+	startTime = chrono::steady_clock::now();
+	while (territorySeconds < 0.5) {
+		for (const FloodPosition& p : samples) {
+			territory.compute(p.free, p.heads, 2);
+			checksum += territory.cells[0] - territory.cells[1];
+		}
+		territoryCalls += samples.size();
+		territorySeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	}
+#if defined(__AVX2__)
+	const char* path = "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	const char* path = "SSE2";
+#else
+	const char* path = "scalar";
+#endif
+	printf("%zu positions (%llu safe moves), %s build (checksum %llu)\n", samples.size(), (unsigned long long)moves, path,
+		(unsigned long long)checksum);
+	printf("moveAreas: %.0f ns per call\n", areaSeconds * 1e9 / areaCalls);
+	printf("territory: %.0f ns per call (%.2f M calls/s)\n", territorySeconds * 1e9 / territoryCalls,
+		territoryCalls / territorySeconds / 1e6);
+	if (areaMismatches || territoryMismatches) {
+		printf("%llu move areas and %llu territories differ from BFS\n", (unsigned long long)areaMismatches,
+			(unsigned long long)territoryMismatches);
+		return 1;
+	}
+	printf("OK: flood fills and territories match BFS\n");
+	return 0;
+}
+
+// Function to split a comma-separated list
+static vector<string> splitList(const char* text) {
+	vector<string> items;
+	string current;
+	for (const char* p = text; ; p++) {
+		if (*p == ',' || *p == '\0') {
+			if (!current.empty()) items.push_back(current);
+			current.clear();
+			if (*p == '\0') break;
+		} else {
+			current += *p;
+		}
+	}
+	return items;
+}
+
+// Function to run a rated tournament and print the table
+static int tournamentMain(int argc, char** argv) {
+	TournamentOptions options;
+	const char* analyticsPath = nullptr;
+	int nnBatch = 0;
+	double nnWait = 0.0001;
+	options.rules.simultaneous = true;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strcmp(arg, "--draw-at-cap") == 0) { options.limits.drawAtCap = true; continue; }
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--bots") == 0) options.bots = splitList(value);
+		else if (strcmp(arg, "--matches") == 0) options.matches = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--threads") == 0) options.threads = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) options.seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--ratings") == 0) options.ratingsPath = value;
+		else if (strcmp(arg, "--batch") == 0) options.batchSize = (size_t)max(1, atoi(value));
+		else if (strcmp(arg, "--stats") == 0) options.statsPath = value;
+		else if (strcmp(arg, "--analytics") == 0) analyticsPath = value;
+		else if (!parseLimit(arg, value, options.limits) && !parseBatching(arg, value, nnBatch, nnWait)) { printUsage(); return 2; }
+		i++;
+	}
+	enablePolicyBatching(nnBatch, nnWait);
+	for (const string& name : options.bots) {
+		if (!createBot(name, 0)) {
+			printf("Unknown bot '%s'\n", name.c_str());
+			return 2;
+		}
+	}
+	if (options.bots.size() < 2) {
+		printf("A tournament needs at least two bots\n");
+		return 2;
+	}
+
+	RatingTable table;
+	if (!options.ratingsPath.empty()) table.load(options.ratingsPath);
+	AnalyticsTotal analytics(options.rules.cellCount);
+	if (analyticsPath) options.analytics = &analytics;
+	TournamentReport report = runTournament(options, table);
+	printf("%llu matches (%llu ticks) in %.2f s, %llu rating batches\n", (unsigned long long)report.matches,
+		(unsigned long long)report.ticks, report.seconds, (unsigned long long)report.batches);
+	printBotTotals(stdout);
+	if (analyticsPath) {
+		const AnalyticsAccumulator& a = analytics.total;
+		printf("Analytics: %.1f ticks to food, power-up conversion %.1f%%, power-up leader wins %.1f%%\n",
+			a.averageTimeToFood(), 100.0 * a.powerupConversion(), 100.0 * a.powerupLeadWinRate());
+		if (!a.writeReport(analyticsPath)) printf("Could not write '%s'\n", analyticsPath);
+	}
+
+	vector<RatingEntry> sorted = table.entries;
+	sort(sorted.begin(), sorted.end(), [](const RatingEntry& a, const RatingEntry& b) { return a.elo > b.elo; });
+	printf("%-20s %8s %8s %6s %10s %8s %8s %8s\n", "bot", "elo", "glicko", "rd", "games", "wins", "losses", "draws");
+	for (const RatingEntry& e : sorted) {
+		printf("%-20s %8.1f %8.1f %6.1f %10lld %8lld %8lld %8lld\n", e.name.c_str(), e.elo, e.glicko, e.deviation,
+			e.games, e.wins, e.losses, e.draws);
+	}
+	return 0;
+}
+
+// Function to play a batch of matches and stream one result line per match
+static int batchMain(int argc, char** argv) {
+	BatchOptions options;
+	int threads = 0;
+	int board = 25;
+	const char* outPath = nullptr;
+	Rules tuning;  // Only the scoring and power-up fields are read from this
+	int nnBatch = 0;
+	double nnWait = 0.0001;
+	for (int i = 1; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strcmp(arg, "--draw-at-cap") == 0) { options.limits.drawAtCap = true; continue; }
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--matches") == 0) options.matches = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--threads") == 0) threads = atoi(value);
+		else if (strcmp(arg, "--bot1") == 0) options.bot1 = value;
+		else if (strcmp(arg, "--bot2") == 0) options.bot2 = value;
+		else if (strcmp(arg, "--seed") == 0) options.seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else if (strcmp(arg, "--out") == 0) outPath = value;
+		else if (strcmp(arg, "--food-score") == 0) tuning.foodScore = atoi(value);
+		else if (strcmp(arg, "--powerup-score") == 0) tuning.powerupScore = atoi(value);
+		else if (strcmp(arg, "--powerup-life") == 0) tuning.powerupLifetime = atoi(value);
+		else if (strcmp(arg, "--powerup-gap") == 0) {
+			tuning.powerupGapMin = tuning.powerupGapMax = atoi(value);
+			const char* comma = strchr(value, ',');
+			if (comma) tuning.powerupGapMax = atoi(comma + 1);
+		}
+		else if (strcmp(arg, "--format") == 0) {
+			if (strcmp(value, "csv") == 0) options.format = BATCH_CSV;
+			else if (strcmp(value, "json") == 0) options.format = BATCH_JSON;
+			else { printUsage(); return 2; }
+		}
+		else if (!parseLimit(arg, value, options.limits) && !parseBatching(arg, value, nnBatch, nnWait)) { printUsage(); return 2; }
+		i++;
+	}
+	enablePolicyBatching(nnBatch, nnWait);
+	if (!createBot(options.bot1, 0) || !createBot(options.bot2, 0)) {
+		printf("Unknown bot; available: ");
+		for (const string& name : builtinBotNames()) printf("%s ", name.c_str());
+		printf("\n");
+		return 2;
+	}
+	if (board < 8 || board > 4096 || tuning.powerupGapMin < 1 || tuning.powerupGapMax < tuning.powerupGapMin) {
+		printf("Board must be 8..4096 cells wide and the power-up gap must be MIN,MAX with 1 <= MIN <= MAX\n");
+		return 2;
+	}
+	options.rules = Rules::forBoard(board);
+	options.rules.simultaneous = true;
+	options.rules.foodScore = tuning.foodScore;
+	options.rules.powerupScore = tuning.powerupScore;
+	options.rules.powerupLifetime = tuning.powerupLifetime;
+	options.rules.powerupGapMin = tuning.powerupGapMin;
+	options.rules.powerupGapMax = tuning.powerupGapMax;
+
+	FILE* out = stdout;
+	if (outPath && !(out = fopen(outPath, "wb"))) {
+		printf("Cannot write '%s'\n", outPath);
+		return 1;
+	}
+	static char outBuffer[1 << 20];
+	setvbuf(out, outBuffer, _IOFBF, sizeof(outBuffer));
+	ThreadPool pool(threads);
+	BatchSummary summary = runBatch(options, pool, out);
+	if (out != stdout) fclose(out);
+	fprintf(stderr, "%llu matches (%llu ticks) in %.2f s on %d threads: %s %llu, %s %llu, draws %llu, unfinished %llu\n",
+		(unsigned long long)summary.matches, (unsigned long long)summary.ticks, summary.seconds, pool.size(),
+		options.bot1.c_str(), (unsigned long long)summary.outcomes[1], options.bot2.c_str(),
+		(unsigned long long)summary.outcomes[2], (unsigned long long)summary.outcomes[DRAW],
+		(unsigned long long)summary.outcomes[NO_WINNER]);
+	if (options.limits.adjudicateEvery > 0) fprintf(stderr, "%llu matches adjudicated\n", (unsigned long long)summary.adjudicated);
+	if (options.limits.repetitions > 0) fprintf(stderr, "%llu matches drawn by repetition\n", (unsigned long long)summary.repeated);
+	printBotTotals(stderr);
+	return 0;
+}
+
+// Function to parse a comma-separated list of integers
+static vector<int> splitInts(const char* text) {
+	vector<int> values;
+	for (const string& item : splitList(text)) values.push_back(atoi(item.c_str()));
+	return values;
+}
+
+// Function to sweep a grid of power-up and scoring rules and print win rates and score spreads
+static int sweepMain(int argc, char** argv) {
+	SweepOptions options;
+	int threads = 0;
+	int board = 25;
+	const char* outPath = nullptr;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strcmp(arg, "--draw-at-cap") == 0) { options.limits.drawAtCap = true; continue; }
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--bot1") == 0) options.bot1 = value;
+		else if (strcmp(arg, "--bot2") == 0) options.bot2 = value;
+		else if (strcmp(arg, "--matches") == 0) options.matches = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--threads") == 0) threads = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) options.seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else if (strcmp(arg, "--out") == 0) outPath = value;
+		else if (strcmp(arg, "--gap") == 0) options.powerupGaps = splitInts(value);
+		else if (strcmp(arg, "--gap-spread") == 0) options.powerupGapSpread = max(0, atoi(value));
+		else if (strcmp(arg, "--life") == 0) options.powerupLifetimes = splitInts(value);
+		else if (strcmp(arg, "--powerup-score") == 0) options.powerupScores = splitInts(value);
+		else if (strcmp(arg, "--food-score") == 0) options.foodScores = splitInts(value);
+		else if (!parseLimit(arg, value, options.limits)) { printUsage(); return 2; }
+		i++;
+	}
+	if (!createBot(options.bot1, 0) || !createBot(options.bot2, 0)) {
+		printf("Unknown bot\n");
+		return 2;
+	}
+	for (int gap : options.powerupGaps) {
+		if (gap < 1) { printf("Power-up gaps must be at least one tick\n"); return 2; }
+	}
+	if (board < 8 || board > 4096) { printf("Board must be 8..4096 cells wide\n"); return 2; }
+	options.base = Rules::forBoard(board);
+	options.base.simultaneous = true;
+
+	ThreadPool pool(threads);
+	auto startTime = chrono::steady_clock::now();
+	vector<SweepResult> results = runSweep(options, pool);
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+
+	FILE* csv = outPath ? fopen(outPath, "w") : nullptr;
+	if (outPath && !csv) printf("Cannot write '%s'\n", outPath);
+	if (csv) fprintf(csv, "gap_min,gap_max,lifetime,powerup_score,food_score,matches,win1,win2,draw,avg_ticks,"
+		"mean1,sd1,p10_1,p50_1,p90_1,mean2,sd2,p10_2,p50_2,p90_2\n");
+	printf("%-9s %5s %4s %4s %6s %6s %6s %7s %15s %15s\n", "gap", "life", "pu", "food", "win1", "win2", "draw",
+		"ticks", "score1 mean/p50", "score2 mean/p50");
+	for (const SweepResult& r : results) {
+		double n = (double)max<uint64_t>(r.matches, 1);
+		const Rules& rules = r.rules;
+		printf("%4d-%-4d %5d %4d %4d %5.1f%% %5.1f%% %5.1f%% %7.1f %9.1f/%-5d %9.1f/%-5d\n", rules.powerupGapMin,
+			rules.powerupGapMax, rules.powerupLifetime, rules.powerupScore, rules.foodScore, 100.0 * r.outcomes[1] / n,
+			100.0 * r.outcomes[2] / n, 100.0 * r.outcomes[DRAW] / n, r.averageTicks, r.score[0].mean, r.score[0].p50,
+			r.score[1].mean, r.score[1].p50);
+		if (csv) {
+			fprintf(csv, "%d,%d,%d,%d,%d,%llu,%.4f,%.4f,%.4f,%.2f", rules.powerupGapMin, rules.powerupGapMax,
+				rules.powerupLifetime, rules.powerupScore, rules.foodScore, (unsigned long long)r.matches,
+				r.outcomes[1] / n, r.outcomes[2] / n, r.outcomes[DRAW] / n, r.averageTicks);
+			for (const ScoreSummary& s : r.score) {
+				fprintf(csv, ",%.3f,%.3f,%d,%d,%d", s.mean, s.deviation, s.p10, s.p50, s.p90);
+			}
+			fputc('\n', csv);
+		}
+	}
+	if (csv) fclose(csv);
+	printf("%zu configurations x %llu matches (%s vs %s) in %.2f s on %d threads\n", results.size(),
+		(unsigned long long)options.matches, options.bot1.c_str(), options.bot2.c_str(), seconds, pool.size());
+	return 0;
+}
+
+// Function to play the minimax bot against another bot and report its search speed and move times
+static int searchMain(int argc, char** argv) {
+	int matches = 10;
+	double millis = 20;
+	string opponent = "roomy";
+	uint64_t seed = 1;
+	int board = 25;
+	bool sequential = false;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strcmp(arg, "--sequential") == 0) { sequential = true; continue; }
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--matches") == 0) matches = atoi(value);
+		else if (strcmp(arg, "--millis") == 0) millis = atof(value);
+		else if (strcmp(arg, "--opponent") == 0) opponent = value;
+		else if (strcmp(arg, "--seed") == 0) seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else { printUsage(); return 2; }
+		i++;
+	}
+	if (board < 10 || board > Bitboard::MAX_CELLS || matches < 1 || millis <= 0) {
+		printf("Board must be 10..%d cells wide, matches and millis positive\n", Bitboard::MAX_CELLS);
+		return 2;
+	}
+	if (!createBot(opponent, 0)) { printf("Unknown bot '%s'\n", opponent.c_str()); return 2; }
+
+	// The minimax bot plays the first snake in even matches and the second in odd ones
+	Rules rules = Rules::forBoard(board);
+	rules.simultaneous = !sequential;
+	MinimaxBot minimax(millis / 1000);
+	int wins = 0, losses = 0, draws = 0, unfinished = 0;
+	for (int m = 0; m < matches; m++) {
+		uint64_t matchSeed = mix64(seed ^ mix64((uint64_t)m));
+		unique_ptr<Bot> other = createBot(opponent, matchSeed ^ 2);
+		int side = m & 1;
+		MatchResult r = side == 0 ? playMatch(rules, minimax, *other, matchSeed, MatchLimits()) : playMatch(rules, *other, minimax, matchSeed, MatchLimits());
+		if (r.winner == side + 1) wins++;
+		else if (r.winner == 2 - side) losses++;
+		else if (r.winner == DRAW) draws++;
+		else unfinished++;
+	}
+
+	const SearchStats& s = minimax.stats;
+	printf("minimax (%.1f ms per move) vs %s: %d wins, %d losses, %d draws, %d unfinished\n", millis, opponent.c_str(), wins,
+		losses, draws, unfinished);
+	printf("%llu moves, average depth %.1f, %.2f M nodes/s, %.2f ms per move on average, longest %.2f ms\n",
+		(unsigned long long)s.moves, (double)s.depthSum / max<uint64_t>(s.moves, 1), s.nodes / max(s.seconds, 1e-9) / 1e6,
+		s.seconds * 1000 / max<uint64_t>(s.moves, 1), s.longestMove * 1000);
+	return 0;
+}
+
+// Function to train a neural-network policy by imitating a bot and write its weights file
+static int nnTrainMain(int argc, char** argv) {
+	string out;
+	string teacher = "roomy";
+	uint64_t samples = 200000;
+	int epochs = 4;
+	uint64_t seed = 1;
+	int board = 25;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--out") == 0) out = value;
+		else if (strcmp(arg, "--teacher") == 0) teacher = value;
+		else if (strcmp(arg, "--samples") == 0) samples = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--epochs") == 0) epochs = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else { printUsage(); return 2; }
+		i++;
+	}
+	if (out.empty() || board < 10 || board > 255 || samples == 0 || epochs < 1) {
+		printf("An output file is required, the board must be 10..255 cells wide, samples and epochs positive\n");
+		return 2;
+	}
+
+	auto startTime = chrono::steady_clock::now();
+	PolicySamples recorded;
+	if (!recordSamples(Rules::forBoard(board), teacher, samples, seed, recorded)) {
+		printf("Unknown bot '%s'\n", teacher.c_str());
+		return 2;
+	}
+	double recordSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	startTime = chrono::steady_clock::now();
+	PolicyNet net;
+	double accuracy = trainPolicy(recorded, epochs, seed, net);
+	double trainSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	if (!net.save(out)) {
+		printf("Cannot write '%s'\n", out.c_str());
+		return 1;
+	}
+	printf("%llu samples of %s recorded in %.1f s, %d epochs trained in %.1f s\n", (unsigned long long)recorded.size(),
+		teacher.c_str(), recordSeconds, epochs, trainSeconds);
+	printf("Quantized net agrees with the teacher on %.1f%% of samples; weights written to %s\n", accuracy * 100, out.c_str());
+	return 0;
+}
+
+// Function to check the policy's SIMD kernels against scalar code and time single and batched inference
+static int nnBenchMain(int argc, char** argv) {
+	string weights;
+	uint64_t positions = 20000;
+	uint64_t seed = 1;
+	int board = 25;
+	int batch = 64;
+	int clients = 64;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--weights") == 0) weights = value;
+		else if (strcmp(arg, "--positions") == 0) positions = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--batch") == 0) batch = atoi(value);
+		else if (strcmp(arg, "--clients") == 0) clients = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else { printUsage(); return 2; }
+		i++;
+	}
+	if (board < 10 || board > 255 || positions == 0 || batch < 1 || clients < 0) {
+		printf("Board must be 10..255 cells wide, positions and batch positive, clients not negative\n");
+		return 2;
+	}
+	shared_ptr<const PolicyNet> net = loadPolicy(weights);
+	if (!net) {
+		printf("Cannot load weights '%s'\n", weights.c_str());
+		return 1;
+	}
+
+	// Positions come from roomy-vs-roomy matches
+	PolicySamples recorded;
+	recordSamples(Rules::forBoard(board), "roomy", positions, seed, recorded);
+	size_t count = recorded.size();
+	const uint8_t* features = recorded.features.data();
+	vector<float> fast(count * PolicyNet::OUTPUTS), slow(count * PolicyNet::OUTPUTS);
+	net->evaluate(features, (int)count, fast.data());
+	net->evaluateScalar(features, (int)count, slow.data());
+	double maxDifference = 0;
+	size_t sameMove = 0;
+	for (size_t n = 0; n < count; n++) {
+		const float* a = &fast[n * PolicyNet::OUTPUTS];
+		const float* b = &slow[n * PolicyNet::OUTPUTS];
+		for (int o = 0; o < PolicyNet::OUTPUTS; o++) maxDifference = max(maxDifference, (double)fabs(a[o] - b[o]));
+		sameMove += max_element(a, a + PolicyNet::OUTPUTS) - a == max_element(b, b + PolicyNet::OUTPUTS) - b;
+	}
+
+	// Single inference includes writing the features from the engine, as a bot's move does
+	Engine engine(Rules::forBoard(board), seed);
+	alignas(64) uint8_t single[PolicyNet::INPUTS];
+	float logits[PolicyNet::OUTPUTS];
+	float checksum = 0;
+	uint64_t singleCalls = 0, batchedCalls = 0;
+	double singleSeconds = 0, batchedSeconds = 0;
+	auto startTime = chrono::steady_clock::now();
+	while (singleSeconds < 0.5) {
+		for (int k = 0; k < 1000; k++) {
+			PolicyNet::observe(engine, k & 1, single);
+			net->evaluate(single, 1, logits);
+			checksum += logits[0];
+		}
+		singleCalls += 1000;
+		singleSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	}
+	startTime = chrono::steady_clock::now();
+	while (batchedSeconds < 0.5) {
+		for (size_t first = 0; first < count; first += batch) {
+			int n = (int)min<size_t>(batch, count - first);
+			net->evaluate(features + first * PolicyNet::INPUTS, n, fast.data());
+			checksum += fast[0];
+		}
+		batchedCalls += count;
+		batchedSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	}
+
+	// Brokered inference: client threads each wait for one move at a time, like match threads
+	uint64_t brokeredCalls = 0, mismatches = 0;
+	double brokeredSeconds = 0;
+	BrokerStats brokerStats;
+	if (clients > 0) {
+		InferenceBroker broker(net, batch, 0.0001);
+		atomic<uint64_t> calls(0), wrong(0);
+		atomic<bool> stop(false);
+		auto client = [&](int id) {
+			float out[PolicyNet::OUTPUTS];
+			uint64_t local = 0, bad = 0;
+			for (size_t n = (size_t)id % count; !stop.load(memory_order_relaxed); n = (n + 1) % count, local++) {
+				broker.evaluate(features + n * PolicyNet::INPUTS, out);
+				bad += memcmp(out, &slow[n * PolicyNet::OUTPUTS], sizeof(out)) != 0;
+			}
+			calls.fetch_add(local);
+			wrong.fetch_add(bad);
+		};
+		startTime = chrono::steady_clock::now();
+		vector<thread> threads;
+		for (int c = 0; c < clients; c++) threads.emplace_back(client, c);
+		this_thread::sleep_for(chrono::milliseconds(500));
+		stop.store(true);
+		for (thread& t : threads) t.join();
+		brokeredSeconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+		brokeredCalls = calls.load();
+		mismatches = wrong.load();
+		brokerStats = broker.stats();
+	}
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+	const char* path = "AVX-512 VNNI";
+#elif defined(__AVX512BW__)
+	const char* path = "AVX-512BW";
+#elif defined(__AVX2__)
+	const char* path = "AVX2";
+#else
+	const char* path = "scalar";
+#endif
+	printf("%llu positions: SIMD and scalar logits differ by at most %g, same best move on %llu\n",
+		(unsigned long long)count, maxDifference, (unsigned long long)sameMove);
+	printf("%s kernels: single %.2f us per move (with features), batches of %d %.0f k inferences/s (checksum %g)\n", path,
+		singleSeconds * 1e6 / singleCalls, batch, batchedCalls / batchedSeconds / 1000, checksum);
+	if (clients > 0) {
+		printf("Broker with %d client threads: %.0f k inferences/s, %.1f per batch, %llu results differ from scalar\n", clients,
+			brokeredCalls / brokeredSeconds / 1000, (double)brokerStats.requests / max<uint64_t>(brokerStats.batches, 1),
+			(unsigned long long)mismatches);
+	}
+	return sameMove == count && mismatches == 0 ? 0 : 1;
+}
+
+// Function to assemble a bot program and time it on positions from roomy-vs-roomy matches
+static int vmMain(int argc, char** argv) {
+	if (argc < 3) { printUsage(); return 2; }
+	const char* path = argv[2];
+	size_t positions = 1000;
+	int budget = VMBot::DEFAULT_BUDGET;
+	uint64_t seed = 1;
+	int board = 25;
+	for (int i = 3; i < argc; i++) {
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--positions") == 0) positions = (size_t)strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--budget") == 0) budget = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else { printUsage(); return 2; }
+		i++;
+	}
+	if (board < 10 || board > 255 || positions == 0 || budget < 1) {
+		printf("Board must be 10..255 cells wide, positions and budget positive\n");
+		return 2;
+	}
+	shared_ptr<const VMProgram> program = loadProgram(path);
+	if (!program) {
+		printf("Cannot load '%s'\n", path);
+		return 1;
+	}
+
+	// Keep a copy of the engine at every tick of roomy-vs-roomy matches
+	Rules rules = Rules::forBoard(board);
+	rules.simultaneous = true;
+	vector<Engine> samples;
+	samples.reserve(positions);
+	for (uint64_t match = 0; samples.size() < positions; match++) {
+		uint64_t matchSeed = mix64(seed ^ mix64(match));
+		Engine engine(rules, matchSeed);
+		unique_ptr<Bot> bots[2] = { createBot("roomy", matchSeed ^ 1), createBot("roomy", matchSeed ^ 2) };
+		while (engine.running && engine.tick < 5000 && samples.size() < positions) {
+			samples.push_back(engine);
+			for (int s = 0; s < 2; s++) engine.setDirection(s, bots[s]->chooseMove(engine, s));
+			engine.update();
+		}
+	}
+
+	int32_t memory[VMProgram::MEMORY] = {};
+	uint64_t moves = 0, instructions = 0, exhausted = 0;
+	double seconds = 0;
+	auto startTime = chrono::steady_clock::now();
+	while (seconds < 0.5) {
+		for (size_t n = 0; n < samples.size(); n++) {
+			int executed;
+			exhausted += program->run(samples[n], (int)(n & 1), memory, budget, executed) == -2;
+			instructions += executed;
+		}
+		moves += samples.size();
+		seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	}
+#if defined(__GNUC__)
+	const char* dispatch = "computed goto";
+#else
+	const char* dispatch = "switch";
+#endif
+	printf("%s: %zu instructions, %.1f executed per move on average, %llu of %llu moves ran out of a %d budget\n", path,
+		program->code.size(), (double)instructions / moves, (unsigned long long)exhausted, (unsigned long long)moves, budget);
+	printf("%s dispatch: %.0f ns per move, %.2f M moves/s, %.0f M instructions/s\n", dispatch, seconds * 1e9 / moves,
+		moves / seconds / 1e6, instructions / seconds / 1e6);
+	return 0;
+}
+
+// Function to solve the tablebase of a small board, and to grade a bot's moves against a tablebase
+static int tablebaseMain(int argc, char** argv) {
+	string out, in, grade;
+	int board = 6;
+	int maxLength = 4;
+	int threads = 0;
+	int matches = 1000;
+	uint64_t seed = 1;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--out") == 0) out = value;
+		else if (strcmp(arg, "--in") == 0) in = value;
+		else if (strcmp(arg, "--grade") == 0) grade = value;
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else if (strcmp(arg, "--max-length") == 0) maxLength = atoi(value);
+		else if (strcmp(arg, "--threads") == 0) threads = atoi(value);
+		else if (strcmp(arg, "--matches") == 0) matches = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) seed = strtoull(value, nullptr, 10);
+		else { printUsage(); return 2; }
+		i++;
+	}
+	if (out.empty() == in.empty() || (!in.empty() && grade.empty()) || matches < 1) {
+		printf("Give either --out to solve a tablebase or --in with --grade to grade a bot, and a positive match count\n");
+		return 2;
+	}
+
+	if (!out.empty()) {
+		ThreadPool pool(threads);
+		vector<TablebaseTableStats> stats;
+		string error;
+		auto startTime = chrono::steady_clock::now();
+		if (!Tablebase::build(board, maxLength, pool, out, stats, error)) {
+			printf("Cannot build the tablebase: %s\n", error.c_str());
+			return 1;
+		}
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+		uint64_t legal = 0, bytes = 0;
+		for (const TablebaseTableStats& s : stats) {
+			printf("Length %d vs %d: %llu legal of %llu positions, %.1f%% won (longest %d ticks), %.1f%% lost (longest %d ticks), %.1f KB\n",
+				s.lengths[0], s.lengths[1], (unsigned long long)s.legal, (unsigned long long)s.positions, 100.0 * s.wins / s.legal,
+				s.longestWin, 100.0 * s.losses / s.legal, s.longestLoss, s.bytes / 1024.0);
+			legal += s.legal;
+			bytes += s.bytes;
+		}
+		printf("%dx%d board, lengths %d..%d: %llu positions solved in %.1f s on %d threads, %s holds %.1f MB (%.2f bytes per position)\n",
+			board, board, Tablebase::MIN_LENGTH, maxLength, (unsigned long long)legal, seconds, pool.size(), out.c_str(),
+			bytes / 1048576.0, (double)bytes / legal);
+		return 0;
+	}
+
+	// Play the bot against itself on the tablebase's board and grade every move the tables cover
+	shared_ptr<const Tablebase> tablebase = loadTablebase(in);
+	if (!tablebase) return 1;
+	Rules rules = Rules::forBoard(tablebase->board());
+	rules.simultaneous = true;
+	uint64_t moves = 0, covered = 0, optimal = 0, slower = 0, thrownWins = 0, thrownDraws = 0;
+	for (int match = 0; match < matches; match++) {
+		uint64_t matchSeed = mix64(seed ^ mix64((uint64_t)match));
+		Engine engine(rules, matchSeed);
+		unique_ptr<Bot> bots[2] = { createBot(grade, matchSeed ^ 1), createBot(grade, matchSeed ^ 2) };
+		if (!bots[0] || !bots[1]) {
+			printf("Unknown bot '%s'\n", grade.c_str());
+			return 2;
+		}
+		while (engine.running && engine.tick < 5000) {
+			Dir chosen[2];
+			for (int s = 0; s < 2; s++) {
+				chosen[s] = bots[s]->chooseMove(engine, s);
+				moves++;
+				Dir best;
+				TablebaseValue bestValue, value;
+				if (!tablebase->bestMove(engine, s, best, bestValue)) continue;
+				tablebase->evaluate(engine, s, chosen[s], value);
+				covered++;
+				if (value.result == bestValue.result) {
+					optimal += value.distance == bestValue.distance;
+					slower += value.distance != bestValue.distance;
+				} else {
+					thrownWins += bestValue.result > 0;
+					thrownDraws += bestValue.result == 0;
+				}
+			}
+			for (int s = 0; s < 2; s++) engine.setDirection(s, chosen[s]);
+			engine.update();
+		}
+	}
+	printf("%s on %dx%d: %llu of %llu moves covered by the tablebase, %.2f%% of them optimal, %llu won more slowly or lost faster,\n",
+		grade.c_str(), rules.cellCount, rules.cellCount, (unsigned long long)covered, (unsigned long long)moves,
+		covered ? 100.0 * optimal / covered : 0.0, (unsigned long long)slower);
+	printf("%llu threw away a forced win, %llu turned a safe draw into a loss\n", (unsigned long long)thrownWins,
+		(unsigned long long)thrownDraws);
+	return 0;
+}
+
+// Function to check that a bot name reaches --tournament (split on ',') and --batch (a CSV field) unchanged
+static bool passesBotLists(const string& name) {
+	vector<string> items = splitList(name.c_str());
+	return items.size() == 1 && items[0] == name && name.find_first_of(",\"\r\n") == string::npos && createBot(name, 0);
+}
+
+// Function to evolve the weighted bot's weights against an opponent, checkpointing every generation
+static int tuneMain(int argc, char** argv) {
+	TunerOptions options;
+	options.limits.drawAtCap = true;  // A match both bots survive is not a loss for either
+	string checkpoint;
+	bool resume = false;
+	int threads = 0;
+	int board = 25;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strcmp(arg, "--resume") == 0) { resume = true; continue; }
+		if (strcmp(arg, "--draw-at-cap") == 0) continue;  // Already the default here
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--checkpoint") == 0) checkpoint = value;
+		else if (strcmp(arg, "--population") == 0) options.population = atoi(value);
+		else if (strcmp(arg, "--generations") == 0) options.generations = atoi(value);
+		else if (strcmp(arg, "--matches") == 0) options.matches = atoi(value);
+		else if (strcmp(arg, "--opponent") == 0) options.opponent = value;
+		else if (strcmp(arg, "--elite") == 0) options.elite = atoi(value);
+		else if (strcmp(arg, "--mutation") == 0) options.mutation = atof(value);
+		else if (strcmp(arg, "--threads") == 0) threads = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) options.seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else if (!parseLimit(arg, value, options.limits)) { printUsage(); return 2; }
+		i++;
+	}
+	if (checkpoint.empty() || options.population < 2 || options.matches < 2 || options.generations < 1) {
+		printf("Give a --checkpoint file, a population and a match count of at least two and at least one generation\n");
+		return 2;
+	}
+	if ((uint64_t)options.population * options.matches > 0x7fffffff) { printf("Too many matches per generation\n"); return 2; }
+	if (!createBot(options.opponent, 0)) {
+		printf("Unknown bot '%s'\n", options.opponent.c_str());
+		return 2;
+	}
+	if (board < 8 || board > Bitboard::MAX_CELLS) { printf("Board must be 8..%d cells wide\n", Bitboard::MAX_CELLS); return 2; }
+	options.rules = Rules::forBoard(board);
+	options.rules.simultaneous = true;
+
+	TunerState state;
+	if (resume) {
+		if (!loadCheckpoint(checkpoint, state)) {
+			printf("Cannot resume from '%s'\n", checkpoint.c_str());
+			return 1;
+		}
+		options.seed = state.seed;  // The run's own seed, so it breeds what it would have bred
+		printf("Resuming after generation %d of %d\n", state.generation, options.generations);
+	} else {
+		state = initialPopulation(options);
+	}
+
+	ThreadPool pool(threads);
+	auto startTime = chrono::steady_clock::now();
+	uint64_t played = 0;
+	while (state.generation < options.generations) {
+		auto generationStart = chrono::steady_clock::now();
+		if (state.generation > 0) state.population = breed(state, options);
+		evaluatePopulation(state, options, pool);
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - generationStart).count();
+		uint64_t matches = (uint64_t)state.population.size() * options.matches;
+		played += matches;
+		if (!saveCheckpoint(state, checkpoint)) {
+			printf("Cannot write '%s'\n", checkpoint.c_str());
+			return 1;
+		}
+		const TunerIndividual& best = state.population[0];
+		double mean = 0;
+		for (const TunerIndividual& individual : state.population) mean += individual.fitness();
+		mean /= state.population.size();
+		printf("Generation %3d: best %5.1f%% (%llu-%llu-%llu, margin %+.1f), mean %5.1f%%, %.0f matches/s, %s\n",
+			state.generation, 100 * best.fitness(), (unsigned long long)best.wins, (unsigned long long)best.draws,
+			(unsigned long long)best.losses, (double)best.margin / options.matches, 100 * mean, matches / seconds,
+			best.weights.botName().c_str());
+		fflush(stdout);
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	string bestName = state.population[0].weights.botName();
+	printf("%llu matches against %s in %.1f s on %d threads; best so far: %s\n", (unsigned long long)played,
+		options.opponent.c_str(), seconds, pool.size(), bestName.c_str());
+	if (!passesBotLists(bestName)) {
+		printf("'%s' cannot be passed to --bots or --bot1 as it is\n", bestName.c_str());
+		return 1;
+	}
+	return 0;
+}
+
+// Function to record self-play matches into training-data shards, or to decode and summarize shards
+static int selfPlayMain(int argc, char** argv) {
+	SelfPlayOptions options;
+	vector<string> inputs;
+	bool haveOut = false;
+	int threads = 0;
+	int board = 25;
+	for (int i = 2; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strcmp(arg, "--draw-at-cap") == 0) { options.limits.drawAtCap = true; continue; }
+		if (strcmp(arg, "--in") == 0) {
+			while (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) inputs.push_back(argv[++i]);
+			continue;
+		}
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--out") == 0) { options.prefix = value; haveOut = true; }
+		else if (strcmp(arg, "--bot") == 0) options.bot = value;
+		else if (strcmp(arg, "--matches") == 0) options.matches = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--threads") == 0) threads = atoi(value);
+		else if (strcmp(arg, "--seed") == 0) options.seed = strtoull(value, nullptr, 10);
+		else if (strcmp(arg, "--board") == 0) board = atoi(value);
+		else if (strcmp(arg, "--shard-kb") == 0) options.shardBytes = (uint32_t)atoi(value) * 1024;
+		else if (!parseLimit(arg, value, options.limits)) { printUsage(); return 2; }
+		i++;
+	}
+	if (haveOut == !inputs.empty()) {
+		printf("Give either --out to record shards or --in with shard files to read\n");
+		return 2;
+	}
+
+	if (!inputs.empty()) {
+		// Decode every position, so a damaged shard is found, and count what the shards hold
+		uint64_t matches = 0, positions = 0, payload = 0, outcomes[4] = { 0, 0, 0, 0 };
+		double lengths = 0;
+		int n = 0;
+		for (const string& path : inputs) {
+			ShardReader reader;
+			string error;
+			if (!reader.open(path, error)) {
+				printf("Cannot read %s\n", error.c_str());
+				return 1;
+			}
+			uint64_t seed, shardMatches = 0, shardPositions = 0;
+			int winner;
+			uint32_t count;
+			SelfPlayPosition position;
+			while (reader.nextMatch(seed, winner, count)) {
+				shardMatches++;
+				outcomes[winner & 3]++;
+				while (reader.nextPosition(position)) {
+					shardPositions++;
+					lengths += position.planes[PLANE_BODY1].count() + position.planes[PLANE_BODY2].count();
+				}
+			}
+			if (!reader.error().empty() || shardMatches != reader.header().matches || shardPositions != reader.header().positions) {
+				printf("%s is damaged%s%s\n", path.c_str(), reader.error().empty() ? "" : ": ", reader.error().c_str());
+				return 1;
+			}
+			matches += shardMatches;
+			positions += shardPositions;
+			payload += reader.header().payloadBytes;
+			n = (int)reader.header().board;
+		}
+		double packed = (PLANE_COUNT * n * n + 7) / 8 + 1;
+		printf("%zu shards on a %dx%d board: %llu matches (%llu won by the first snake, %llu by the second, %llu drawn, %llu unfinished)\n",
+			inputs.size(), n, n, (unsigned long long)matches, (unsigned long long)outcomes[1], (unsigned long long)outcomes[2],
+			(unsigned long long)outcomes[DRAW], (unsigned long long)outcomes[NO_WINNER]);
+		printf("%llu positions (%llu samples), average length %.1f, %.2f bytes per position (%.0fx smaller than bit-packed planes)\n",
+			(unsigned long long)positions, (unsigned long long)positions * 2, positions ? lengths / positions / 2 : 0.0,
+			positions ? (double)payload / positions : 0.0, payload ? packed * positions / payload : 0.0);
+		return 0;
+	}
+
+	if (board < 8 || board > Bitboard::MAX_CELLS) { printf("Board must be 8..%d cells wide\n", Bitboard::MAX_CELLS); return 2; }
+	if (options.shardBytes < 4096 || options.shardBytes > (1u << 30)) { printf("Shards must be 4..1048576 KB\n"); return 2; }
+	options.rules = Rules::forBoard(board);
+	options.rules.simultaneous = true;
+	ThreadPool pool(threads);
+	ShardWriterStats stats;
+	string error;
+	auto startTime = chrono::steady_clock::now();
+	if (!runSelfPlay(options, pool, stats, error)) {
+		printf("Self-play failed: %s\n", error.c_str());
+		return 1;
+	}
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	printf("%llu matches of %s, %llu positions (%llu samples) in %.2f s on %d threads (%.0f samples/s)\n",
+		(unsigned long long)stats.matches, options.bot.c_str(), (unsigned long long)stats.positions,
+		(unsigned long long)stats.positions * 2, seconds, pool.size(), stats.positions * 2 / seconds);
+	printf("%llu shards of %u KB (%s-00000.shard ...), %.2f bytes per position, %llu matches dropped as too large\n",
+		(unsigned long long)stats.shards, options.shardBytes / 1024, options.prefix.c_str(),
+		stats.positions ? (double)stats.payloadBytes / stats.positions : 0.0, (unsigned long long)stats.dropped);
+	printf("Workers waited for the writer %llu times, %.3f s in total\n", (unsigned long long)stats.stalls, stats.stallSeconds);
+	return 0;
+}
+
+// Function to convert a YYYY-MM-DD date to days since 1970-01-01 (proleptic Gregorian)
+static bool parseDay(const char* text, int32_t& day) {
+	int y, m, d;
+	if (sscanf(text, "%d-%d-%d", &y, &m, &d) != 3 || m < 1 || m > 12 || d < 1 || d > 31) return false;
+	y -= m <= 2;
+	int era = (y >= 0 ? y : y - 399) / 400;
+	int yearOfEra = y - era * 400;
+	int dayOfYear = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	day = era * 146097 + dayOfEra - 719468;
+	return true;
+}
+
+// Function to query (or reindex) a match statistics log
+static int statsMain(int argc, char** argv) {
+	if (argc < 3) { printUsage(); return 2; }
+	const char* path = argv[2];
+	size_t top = 10;
+	bool byDay = false, byPlayer = false, reindex = false;
+	int32_t day = 0;
+	string player;
+	for (int i = 3; i < argc; i++) {
+		const char* arg = argv[i];
+		if (strcmp(arg, "--reindex") == 0) { reindex = true; continue; }
+		const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+		if (!value) { printUsage(); return 2; }
+		if (strcmp(arg, "--top") == 0) top = (size_t)max(1, atoi(value));
+		else if (strcmp(arg, "--day") == 0) {
+			if (!parseDay(value, day)) { printf("Bad date '%s'\n", value); return 2; }
+			byDay = true;
+		}
+		else if (strcmp(arg, "--player") == 0) { player = value; byPlayer = true; }
+		else { printUsage(); return 2; }
+		i++;
+	}
+
+	auto startTime = chrono::steady_clock::now();
+	StatsStore stats;
+	if (!stats.open(path)) {
+		printf("Cannot open statistics log '%s'\n", path);
+		return 1;
+	}
+	double openMs = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+	printf("%llu records (%llu indexed), opened in %.1f ms\n", (unsigned long long)stats.recordCount(),
+		(unsigned long long)stats.indexedRecords(), openMs);
+	if (reindex) {
+		if (!stats.writeIndex()) { printf("Could not write the index\n"); return 1; }
+		printf("Index rewritten\n");
+	}
+
+	vector<ScoreEntry> best = byDay ? stats.topScoresOnDay(day, top) : byPlayer ? stats.topScoresForPlayer(player, top) : stats.topScores(top);
+	for (const ScoreEntry& e : best) {
+		MatchRecord record;
+		if (!stats.readRecord(e.record, record)) continue;
+		int side = (int)e.side;
+		printf("%6d  %-16s vs %-16s  record %u, %d ticks, length %d, %s, %s\n", e.score,
+			record.playerName(side).c_str(), record.playerName(1 - side).c_str(), e.record, record.durationTicks,
+			record.length[side], record.winner == side + 1 ? "won" : record.winner == DRAW ? "draw" : "lost",
+			deathCauseName(record.deathCause[side]));
+	}
+	return 0;
+}
+
+// Main function dispatching to the selected mode
+int main(int argc, char** argv) {
+	if (argc >= 2 && strcmp(argv[1], "--golden-master") == 0) return goldenMasterMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--arena") == 0) return arenaMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--tournament") == 0) return tournamentMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--stats") == 0) return statsMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--sweep") == 0) return sweepMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--bitsliced") == 0) return bitslicedMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--flood") == 0) return floodMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--search") == 0) return searchMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--nn-train") == 0) return nnTrainMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--nn-bench") == 0) return nnBenchMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--vm") == 0) return vmMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--tablebase") == 0) return tablebaseMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--tune") == 0) return tuneMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--selfplay") == 0) return selfPlayMain(argc, argv);
+	if (argc >= 2 && strcmp(argv[1], "--help") != 0) return batchMain(argc, argv);
+	printUsage();
+	return 2;
+}
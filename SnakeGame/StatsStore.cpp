@@ -0,0 +1,391 @@
+#include "StatsStore.h"
+#include <algorithm>     // For sort and min
+#include <cstdio>        // For snprintf
+#include <cstring>       // For memcpy and memcmp
+#ifdef _WIN32
+#include <io.h>          // For _chsize_s, _commit and _fileno
+#else
+#include <unistd.h>      // For ftruncate and fsync
+#endif
+using namespace std;
+
+static_assert(sizeof(MatchRecord) == 160, "MatchRecord is stored as raw 160-byte records");
+static_assert(sizeof(ScoreEntry) == 12, "ScoreEntry is mapped directly from the index file");
+
+static const char LOG_MAGIC[8] = { 'S', 'N', 'A', 'K', 'E', 'L', 'O', 'G' };
+static const char INDEX_MAGIC[8] = { 'S', 'N', 'A', 'K', 'E', 'I', 'D', 'X' };
+static const uint32_t RECORD_MAGIC = 0x52434d53;  // "SMCR"
+static const int64_t LOG_HEADER_SIZE = 16;
+static const int64_t RECORD_SIZE = 4 + (int64_t)sizeof(MatchRecord) + 4;
+
+struct IndexHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t lastRecordCrc;   // Checksum of the last covered record (detects a replaced log)
+	uint64_t coveredRecords;  // Records included in the index
+	uint32_t overallStart;
+	uint32_t overallCount;
+	uint32_t dayCount;
+	uint32_t playerCount;
+	uint32_t entryCount;
+	uint32_t reserved;
+};
+
+struct DayDirectoryEntry {
+	int32_t day;
+	uint32_t start;
+	uint32_t count;
+};
+
+struct PlayerDirectoryEntry {
+	char name[MatchRecord::NAME_BYTES];
+	uint32_t start;
+	uint32_t count;
+};
+
+// Function to compute a CRC-32 (IEEE) checksum
+static uint32_t crc32(const void* data, size_t size) {
+	struct Table {
+		uint32_t entries[256];
+		Table() {
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t c = i;
+				for (int k = 0; k < 8; k++) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+				entries[i] = c;
+			}
+		}
+	};
+	static const Table table;  // Built once, safely even if several threads make the first call
+	uint32_t crc = 0xffffffffu;
+	const unsigned char* p = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) crc = table.entries[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+	return crc ^ 0xffffffffu;
+}
+
+// Function to order entries best score first (ties: older record first)
+static bool betterEntry(const ScoreEntry& a, const ScoreEntry& b) {
+	if (a.score != b.score) return a.score > b.score;
+	if (a.record != b.record) return a.record < b.record;
+	return a.side < b.side;
+}
+
+// Function to seek with 64-bit offsets (logs grow past 2 GB)
+static bool seekTo(FILE* file, int64_t offset, int origin) {
+#ifdef _WIN32
+	return _fseeki64(file, offset, origin) == 0;
+#else
+	return fseeko(file, (off_t)offset, origin) == 0;
+#endif
+}
+
+// Function to get the 64-bit file position
+static int64_t tellPosition(FILE* file) {
+#ifdef _WIN32
+	return _ftelli64(file);
+#else
+	return (int64_t)ftello(file);
+#endif
+}
+
+// Function to seek to the start of a record
+static bool seekRecord(FILE* file, uint64_t number) {
+	return seekTo(file, LOG_HEADER_SIZE + (int64_t)number * RECORD_SIZE, SEEK_SET);
+}
+
+// Function to cut a file back to a given size after a torn write
+static bool truncateFile(FILE* file, int64_t size) {
+	fflush(file);
+#ifdef _WIN32
+	return _chsize_s(_fileno(file), size) == 0;
+#else
+	return ftruncate(fileno(file), (off_t)size) == 0;
+#endif
+}
+
+string MatchRecord::playerKey(const string& name) {
+	if (name.size() <= (size_t)NAME_BYTES) return name;
+	uint64_t hash = 0xcbf29ce484222325ULL;  // FNV-1a over the whole name
+	for (unsigned char c : name) hash = (hash ^ c) * 0x100000001b3ULL;
+	char tail[18];
+	snprintf(tail, sizeof(tail), "~%016llx", (unsigned long long)mix64(hash));
+	return name.substr(0, NAME_BYTES - 17) + tail;
+}
+
+void MatchRecord::setPlayer(int side, const string& name) {
+	string key = playerKey(name);
+	memset(player[side], 0, sizeof(player[side]));
+	memcpy(player[side], key.c_str(), key.size());
+}
+
+string MatchRecord::playerName(int side) const {
+	size_t n = 0;
+	while (n < sizeof(player[side]) && player[side][n]) n++;
+	return string(player[side], n);
+}
+
+bool StatsStore::open(const string& path) {
+	close();
+	logPath = path;
+	indexPath = path + ".idx";
+	log = fopen(path.c_str(), "r+b");
+	if (!log) {
+		log = fopen(path.c_str(), "w+b");
+		if (!log) return false;
+		char header[LOG_HEADER_SIZE] = {};
+		memcpy(header, LOG_MAGIC, sizeof(LOG_MAGIC));
+		header[8] = 1;  // Version
+		if (fwrite(header, 1, sizeof(header), log) != sizeof(header) || fflush(log) != 0) return false;
+	}
+
+	char header[LOG_HEADER_SIZE];
+	if (!seekTo(log, 0, SEEK_SET) || fread(header, 1, sizeof(header), log) != sizeof(header) ||
+		memcmp(header, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+		close();
+		return false;
+	}
+	seekTo(log, 0, SEEK_END);
+	int64_t fileSize = tellPosition(log);
+	records = (uint64_t)(fileSize - LOG_HEADER_SIZE) / RECORD_SIZE;
+
+	if (!loadIndex()) {
+		index.close();
+		indexed = 0;
+	}
+
+	// Parse only the records the index does not cover, stopping at the first torn or corrupt one
+	uint64_t valid = indexed;
+	seekRecord(log, indexed);
+	unsigned char buffer[RECORD_SIZE];
+	for (uint64_t n = indexed; n < records; n++) {
+		if (fread(buffer, 1, RECORD_SIZE, log) != (size_t)RECORD_SIZE) break;
+		uint32_t magic, crc;
+		memcpy(&magic, buffer, 4);
+		memcpy(&crc, buffer + 4 + sizeof(MatchRecord), 4);
+		if (magic != RECORD_MAGIC || crc != crc32(buffer + 4, sizeof(MatchRecord))) break;
+		MatchRecord record;
+		memcpy(&record, buffer + 4, sizeof(MatchRecord));
+		addToDelta(record, (uint32_t)n);
+		valid = n + 1;
+	}
+	int64_t validSize = LOG_HEADER_SIZE + (int64_t)valid * RECORD_SIZE;
+	if (validSize != fileSize) truncateFile(log, validSize);
+	records = valid;
+	seekTo(log, 0, SEEK_END);
+	return true;
+}
+
+void StatsStore::close() {
+	if (log) {
+		fflush(log);
+		fclose(log);
+		log = nullptr;
+	}
+	index.close();
+	mappedEntries = nullptr;
+	mappedOverall = GroupRef{ 0, 0 };
+	mappedDays.clear();
+	mappedPlayers.clear();
+	deltaOverall.clear();
+	deltaDays.clear();
+	deltaPlayers.clear();
+	records = indexed = 0;
+}
+
+// Function to map the index file and check that it still describes this log
+bool StatsStore::loadIndex() {
+	if (!index.open(indexPath) || index.size() < sizeof(IndexHeader)) return false;
+	IndexHeader header;
+	memcpy(&header, index.data(), sizeof(header));
+	if (memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || header.version != 1) return false;
+	size_t expected = sizeof(IndexHeader) + header.dayCount * sizeof(DayDirectoryEntry) +
+		header.playerCount * sizeof(PlayerDirectoryEntry) + (size_t)header.entryCount * sizeof(ScoreEntry);
+	if (index.size() != expected || header.coveredRecords > records) return false;
+	if (header.coveredRecords > 0) {
+		MatchRecord last;
+		unsigned char buffer[RECORD_SIZE];
+		seekRecord(log, header.coveredRecords - 1);
+		if (fread(buffer, 1, RECORD_SIZE, log) != (size_t)RECORD_SIZE) return false;
+		memcpy(&last, buffer + 4, sizeof(last));
+		if (crc32(&last, sizeof(last)) != header.lastRecordCrc) return false;
+	}
+
+	const unsigned char* p = index.data() + sizeof(IndexHeader);
+	for (uint32_t i = 0; i < header.dayCount; i++, p += sizeof(DayDirectoryEntry)) {
+		DayDirectoryEntry entry;
+		memcpy(&entry, p, sizeof(entry));
+		mappedDays[entry.day] = GroupRef{ entry.start, entry.count };
+	}
+	for (uint32_t i = 0; i < header.playerCount; i++, p += sizeof(PlayerDirectoryEntry)) {
+		PlayerDirectoryEntry entry;
+		memcpy(&entry, p, sizeof(entry));
+		size_t n = 0;
+		while (n < sizeof(entry.name) && entry.name[n]) n++;
+		mappedPlayers[string(entry.name, n)] = GroupRef{ entry.start, entry.count };
+	}
+	mappedEntries = (const ScoreEntry*)p;
+	mappedOverall = GroupRef{ header.overallStart, header.overallCount };
+	indexed = header.coveredRecords;
+	return true;
+}
+
+// Function to add both sides of a record to the in-memory groups
+void StatsStore::addToDelta(const MatchRecord& record, uint32_t number) {
+	for (uint32_t side = 0; side < 2; side++) {
+		ScoreEntry entry = { record.score[side], number, side };
+		deltaOverall.push_back(entry);
+		deltaDays[record.day()].push_back(entry);
+		deltaPlayers[record.playerName(side)].push_back(entry);
+	}
+}
+
+bool StatsStore::append(const MatchRecord& record) {
+	if (!log) return false;
+	unsigned char buffer[RECORD_SIZE];
+	uint32_t crc = crc32(&record, sizeof(record));
+	memcpy(buffer, &RECORD_MAGIC, 4);
+	memcpy(buffer + 4, &record, sizeof(record));
+	memcpy(buffer + 4 + sizeof(record), &crc, 4);
+	if (fwrite(buffer, 1, RECORD_SIZE, log) != (size_t)RECORD_SIZE) return false;
+	addToDelta(record, (uint32_t)records);
+	records++;
+	return true;
+}
+
+bool StatsStore::sync() {
+	if (!log || fflush(log) != 0) return false;
+#ifdef _WIN32
+	return _commit(_fileno(log)) == 0;
+#else
+	return fsync(fileno(log)) == 0;
+#endif
+}
+
+bool StatsStore::readRecord(uint64_t number, MatchRecord& record) {
+	if (!log || number >= records) return false;
+	unsigned char buffer[RECORD_SIZE];
+	fflush(log);
+	seekRecord(log, number);
+	bool ok = fread(buffer, 1, RECORD_SIZE, log) == (size_t)RECORD_SIZE;
+	seekTo(log, 0, SEEK_END);
+	if (!ok) return false;
+	memcpy(&record, buffer + 4, sizeof(record));
+	return true;
+}
+
+// Function to merge the best n entries of a mapped group and a delta group
+vector<ScoreEntry> StatsStore::mergeTop(const GroupRef* mapped, const vector<ScoreEntry>* delta, size_t n) const {
+	vector<ScoreEntry> result;
+	if (mapped) {
+		size_t take = min((size_t)mapped->count, n);  // Mapped groups are already sorted
+		result.insert(result.end(), mappedEntries + mapped->start, mappedEntries + mapped->start + take);
+	}
+	if (delta) result.insert(result.end(), delta->begin(), delta->end());
+	size_t keep = min(n, result.size());
+	partial_sort(result.begin(), result.begin() + keep, result.end(), betterEntry);
+	result.resize(keep);
+	return result;
+}
+
+vector<ScoreEntry> StatsStore::topScores(size_t n) const {
+	return mergeTop(mappedEntries ? &mappedOverall : nullptr, &deltaOverall, n);
+}
+
+vector<ScoreEntry> StatsStore::topScoresOnDay(int32_t day, size_t n) const {
+	auto mapped = mappedDays.find(day);
+	auto delta = deltaDays.find(day);
+	return mergeTop(mapped != mappedDays.end() ? &mapped->second : nullptr,
+		delta != deltaDays.end() ? &delta->second : nullptr, n);
+}
+
+vector<ScoreEntry> StatsStore::topScoresForPlayer(const string& name, size_t n) const {
+	string key = MatchRecord::playerKey(name);
+	auto mapped = mappedPlayers.find(key);
+	auto delta = deltaPlayers.find(key);
+	return mergeTop(mapped != mappedPlayers.end() ? &mapped->second : nullptr,
+		delta != deltaPlayers.end() ? &delta->second : nullptr, n);
+}
+
+bool StatsStore::writeIndex() {
+	if (!log) return false;
+	// Full groups = mapped groups + delta groups, each sorted best first
+	vector<ScoreEntry> overall = deltaOverall;
+	map<int32_t, vector<ScoreEntry>> days = deltaDays;
+	map<string, vector<ScoreEntry>> players = deltaPlayers;
+	if (mappedEntries) {
+		overall.insert(overall.end(), mappedEntries + mappedOverall.start, mappedEntries + mappedOverall.start + mappedOverall.count);
+		for (const auto& d : mappedDays) {
+			days[d.first].insert(days[d.first].end(), mappedEntries + d.second.start, mappedEntries + d.second.start + d.second.count);
+		}
+		for (const auto& p : mappedPlayers) {
+			players[p.first].insert(players[p.first].end(), mappedEntries + p.second.start, mappedEntries + p.second.start + p.second.count);
+		}
+	}
+
+	IndexHeader header = {};
+	memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	header.version = 1;
+	header.coveredRecords = records;
+	if (records > 0) {
+		MatchRecord last;
+		if (!readRecord(records - 1, last)) return false;
+		header.lastRecordCrc = crc32(&last, sizeof(last));
+	}
+	vector<ScoreEntry> entries;
+	vector<DayDirectoryEntry> dayDirectory;
+	vector<PlayerDirectoryEntry> playerDirectory;
+	auto addGroup = [&](vector<ScoreEntry>& group, uint32_t& start, uint32_t& count) {
+		sort(group.begin(), group.end(), betterEntry);
+		start = (uint32_t)entries.size();
+		count = (uint32_t)group.size();
+		entries.insert(entries.end(), group.begin(), group.end());
+	};
+	addGroup(overall, header.overallStart, header.overallCount);
+	for (auto& d : days) {
+		DayDirectoryEntry entry = { d.first, 0, 0 };
+		addGroup(d.second, entry.start, entry.count);
+		dayDirectory.push_back(entry);
+	}
+	for (auto& p : players) {
+		PlayerDirectoryEntry entry = {};
+		memcpy(entry.name, p.first.c_str(), min(p.first.size(), sizeof(entry.name)));
+		addGroup(p.second, entry.start, entry.count);
+		playerDirectory.push_back(entry);
+	}
+	header.dayCount = (uint32_t)dayDirectory.size();
+	header.playerCount = (uint32_t)playerDirectory.size();
+	header.entryCount = (uint32_t)entries.size();
+
+	string temporary = indexPath + ".tmp";
+	FILE* out = fopen(temporary.c_str(), "wb");
+	if (!out) return false;
+	bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+	if (!dayDirectory.empty()) ok = ok && fwrite(dayDirectory.data(), sizeof(DayDirectoryEntry), dayDirectory.size(), out) == dayDirectory.size();
+	if (!playerDirectory.empty()) ok = ok && fwrite(playerDirectory.data(), sizeof(PlayerDirectoryEntry), playerDirectory.size(), out) == playerDirectory.size();
+	if (!entries.empty()) ok = ok && fwrite(entries.data(), sizeof(ScoreEntry), entries.size(), out) == entries.size();
+	ok = fclose(out) == 0 && ok;
+	if (!ok) {
+		remove(temporary.c_str());
+		return false;
+	}
+
+	// Swap the new index in and drop the delta it now covers
+	index.close();
+	mappedEntries = nullptr;
+	mappedDays.clear();
+	mappedPlayers.clear();
+	bool renamed = rename(temporary.c_str(), indexPath.c_str()) == 0;
+	if (!renamed) {
+		remove(indexPath.c_str());  // Windows will not rename over an existing file
+		renamed = rename(temporary.c_str(), indexPath.c_str()) == 0;
+	}
+	deltaOverall.clear();
+	deltaDays.clear();
+	deltaPlayers.clear();
+	if (!renamed || !loadIndex()) {
+		string path = logPath;
+		open(path);  // Rebuild the in-memory state from whatever is on disk
+		return false;
+	}
+	seekTo(log, 0, SEEK_END);
+	return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+// Persistent match statistics: an append-only log of fixed-size, checksummed records plus a
+// memory-mapped index for top-N score queries overall, per UTC day and per player.
+//
+// Log file:   16-byte header, then records of { magic, MatchRecord, crc32 } (168 bytes each).
+//             A crash can only leave a partial or corrupt last record, which open() cuts off.
+// Index file: <log>.idx, written by writeIndex(). It covers the first N records and holds
+//             score-sorted entry groups with directories for days and players. open() maps it
+//             and only parses the log records written after it, so startup does not reparse
+//             millions of records. Records appended since then live in a small in-memory delta.
+#include <cstdint>       // For fixed-width integer types
+#include <cstdio>        // For the log file handle
+#include <map>           // For the in-memory delta groups
+#include <string>        // For paths and player names
+#include <vector>        // For query results
+#include "MappedFile.h"
+#include "SimCore.h"
+
+// One finished match (160 bytes on disk)
+struct MatchRecord {
+	static const int NAME_BYTES = 64;  // Stored bytes per player name
+	int64_t timestamp = 0;       // Unix time the match ended
+	int32_t durationTicks = 0;   // Ticks played
+	int32_t score[2] = { 0, 0 }; // Final scores
+	int32_t length[2] = { 0, 0 };// Final lengths
+	uint8_t winner = 0;          // 1, 2, DRAW or NO_WINNER
+	uint8_t deathCause[2] = { 0, 0 };  // DeathCause of each snake
+	uint8_t reserved = 0;
+	char player[2][NAME_BYTES] = {};  // Player or bot names (see playerKey, zero-padded)
+
+	// Function to get the stored form of a name: the name itself if it fits, else its first bytes,
+	// '~' and a hash of the whole name, so long names stay distinct
+	static std::string playerKey(const std::string& name);
+
+	void setPlayer(int side, const std::string& name);
+	std::string playerName(int side) const;
+	int32_t day() const { return (int32_t)(timestamp >= 0 ? timestamp / 86400 : (timestamp - 86399) / 86400); }
+};
+
+// One score in the index: which record and which side of it
+struct ScoreEntry {
+	int32_t score;
+	uint32_t record;
+	uint32_t side;
+};
+
+class StatsStore {
+public:
+	StatsStore() {}
+	~StatsStore() { close(); }
+
+	StatsStore(const StatsStore&) = delete;
+	StatsStore& operator=(const StatsStore&) = delete;
+
+	bool open(const std::string& logPath);     // Open or create the log and load the index
+	void close();                              // Flush and close (does not rewrite the index)
+	bool append(const MatchRecord& record);    // Append one record (buffered)
+	bool sync();                               // Flush buffered records to the operating system
+	bool writeIndex();                         // Rebuild the index over every record and remap it
+
+	uint64_t recordCount() const { return records; }
+	uint64_t indexedRecords() const { return indexed; }
+	bool readRecord(uint64_t number, MatchRecord& record);
+
+	std::vector<ScoreEntry> topScores(size_t n) const;
+	std::vector<ScoreEntry> topScoresOnDay(int32_t day, size_t n) const;
+	std::vector<ScoreEntry> topScoresForPlayer(const std::string& name, size_t n) const;
+
+private:
+	struct GroupRef {
+		uint32_t start;  // First entry in the mapped index
+		uint32_t count;  // Entries in the group
+	};
+
+	std::string logPath;
+	std::string indexPath;
+	FILE* log = nullptr;
+	uint64_t records = 0;       // Valid records in the log
+	uint64_t indexed = 0;       // Records covered by the mapped index
+	MappedFile index;           // Mapped index file
+	const ScoreEntry* mappedEntries = nullptr;
+	GroupRef mappedOverall = { 0, 0 };
+	std::map<int32_t, GroupRef> mappedDays;
+	std::map<std::string, GroupRef> mappedPlayers;
+
+	std::vector<ScoreEntry> deltaOverall;                      // Records after the index
+	std::map<int32_t, std::vector<ScoreEntry>> deltaDays;
+	std::map<std::string, std::vector<ScoreEntry>> deltaPlayers;
+
+	bool loadIndex();
+	void addToDelta(const MatchRecord& record, uint32_t number);
+	std::vector<ScoreEntry> mergeTop(const GroupRef* mapped, const std::vector<ScoreEntry>* delta, size_t n) const;
+};
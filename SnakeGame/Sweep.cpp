@@ -0,0 +1,127 @@
+#include "Sweep.h"
+#include <algorithm>     // For min
+#include <cmath>         // For sqrt
+#include <memory>        // For the bots
+#include "Bot.h"
+#include "Match.h"
+using namespace std;
+
+const int SCORE_BINS = 1024;  // Scores at or above the last bin are counted in it
+
+// Per-worker tallies for one configuration
+struct SweepTally {
+	uint64_t matches = 0;
+	uint64_t outcomes[4] = { 0, 0, 0, 0 };
+	uint64_t ticks = 0;
+	double sum[2] = { 0, 0 };
+	double squares[2] = { 0, 0 };
+	vector<uint32_t> histogram[2];  // Matches per score
+
+	void clear() {
+		matches = ticks = 0;
+		for (uint64_t& n : outcomes) n = 0;
+		for (int i = 0; i < 2; i++) {
+			sum[i] = squares[i] = 0;
+			histogram[i].assign(SCORE_BINS, 0);
+		}
+	}
+};
+
+// Function to expand the grid into a list of rules (an empty axis keeps the base value)
+static vector<Rules> expandGrid(const SweepOptions& options) {
+	const Rules& base = options.base;
+	vector<int> gaps = options.powerupGaps.empty() ? vector<int>{ base.powerupGapMin } : options.powerupGaps;
+	vector<int> lifetimes = options.powerupLifetimes.empty() ? vector<int>{ base.powerupLifetime } : options.powerupLifetimes;
+	vector<int> powerups = options.powerupScores.empty() ? vector<int>{ base.powerupScore } : options.powerupScores;
+	vector<int> foods = options.foodScores.empty() ? vector<int>{ base.foodScore } : options.foodScores;
+	int spread = options.powerupGaps.empty() ? base.powerupGapMax - base.powerupGapMin : options.powerupGapSpread;
+	vector<Rules> grid;
+	for (int gap : gaps) {
+		for (int lifetime : lifetimes) {
+			for (int powerup : powerups) {
+				for (int food : foods) {
+					Rules rules = base;
+					rules.powerupGapMin = gap;
+					rules.powerupGapMax = gap + spread;
+					rules.powerupLifetime = lifetime;
+					rules.powerupScore = powerup;
+					rules.foodScore = food;
+					grid.push_back(rules);
+				}
+			}
+		}
+	}
+	return grid;
+}
+
+// Function to read a percentile off a score histogram
+static int percentile(const vector<uint32_t>& histogram, uint64_t total, double fraction) {
+	uint64_t rank = (uint64_t)(fraction * (total - 1));
+	uint64_t seen = 0;
+	for (int score = 0; score < (int)histogram.size(); score++) {
+		seen += histogram[score];
+		if (seen > rank) return score;
+	}
+	return (int)histogram.size() - 1;
+}
+
+vector<SweepResult> runSweep(const SweepOptions& options, ThreadPool& pool) {
+	vector<SweepResult> results;
+	vector<Rules> grid = expandGrid(options);
+	vector<Engine> engines(pool.size(), Engine(options.base, 0));  // One pooled engine per worker
+	vector<SweepTally> tallies(pool.size());
+	int count = (int)min<uint64_t>(options.matches, 0x7fffffff);
+
+	for (const Rules& rules : grid) {
+		for (SweepTally& tally : tallies) tally.clear();
+		pool.parallelFor(count, [&](int begin, int end, int worker) {
+			Engine& engine = engines[worker];
+			SweepTally& tally = tallies[worker];
+			for (int i = begin; i < end; i++) {
+				uint64_t seed = mix64(options.seed ^ mix64((uint64_t)i));  // Same seeds in every configuration
+				unique_ptr<Bot> bot1 = createBot(options.bot1, seed ^ 1);
+				unique_ptr<Bot> bot2 = createBot(options.bot2, seed ^ 2);
+				MatchResult r = playMatch(engine, rules, *bot1, *bot2, seed, options.limits);
+				tally.matches++;
+				tally.outcomes[r.winner & 3]++;
+				tally.ticks += r.ticks;
+				for (int s = 0; s < 2; s++) {
+					tally.sum[s] += r.score[s];
+					tally.squares[s] += (double)r.score[s] * r.score[s];
+					tally.histogram[s][min(max(r.score[s], 0), SCORE_BINS - 1)]++;
+				}
+			}
+		});
+
+		SweepTally total;
+		total.clear();
+		for (const SweepTally& tally : tallies) {
+			total.matches += tally.matches;
+			total.ticks += tally.ticks;
+			for (int i = 0; i < 4; i++) total.outcomes[i] += tally.outcomes[i];
+			for (int s = 0; s < 2; s++) {
+				total.sum[s] += tally.sum[s];
+				total.squares[s] += tally.squares[s];
+				for (int b = 0; b < SCORE_BINS; b++) total.histogram[s][b] += tally.histogram[s][b];
+			}
+		}
+
+		SweepResult result;
+		result.rules = rules;
+		result.matches = total.matches;
+		for (int i = 0; i < 4; i++) result.outcomes[i] = total.outcomes[i];
+		if (total.matches > 0) {
+			result.averageTicks = (double)total.ticks / total.matches;
+			for (int s = 0; s < 2; s++) {
+				ScoreSummary& score = result.score[s];
+				score.mean = total.sum[s] / total.matches;
+				score.deviation = sqrt(max(0.0, total.squares[s] / total.matches - score.mean * score.mean));
+				score.p10 = percentile(total.histogram[s], total.matches, 0.1);
+				score.p50 = percentile(total.histogram[s], total.matches, 0.5);
+				score.p90 = percentile(total.histogram[s], total.matches, 0.9);
+			}
+		}
+		results.push_back(result);
+	}
+	return results;
+}
@@ -0,0 +1,42 @@
+#pragma once
+// Parameter sweeps for power-up and scoring balance. Every configuration in the grid plays the same
+// seeded matches (common random numbers, so differences come from the rules and not the seeds) on a
+// thread pool. Each worker keeps one pooled Engine that is restarted for every match of every
+// configuration instead of being reallocated.
+#include <cstdint>       // For fixed-width integer types
+#include <string>        // For bot names
+#include <vector>        // For the parameter grid and the results
+#include "Match.h"
+#include "ThreadPool.h"
+
+struct SweepOptions {
+	std::string bot1 = "greedy";          // Bot on the first snake
+	std::string bot2 = "cautious";        // Bot on the second snake
+	uint64_t matches = 2000;              // Matches per configuration
+	uint64_t seed = 1;                    // Master seed shared by every configuration
+	MatchLimits limits;                   // Tick cap, adjudication and repetition draws per match
+	Rules base;                           // Rules the grid values are applied to
+	std::vector<int> powerupGaps;         // Minimum ticks between power-ups (empty = base only)
+	int powerupGapSpread = 5;             // Maximum gap is the minimum plus this
+	std::vector<int> powerupLifetimes;    // Ticks a power-up stays visible
+	std::vector<int> powerupScores;       // Points for a power-up
+	std::vector<int> foodScores;          // Points for food
+};
+
+// Score distribution of one snake over a configuration's matches
+struct ScoreSummary {
+	double mean = 0;
+	double deviation = 0;
+	int p10 = 0, p50 = 0, p90 = 0;  // Percentiles
+};
+
+struct SweepResult {
+	Rules rules;                          // The configuration
+	uint64_t matches = 0;
+	uint64_t outcomes[4] = { 0, 0, 0, 0 };// Indexed by winner: NO_WINNER, 1, 2, DRAW
+	double averageTicks = 0;
+	ScoreSummary score[2];                // Per snake
+};
+
+// Function to run every configuration of the grid and return one result per configuration
+std::vector<SweepResult> runSweep(const SweepOptions& options, ThreadPool& pool);
@@ -0,0 +1,549 @@
+#include "Tablebase.h"
+#include <algorithm>     // For min and max
+#include <atomic>        // For the values and work flags shared by the solver threads
+#include <cstdio>        // For writing the file
+#include <cstring>       // For memcpy and memcmp
+#include <map>           // For the opened files
+#include <mutex>         // For the opened files
+using namespace std;
+
+static const char TABLEBASE_MAGIC[8] = { 'S', 'N', 'A', 'K', 'E', 'T', 'B', 'L' };
+static const uint64_t MAX_TABLE_POSITIONS = 1ull << 31;  // Keeps the solver's flag words countable in an int
+
+// Value bytes: 0 draw, N a win in N ticks, LOSS_BIT | N a loss in N ticks
+static const uint8_t LOSS_BIT = 0x80;
+
+// Outcomes of one tick for the snake to move
+enum TickOutcome { BOTH_LIVE, I_CRASH, THEY_CRASH, BOTH_CRASH };
+
+struct TablebaseHeader {
+	char magic[8];
+	uint32_t version;
+	int32_t board;
+	int32_t maxLength;
+	uint32_t tableCount;  // One per pair of lengths, the snake to move's length varying slowest
+};
+
+// A table is stored as two levels of bitmaps. A block covers 64 positions and only blocks with a
+// decided position are stored: a bitmap of those positions and the index of the first one's value.
+// A group covers 64 blocks with a bitmap of the stored ones and the index of the first one.
+struct TablebaseDirectoryEntry {
+	int32_t lengths[2];
+	uint64_t positions;
+	uint64_t groupOffset;   // Group bitmaps (8 bytes each), then their first block indexes (4 bytes each)
+	uint64_t blockCount;    // Stored blocks
+	uint64_t blockOffset;   // Block bitmaps (8 bytes each), then their first value indexes (4 bytes each)
+	uint64_t valueCount;
+	uint64_t valueOffset;   // One byte per decided position
+};
+
+// Bitmaps of one level, each with the number of set bits before it
+struct RankedBitmaps {
+	vector<uint64_t> bits;
+	vector<uint32_t> starts;
+
+	// Function to get the size in the file, padded to 8 bytes
+	uint64_t bytes() const { return (bits.size() * (sizeof(uint64_t) + sizeof(uint32_t)) + 7) & ~7ull; }
+
+	// Function to append the level to a file
+	bool write(FILE* out) const {
+		static const char padding[8] = {};
+		size_t unpadded = bits.size() * (sizeof(uint64_t) + sizeof(uint32_t));
+		return fwrite(bits.data(), sizeof(uint64_t), bits.size(), out) == bits.size() &&
+			fwrite(starts.data(), sizeof(uint32_t), starts.size(), out) == starts.size() &&
+			fwrite(padding, 1, bytes() - unpadded, out) == bytes() - unpadded;
+	}
+};
+
+// Every way to lay a body of one length on the board, by shape index
+struct Tablebase::Shapes {
+	int length = 0;
+	int turnCodes = 0;              // 3^(length - 2)
+	int count = 0;                  // cells * 4 * turnCodes
+	vector<uint64_t> mask;          // Cells of each shape, 0 if it leaves the board or crosses itself
+	vector<uint64_t> body;          // The cells without the tail: what a head cannot enter after a move
+	vector<int8_t> next;            // [3 * shape + turn] head cell after turning (straight, right, left), -1 off the board
+	vector<int32_t> successor;      // [3 * shape + turn] shape after the move, -1 off the board
+	vector<int32_t> predecessor;    // [3 * shape + tail] legal shapes that move into this one, -1 if none
+
+	// Function to enumerate the shapes of a length
+	void build(int board, int bodyLength) {
+		length = bodyLength;
+		turnCodes = 1;
+		for (int i = 2; i < length; i++) turnCodes *= 3;
+		count = board * board * 4 * turnCodes;
+		mask.assign(count, 0);
+		body.assign(count, 0);
+		next.assign(3 * (size_t)count, -1);
+		successor.assign(3 * (size_t)count, -1);
+		predecessor.assign(3 * (size_t)count, -1);
+		for (int shape = 0; shape < count; shape++) {
+			int code = shape % turnCodes;
+			Dir direction = (Dir)(shape / turnCodes % 4);
+			int head = shape / turnCodes / 4;
+			Cell c = Cell{ head % board, head / board };
+			uint64_t cells = 1ull << head;
+			Dir d = direction;
+			bool legal = true;
+			for (int i = 1; i < length && legal; i++) {
+				c = stepCell(c, oppositeDir(d));  // Segment i lies behind segment i - 1
+				int index = c.y * board + c.x;
+				legal = c.x >= 0 && c.x < board && c.y >= 0 && c.y < board && !(cells >> index & 1);
+				if (legal) cells |= 1ull << index;
+				d = (Dir)((d - turnDelta(code % 3)) & 3);
+				code /= 3;
+			}
+			if (!legal) continue;
+			mask[shape] = cells;
+			body[shape] = cells & ~(1ull << (c.y * board + c.x));
+			for (int turn = 0; turn < 3; turn++) {
+				Dir moved = (Dir)((direction + turnDelta(turn)) & 3);
+				Cell n = stepCell(Cell{ head % board, head / board }, moved);
+				if (n.x < 0 || n.x >= board || n.y < 0 || n.y >= board) continue;
+				int cell = n.y * board + n.x;
+				next[3 * shape + turn] = (int8_t)cell;
+				successor[3 * shape + turn] = (cell * 4 + moved) * turnCodes + (shape % turnCodes * 3 + turn) % turnCodes;
+			}
+		}
+		// A predecessor has its head on this shape's neck and one more tail segment in any direction
+		for (int shape = 0; shape < count; shape++) {
+			if (!mask[shape]) continue;
+			int code = shape % turnCodes;
+			Dir direction = (Dir)(shape / turnCodes % 4);
+			int head = shape / turnCodes / 4;
+			Cell neck = stepCell(Cell{ head % board, head / board }, oppositeDir(direction));
+			Dir before = (Dir)((direction - turnDelta(code % 3)) & 3);
+			for (int tail = 0; tail < 3; tail++) {
+				int previous = ((neck.y * board + neck.x) * 4 + before) * turnCodes + code / 3 + tail * (turnCodes / 3);
+				if (mask[previous]) predecessor[3 * shape + tail] = previous;
+			}
+		}
+	}
+
+	// Function to get the direction change of a turn digit (straight, right, left)
+	static int turnDelta(int turn) { return turn == 2 ? 3 : turn; }
+
+	// Function to resolve one tick: my shape `mine` turning `myTurn`, theirs turning `theirTurn`
+	static TickOutcome tick(const Shapes& me, int mine, int myTurn, const Shapes& them, int theirs, int theirTurn) {
+		int myHead = me.next[3 * mine + myTurn];
+		int theirHead = them.next[3 * theirs + theirTurn];
+		uint64_t blocked = me.body[mine] | them.body[theirs];
+		bool iCrash = myHead < 0 || (blocked >> myHead & 1);
+		bool theyCrash = theirHead < 0 || (blocked >> theirHead & 1);
+		if (myHead >= 0 && myHead == theirHead) iCrash = theyCrash = true;  // Head-on
+		return iCrash ? (theyCrash ? BOTH_CRASH : I_CRASH) : (theyCrash ? THEY_CRASH : BOTH_LIVE);
+	}
+
+	// Function to solve the table of `me` moving against `them` into values (one byte per position)
+	static bool solve(const Shapes& me, const Shapes& them, ThreadPool& pool, vector<atomic<uint8_t>>& values, string& error) {
+		uint64_t positions = (uint64_t)me.count * them.count;
+		int words = (int)((positions + 63) / 64);
+		vector<atomic<uint64_t>> pending(words), nextPending(words);  // Positions to look at in this pass and the next
+
+		// The first pass looks at every legal position
+		for (int mine = 0; mine < me.count; mine++) {
+			if (!me.mask[mine]) continue;
+			for (int theirs = 0; theirs < them.count; theirs++) {
+				if (!them.mask[theirs] || (me.mask[mine] & them.mask[theirs])) continue;
+				uint64_t p = (uint64_t)mine * them.count + theirs;
+				pending[p >> 6].store(pending[p >> 6].load(memory_order_relaxed) | 1ull << (p & 63), memory_order_relaxed);
+			}
+		}
+
+		// Pass k resolves the positions won or lost in exactly k ticks: it only trusts values resolved
+		// in earlier passes, so positions resolved by other threads in this pass never count
+		for (int pass = 1; ; pass++) {
+			atomic<uint64_t> resolved(0);
+			pool.parallelFor(words, [&](int begin, int end, int) {
+				uint64_t count = 0;
+				for (int word = begin; word < end; word++) {
+					uint64_t bits = pending[word].load(memory_order_relaxed);
+					while (bits) {
+						uint64_t p = (uint64_t)word * 64 + lowestBit(bits);
+						bits &= bits - 1;
+						if (values[p].load(memory_order_relaxed)) continue;
+						int mine = (int)(p / them.count), theirs = (int)(p % them.count);
+						uint8_t value = 0;
+						bool lost = true;
+						for (int myTurn = 0; myTurn < 3 && !value; myTurn++) {
+							bool won = true, losing = false;
+							for (int theirTurn = 0; theirTurn < 3; theirTurn++) {
+								TickOutcome outcome = tick(me, mine, myTurn, them, theirs, theirTurn);
+								if (outcome == BOTH_LIVE) {
+									uint64_t q = (uint64_t)me.successor[3 * mine + myTurn] * them.count + them.successor[3 * theirs + theirTurn];
+									uint8_t v = values[q].load(memory_order_relaxed);
+									bool known = v && (v & ~LOSS_BIT) < pass;
+									won = won && known && !(v & LOSS_BIT);
+									losing = losing || (known && (v & LOSS_BIT));
+								} else {
+									won = won && outcome == THEY_CRASH;
+									losing = losing || outcome == I_CRASH;
+								}
+							}
+							if (won) value = (uint8_t)pass;
+							lost = lost && losing;
+						}
+						if (!value && lost) value = (uint8_t)(LOSS_BIT | pass);
+						if (!value) continue;
+						values[p].store(value, memory_order_relaxed);
+						count++;
+
+						// Positions that can move here may be decided in the next pass
+						for (int myTail = 0; myTail < 3; myTail++) {
+							int before = me.predecessor[3 * mine + myTail];
+							if (before < 0) continue;
+							for (int theirTail = 0; theirTail < 3; theirTail++) {
+								int theirsBefore = them.predecessor[3 * theirs + theirTail];
+								if (theirsBefore < 0 || (me.mask[before] & them.mask[theirsBefore])) continue;
+								uint64_t q = (uint64_t)before * them.count + theirsBefore;
+								nextPending[q >> 6].fetch_or(1ull << (q & 63), memory_order_relaxed);
+							}
+						}
+					}
+				}
+				resolved.fetch_add(count, memory_order_relaxed);
+			});
+			if (resolved.load() == 0) return true;
+			if (pass == Tablebase::MAX_DISTANCE) {
+				error = "a position takes more than " + to_string(Tablebase::MAX_DISTANCE) + " ticks to decide";
+				return false;
+			}
+			for (int word = 0; word < words; word++) {
+				pending[word].store(nextPending[word].load(memory_order_relaxed), memory_order_relaxed);
+				nextPending[word].store(0, memory_order_relaxed);
+			}
+		}
+	}
+};
+
+// One table of an opened file
+struct Tablebase::Table {
+	int stride = 0;                          // Opponent shapes per row
+	const uint64_t* groupBits = nullptr;     // Per 64 blocks: which ones are stored
+	const uint32_t* groupStarts = nullptr;   // Per 64 blocks: index of the first stored one
+	const uint64_t* blockBits = nullptr;     // Per stored block: which of its 64 positions are decided
+	const uint32_t* blockStarts = nullptr;   // Per stored block: index of its first value
+	const uint8_t* values = nullptr;
+};
+
+Tablebase::Tablebase() {}
+
+Tablebase::~Tablebase() {}
+
+bool Tablebase::build(int board, int maxLength, ThreadPool& pool, const string& path, vector<TablebaseTableStats>& stats, string& error) {
+	stats.clear();
+	if (board < 3 || board > MAX_BOARD || maxLength < MIN_LENGTH || maxLength > board * board / 2) {
+		error = "boards must be 3.." + to_string(MAX_BOARD) + " cells wide and lengths " + to_string(MIN_LENGTH) + " up to half the board";
+		return false;
+	}
+	vector<Shapes> all(maxLength - MIN_LENGTH + 1);
+	for (size_t i = 0; i < all.size(); i++) all[i].build(board, MIN_LENGTH + (int)i);
+	if ((uint64_t)all.back().count * all.back().count > MAX_TABLE_POSITIONS) {
+		error = "tables of more than 2^31 positions are not supported";
+		return false;
+	}
+
+	// Solve each pair of lengths and pack it into groups and blocks
+	struct Packed {
+		TablebaseDirectoryEntry entry;
+		RankedBitmaps groups;
+		RankedBitmaps blocks;
+		vector<uint8_t> values;
+	};
+	vector<Packed> packed;
+	for (const Shapes& me : all) {
+		for (const Shapes& them : all) {
+			uint64_t positions = (uint64_t)me.count * them.count;
+			vector<atomic<uint8_t>> values(positions);
+			if (!Shapes::solve(me, them, pool, values, error)) return false;
+
+			TablebaseTableStats s;
+			s.lengths[0] = me.length;
+			s.lengths[1] = them.length;
+			s.positions = positions;
+			Packed table;
+			table.entry = TablebaseDirectoryEntry{ { me.length, them.length }, positions, 0, 0, 0, 0, 0 };
+			uint64_t blockCount = (positions + 63) / 64;
+			table.groups.bits.assign((blockCount + 63) / 64, 0);
+			table.groups.starts.assign(table.groups.bits.size(), 0);
+			for (uint64_t block = 0; block < blockCount; block++) {
+				if (block % 64 == 0) table.groups.starts[block / 64] = (uint32_t)table.blocks.bits.size();
+				uint64_t bits = 0;
+				uint32_t start = (uint32_t)table.values.size();
+				for (uint64_t p = block * 64; p < min(positions, block * 64 + 64); p++) {
+					uint64_t mine = me.mask[p / them.count], theirs = them.mask[p % them.count];
+					s.legal += mine && theirs && !(mine & theirs);
+					uint8_t v = values[p].load(memory_order_relaxed);
+					if (!v) continue;
+					bits |= 1ull << (p % 64);
+					table.values.push_back(v);
+					int distance = v & ~LOSS_BIT;
+					if (v & LOSS_BIT) {
+						s.losses++;
+						s.longestLoss = max(s.longestLoss, distance);
+					} else {
+						s.wins++;
+						s.longestWin = max(s.longestWin, distance);
+					}
+				}
+				if (!bits) continue;
+				table.groups.bits[block / 64] |= 1ull << (block % 64);
+				table.blocks.bits.push_back(bits);
+				table.blocks.starts.push_back(start);
+			}
+			table.entry.blockCount = table.blocks.bits.size();
+			table.entry.valueCount = table.values.size();
+			s.bytes = table.groups.bytes() + table.blocks.bytes() + ((table.values.size() + 7) & ~7ull);
+			stats.push_back(s);
+			packed.push_back(move(table));
+		}
+	}
+
+	// Lay the tables out after the directory, each part aligned to 8 bytes so it can be mapped in place
+	TablebaseHeader header = {};
+	memcpy(header.magic, TABLEBASE_MAGIC, sizeof(TABLEBASE_MAGIC));
+	header.version = 1;
+	header.board = board;
+	header.maxLength = maxLength;
+	header.tableCount = (uint32_t)packed.size();
+	uint64_t offset = sizeof(header) + packed.size() * sizeof(TablebaseDirectoryEntry);
+	for (Packed& table : packed) {
+		table.entry.groupOffset = offset;
+		offset += table.groups.bytes();
+		table.entry.blockOffset = offset;
+		offset += table.blocks.bytes();
+		table.entry.valueOffset = offset;
+		offset += (table.values.size() + 7) & ~7ull;
+	}
+
+	string temporary = path + ".tmp";
+	FILE* out = fopen(temporary.c_str(), "wb");
+	if (!out) {
+		error = "cannot write " + temporary;
+		return false;
+	}
+	static const char padding[8] = {};
+	bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+	for (const Packed& table : packed) ok = ok && fwrite(&table.entry, sizeof(table.entry), 1, out) == 1;
+	for (const Packed& table : packed) {
+		ok = ok && table.groups.write(out) && table.blocks.write(out);
+		if (!table.values.empty()) ok = ok && fwrite(table.values.data(), 1, table.values.size(), out) == table.values.size();
+		size_t written = table.values.size() % 8;
+		if (written) ok = ok && fwrite(padding, 1, 8 - written, out) == 8 - written;
+	}
+	ok = fclose(out) == 0 && ok;
+	bool renamed = ok && rename(temporary.c_str(), path.c_str()) == 0;
+	if (ok && !renamed) {
+		remove(path.c_str());  // Windows will not rename over an existing file
+		renamed = rename(temporary.c_str(), path.c_str()) == 0;
+	}
+	if (!renamed) {
+		remove(temporary.c_str());
+		error = "cannot write " + path;
+		return false;
+	}
+	return true;
+}
+
+bool Tablebase::open(const string& path) {
+	tables.clear();
+	shapes.clear();
+	if (!file.open(path) || file.size() < sizeof(TablebaseHeader)) return false;
+	TablebaseHeader header;
+	memcpy(&header, file.data(), sizeof(header));
+	int lengths = header.maxLength - MIN_LENGTH + 1;
+	if (memcmp(header.magic, TABLEBASE_MAGIC, sizeof(TABLEBASE_MAGIC)) != 0 || header.version != 1 || header.board < 3 ||
+		header.board > MAX_BOARD || lengths < 1 || header.maxLength > header.board * header.board / 2 ||
+		header.tableCount != (uint32_t)(lengths * lengths) ||
+		file.size() < sizeof(header) + header.tableCount * sizeof(TablebaseDirectoryEntry)) {
+		file.close();
+		return false;
+	}
+	cellCount = header.board;
+	longest = header.maxLength;
+	shapes.resize(lengths);
+	for (int i = 0; i < lengths; i++) shapes[i].build(cellCount, MIN_LENGTH + i);
+	tables.resize(header.tableCount);
+	for (uint32_t i = 0; i < header.tableCount; i++) {
+		TablebaseDirectoryEntry entry;
+		memcpy(&entry, file.data() + sizeof(header) + i * sizeof(entry), sizeof(entry));
+		const Shapes& me = shapes[i / lengths];
+		const Shapes& them = shapes[i % lengths];
+		uint64_t groups = ((entry.positions + 63) / 64 + 63) / 64;
+		bool valid = entry.lengths[0] == me.length && entry.lengths[1] == them.length &&
+			entry.positions == (uint64_t)me.count * them.count && entry.groupOffset % 8 == 0 && entry.blockOffset % 8 == 0 &&
+			entry.groupOffset + groups * (sizeof(uint64_t) + sizeof(uint32_t)) <= entry.blockOffset &&
+			entry.blockOffset + entry.blockCount * (sizeof(uint64_t) + sizeof(uint32_t)) <= entry.valueOffset &&
+			entry.valueOffset + entry.valueCount <= file.size();
+		if (!valid) {
+			tables.clear();
+			shapes.clear();
+			file.close();
+			return false;
+		}
+		Table& t = tables[i];
+		t.stride = them.count;
+		t.groupBits = (const uint64_t*)(file.data() + entry.groupOffset);
+		t.groupStarts = (const uint32_t*)(file.data() + entry.groupOffset + groups * sizeof(uint64_t));
+		t.blockBits = (const uint64_t*)(file.data() + entry.blockOffset);
+		t.blockStarts = (const uint32_t*)(file.data() + entry.blockOffset + entry.blockCount * sizeof(uint64_t));
+		t.values = file.data() + entry.valueOffset;
+		// Every probe has to stay inside the file
+		for (uint64_t g = 0; g < groups && valid; g++) {
+			valid = t.groupStarts[g] + (uint64_t)bitCount(t.groupBits[g]) <= entry.blockCount;
+		}
+		for (uint64_t b = 0; b < entry.blockCount && valid; b++) {
+			valid = t.blockStarts[b] + (uint64_t)bitCount(t.blockBits[b]) <= entry.valueCount;
+		}
+		if (!valid) {
+			tables.clear();
+			shapes.clear();
+			file.close();
+			return false;
+		}
+	}
+	return true;
+}
+
+const Tablebase::Table& Tablebase::table(int myLength, int theirLength) const {
+	int lengths = longest - MIN_LENGTH + 1;
+	return tables[(myLength - MIN_LENGTH) * lengths + theirLength - MIN_LENGTH];
+}
+
+// Function to read one value: draws are the positions missing from the bitmaps
+uint8_t Tablebase::lookup(const Table& t, uint64_t position) const {
+	uint64_t block = position / 64;
+	uint64_t groupBits = t.groupBits[block / 64];
+	uint64_t blockBit = 1ull << (block % 64);
+	if (!(groupBits & blockBit)) return 0;
+	uint32_t stored = t.groupStarts[block / 64] + bitCount(groupBits & (blockBit - 1));
+	uint64_t bits = t.blockBits[stored];
+	uint64_t bit = 1ull << (position % 64);
+	if (!(bits & bit)) return 0;
+	return t.values[t.blockStarts[stored] + bitCount(bits & (bit - 1))];
+}
+
+bool Tablebase::covers(const Engine& engine) const {
+	if (tables.empty() || engine.rules.cellCount != cellCount || !engine.rules.simultaneous || engine.rules.stepsPerTick != 1) return false;
+	for (int i = 0; i < 2; i++) {
+		const EngineSnake& s = engine.snakes[i];
+		if (s.length < MIN_LENGTH || s.length > longest || s.addSegment) return false;
+		for (int k = 0; k < s.length; k++) {
+			if (!engine.inBounds(s.segment(k))) return false;
+		}
+	}
+	return true;
+}
+
+// Function to get the shape index of a covered snake from its segments
+int Tablebase::shapeIndex(const Engine& engine, int snake) const {
+	const EngineSnake& s = engine.snakes[snake];
+	const Shapes& table = shapes[s.length - MIN_LENGTH];
+	auto between = [](Cell from, Cell to) {
+		return to.x > from.x ? DIR_RIGHT : to.x < from.x ? DIR_LEFT : to.y > from.y ? DIR_DOWN : DIR_UP;
+	};
+	Dir direction = between(s.segment(1), s.segment(0));
+	Dir d = direction;
+	int code = 0, scale = 1;
+	for (int i = 1; i + 1 < s.length; i++) {
+		Dir behind = between(s.segment(i + 1), s.segment(i));
+		int turn = (d - behind) & 3;
+		code += (turn == 3 ? 2 : turn) * scale;
+		scale *= 3;
+		d = behind;
+	}
+	return (engine.cellIndex(s.head()) * 4 + direction) * table.turnCodes + code;
+}
+
+bool Tablebase::probe(const Engine& engine, int snake, TablebaseValue& value) const {
+	if (!covers(engine)) return false;
+	const Table& t = table(engine.snakes[snake].length, engine.snakes[1 - snake].length);
+	uint8_t v = lookup(t, (uint64_t)shapeIndex(engine, snake) * t.stride + shapeIndex(engine, 1 - snake));
+	value.result = !v ? 0 : (v & LOSS_BIT) ? -1 : 1;
+	value.distance = v & ~LOSS_BIT;
+	return true;
+}
+
+bool Tablebase::evaluate(const Engine& engine, int snake, Dir move, TablebaseValue& value) const {
+	if (!covers(engine)) return false;
+	const Shapes& me = shapes[engine.snakes[snake].length - MIN_LENGTH];
+	const Shapes& them = shapes[engine.snakes[1 - snake].length - MIN_LENGTH];
+	const Table& t = table(me.length, them.length);
+	int mine = shapeIndex(engine, snake), theirs = shapeIndex(engine, 1 - snake);
+	int turn = (move - mine / me.turnCodes % 4) & 3;
+	int myTurn = turn == 3 ? 2 : turn == 2 ? 0 : turn;  // Reversing keeps the direction
+
+	// Score each reply: a win in N is 1000 - N, a draw 0, a loss in N N - 1000
+	int worst = 1000;
+	for (int theirTurn = 0; theirTurn < 3; theirTurn++) {
+		TickOutcome outcome = Shapes::tick(me, mine, myTurn, them, theirs, theirTurn);
+		int score = outcome == THEY_CRASH ? 999 : outcome == I_CRASH ? -999 : 0;
+		if (outcome == BOTH_LIVE) {
+			uint8_t v = lookup(t, (uint64_t)me.successor[3 * mine + myTurn] * t.stride + them.successor[3 * theirs + theirTurn]);
+			int distance = (v & ~LOSS_BIT) + 1;
+			score = !v ? 0 : (v & LOSS_BIT) ? distance - 1000 : 1000 - distance;
+		}
+		worst = min(worst, score);
+	}
+	value.result = worst > 0 ? 1 : worst < 0 ? -1 : 0;
+	value.distance = worst > 0 ? 1000 - worst : worst < 0 ? worst + 1000 : 0;
+	return true;
+}
+
+bool Tablebase::bestMove(const Engine& engine, int snake, Dir& move, TablebaseValue& value) const {
+	Dir current = engine.snakes[snake].direction;
+	bool found = false;
+	for (int turn : { 0, 1, 3 }) {
+		Dir d = (Dir)((current + turn) & 3);
+		TablebaseValue v;
+		if (!evaluate(engine, snake, d, v)) return false;
+		if (!found || betterResult(v, value)) {
+			move = d;
+			value = v;
+			found = true;
+		}
+	}
+	return true;
+}
+
+shared_ptr<const Tablebase> loadTablebase(const string& path) {
+	static mutex lock;
+	static map<string, shared_ptr<const Tablebase>> loaded;
+	lock_guard<mutex> guard(lock);
+	auto found = loaded.find(path);
+	if (found != loaded.end()) return found->second;
+	shared_ptr<Tablebase> tablebase = make_shared<Tablebase>();
+	if (!tablebase->open(path)) {
+		fprintf(stderr, "%s: not a tablebase file\n", path.c_str());
+		return nullptr;
+	}
+	loaded[path] = tablebase;
+	return tablebase;
+}
+
+static atomic<uint64_t> movesTotal(0), probedTotal(0);
+
+TablebaseBotStats tablebaseBotStats() {
+	TablebaseBotStats s;
+	s.moves = movesTotal.load();
+	s.probed = probedTotal.load();
+	return s;
+}
+
+TablebaseBot::TablebaseBot(shared_ptr<const Tablebase> opened, uint64_t seed) : tablebase(opened), fallback(createBot("roomy", seed)) {}
+
+TablebaseBot::~TablebaseBot() {
+	movesTotal.fetch_add(totals.moves, memory_order_relaxed);
+	probedTotal.fetch_add(totals.probed, memory_order_relaxed);
+}
+
+Dir TablebaseBot::chooseMove(const Engine& engine, int snake) {
+	totals.moves++;
+	Dir move;
+	TablebaseValue value;
+	if (tablebase->bestMove(engine, snake, move, value)) {
+		totals.probed++;
+		return move;
+	}
+	return fallback->chooseMove(engine, snake);
+}
@@ -0,0 +1,129 @@
+#pragma once
+// Endgame tablebase for small boards (up to 8 x 8), solved by retrograde analysis.
+// It covers food-free endgames with simultaneous moves: lengths never change, and a match ends when
+// a snake crashes. Every legal position of two bodies with lengths MIN_LENGTH..maxLength gets one of:
+//  - win in N:  the snake can make the opponent crash within N ticks, while surviving itself, even if
+//               the opponent knew its move in advance
+//  - loss in N: it cannot; an opponent who knew its moves could win within N ticks
+//  - draw:      neither, for example because both can circle forever or only a head-on crash is forced
+// Wins are played as fast as possible and losses as slowly as possible. Because an opponent cannot
+// really see the move, both snakes can be "lost" in the same position, but never both "won".
+//
+// Positions are indexed per snake as (head cell, direction, turn at each later segment), so a body of
+// length L has cells * 4 * 3^(L-2) indexes, and a position is the pair. Each pass resolves the
+// positions whose successors were resolved in the previous pass, rows split across a thread pool.
+// The file holds one table per pair of lengths. Only won and lost positions are stored, one byte each,
+// found through two levels of bitmaps with running counts (64 positions per block, 64 blocks per
+// group), so a probe is a few loads and two popcounts. Illegal positions read as draws. Open files are
+// memory-mapped and shared by every bot.
+#include <cstdint>       // For fixed-width integer types
+#include <memory>        // For sharing an opened file
+#include <string>        // For paths
+#include <vector>        // For the per-table statistics
+#include "Bot.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+// What a probe says about a position
+struct TablebaseValue {
+	int result = 0;    // 1 win, -1 loss, 0 draw
+	int distance = 0;  // Ticks to the end for a win or a loss
+};
+
+// Function to check if a result is better than another: any win beats a draw, which beats any loss,
+// faster wins and slower losses are better
+inline bool betterResult(const TablebaseValue& a, const TablebaseValue& b) {
+	if (a.result != b.result) return a.result > b.result;
+	return a.result > 0 ? a.distance < b.distance : a.result < 0 && a.distance > b.distance;
+}
+
+// Statistics of one solved table
+struct TablebaseTableStats {
+	int lengths[2] = { 0, 0 };  // Length of the snake to move and of its opponent
+	uint64_t positions = 0;     // Indexes in the table
+	uint64_t legal = 0;         // Legal positions among them
+	uint64_t wins = 0;
+	uint64_t losses = 0;
+	int longestWin = 0;         // Most ticks to a forced win
+	int longestLoss = 0;        // Most ticks to a loss
+	uint64_t bytes = 0;         // Size in the file
+};
+
+class Tablebase {
+public:
+	static const int MAX_BOARD = 8;      // Bodies are 64-bit cell masks
+	static const int MIN_LENGTH = 3;     // Snakes start with three segments and only grow
+	static const int MAX_DISTANCE = 127; // Longest win or loss a value byte holds
+
+	Tablebase();
+	~Tablebase();
+
+	Tablebase(const Tablebase&) = delete;
+	Tablebase& operator=(const Tablebase&) = delete;
+
+	// Function to solve every table of a board up to maxLength and write them to a file; false with a
+	// message in error if the sizes are out of range, a distance does not fit or the file cannot be written
+	static bool build(int board, int maxLength, ThreadPool& pool, const std::string& path,
+		std::vector<TablebaseTableStats>& stats, std::string& error);
+
+	bool open(const std::string& path);  // Map a file written by build(); false if missing or invalid
+
+	int board() const { return cellCount; }
+	int maxLength() const { return longest; }
+
+	// Function to check if the engine is in a position the tables cover: the board size, simultaneous
+	// one-move-per-tick rules, both lengths in range, no pending growth and every segment on the board
+	bool covers(const Engine& engine) const;
+
+	// Function to look up the position for `snake`; false if it is not covered
+	bool probe(const Engine& engine, int snake, TablebaseValue& value) const;
+
+	// Function to get the result `snake` can guarantee after playing `move` (a reversal keeps the
+	// direction, as in the engine); false if the position is not covered
+	bool evaluate(const Engine& engine, int snake, Dir move, TablebaseValue& value) const;
+
+	// Function to find the move with the best guaranteed result for `snake` (the fastest win, else a
+	// draw, else the slowest loss); false if the position is not covered
+	bool bestMove(const Engine& engine, int snake, Dir& move, TablebaseValue& value) const;
+
+private:
+	struct Shapes;
+	struct Table;
+
+	int cellCount = 0;
+	int longest = 0;
+	MappedFile file;
+	std::vector<Shapes> shapes;  // Per length, from MIN_LENGTH
+	std::vector<Table> tables;   // Per pair of lengths
+
+	const Table& table(int myLength, int theirLength) const;
+	int shapeIndex(const Engine& engine, int snake) const;
+	uint8_t lookup(const Table& t, uint64_t position) const;
+};
+
+// Function to open a tablebase file once per path; nullptr with a message on stderr if it is invalid
+std::shared_ptr<const Tablebase> loadTablebase(const std::string& path);
+
+// Totals over all tablebase bots whose matches have finished
+struct TablebaseBotStats {
+	uint64_t moves = 0;   // Moves asked for
+	uint64_t probed = 0;  // Moves played from the tables
+};
+
+// Function to read the totals so far
+TablebaseBotStats tablebaseBotStats();
+
+// Bot that plays the tablebase's best move whenever the position is covered and the roomy bot's
+// move otherwise ("tablebase:PATH")
+class TablebaseBot : public Bot {
+public:
+	TablebaseBot(std::shared_ptr<const Tablebase> opened, uint64_t seed);
+	~TablebaseBot() override;
+
+	Dir chooseMove(const Engine& engine, int snake) override;
+
+private:
+	std::shared_ptr<const Tablebase> tablebase;
+	std::unique_ptr<Bot> fallback;
+	TablebaseBotStats totals;  // Added to tablebaseBotStats() when the bot is destroyed
+};
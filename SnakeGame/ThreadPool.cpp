@@ -0,0 +1,63 @@
+#include "ThreadPool.h"
+#include <algorithm>     // For max
+using namespace std;
+
+ThreadPool::ThreadPool(int threads) {
+	if (threads <= 0) threads = (int)max(1u, thread::hardware_concurrency());
+	for (int i = 1; i < threads; i++) {
+		workers.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (thread& t : workers) t.join();
+}
+
+// Function to run one worker's share of the current loop
+void ThreadPool::runChunk(int worker) {
+	int workerCount = size();
+	int begin = (int)((int64_t)count * worker / workerCount);
+	int end = (int)((int64_t)count * (worker + 1) / workerCount);
+	if (begin < end) (*task)(begin, end, worker);
+}
+
+// Function run by each background worker: wait for a loop, run its chunk, report back
+void ThreadPool::workerLoop(int worker) {
+	uint64_t seen = 0;
+	while (true) {
+		{
+			unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&]() { return stopping || generation != seen; });
+			if (stopping) return;
+			seen = generation;
+		}
+		runChunk(worker);
+		{
+			lock_guard<std::mutex> lock(mutex);
+			if (--pending == 0) done.notify_one();
+		}
+	}
+}
+
+void ThreadPool::parallelFor(int loopCount, const function<void(int, int, int)>& loopTask) {
+	if (workers.empty()) {
+		if (loopCount > 0) loopTask(0, loopCount, 0);
+		return;
+	}
+	{
+		lock_guard<std::mutex> lock(mutex);
+		task = &loopTask;
+		count = loopCount;
+		pending = (int)workers.size();
+		generation++;
+	}
+	wake.notify_all();
+	runChunk(0);
+	unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [&]() { return pending == 0; });
+}
@@ -0,0 +1,39 @@
+#pragma once
+// Fixed-size thread pool for data-parallel loops.
+// The calling thread takes part as worker 0, so a pool of size 1 runs everything inline.
+#include <condition_variable>  // For waking and joining workers
+#include <cstdint>             // For the generation counter
+#include <functional>          // For the loop body
+#include <mutex>               // For the shared state
+#include <thread>              // For worker threads
+#include <vector>              // For the worker list
+
+class ThreadPool {
+public:
+	explicit ThreadPool(int threads = 0);  // 0 = hardware concurrency
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Function to get the number of workers (including the calling thread)
+	int size() const { return (int)workers.size() + 1; }
+
+	// Function to run task(begin, end, worker) over [0, count) split into one contiguous chunk per
+	// worker; blocks until every chunk is done
+	void parallelFor(int count, const std::function<void(int, int, int)>& task);
+
+private:
+	std::vector<std::thread> workers;      // Background workers 1..size()-1
+	std::mutex mutex;                      // Guards everything below
+	std::condition_variable wake;          // Signals a new loop or shutdown
+	std::condition_variable done;          // Signals that the last chunk finished
+	const std::function<void(int, int, int)>* task = nullptr;  // Current loop body
+	int count = 0;                         // Current loop size
+	uint64_t generation = 0;               // Incremented for every loop
+	int pending = 0;                       // Background chunks still running
+	bool stopping = false;                 // Set by the destructor
+
+	void runChunk(int worker);
+	void workerLoop(int worker);
+};
@@ -0,0 +1,150 @@
+#include "Tournament.h"
+#include <algorithm>     // For sort and max
+#include <atomic>        // For shared counters
+#include <chrono>        // For timing the run
+#include <ctime>         // For match timestamps
+#include <cmath>         // For abs
+#include <memory>        // For the shared rating snapshot
+#include <mutex>         // For publishing the snapshot
+#include <thread>        // For worker threads
+#include "LockFreeQueue.h"
+#include "Match.h"
+#include "StatsStore.h"
+using namespace std;
+
+// Result travelling from a match worker to the rating thread
+struct QueuedResult {
+	RatedResult rated;
+	MatchResult match;
+	int bot1 = 0;  // Option index of the bot on snake 1
+	int bot2 = 0;  // Option index of the bot on snake 2
+};
+
+// Function to pick an opponent among the nearest-rated bots
+static int pickOpponent(int self, const vector<double>& ratings, int window, SimRng& rng) {
+	vector<pair<double, int>> byDistance;
+	for (int i = 0; i < (int)ratings.size(); i++) {
+		if (i != self) byDistance.push_back(make_pair(abs(ratings[i] - ratings[self]), i));
+	}
+	int candidates = min(max(window, 1), (int)byDistance.size());
+	partial_sort(byDistance.begin(), byDistance.begin() + candidates, byDistance.end());
+	return byDistance[rng.randomValue(0, candidates - 1)].second;
+}
+
+TournamentReport runTournament(const TournamentOptions& options, RatingTable& table) {
+	TournamentReport report;
+	auto startTime = chrono::steady_clock::now();
+	int botCount = (int)options.bots.size();
+	if (botCount < 2) return report;
+	vector<int> tableIndex(botCount);
+	for (int i = 0; i < botCount; i++) tableIndex[i] = table.indexOf(options.bots[i]);
+
+	// Ratings snapshot the workers matchmake from; replaced by the rating thread after each batch
+	mutex snapshotMutex;
+	shared_ptr<const vector<double>> snapshot;
+	auto publish = [&]() {
+		auto ratings = make_shared<vector<double>>(botCount);
+		for (int i = 0; i < botCount; i++) (*ratings)[i] = table.entries[tableIndex[i]].elo;
+		lock_guard<mutex> lock(snapshotMutex);
+		snapshot = ratings;
+	};
+	publish();
+
+	LockFreeQueue<QueuedResult> queue(options.batchSize * 4);
+	atomic<uint64_t> nextMatch(0);
+	atomic<int> workersRunning(0);
+	int threadCount = options.threads > 0 ? options.threads : (int)max(1u, thread::hardware_concurrency());
+
+	auto worker = [&](int id) {
+		SimRng rng(mix64(options.seed ^ (0x51ed2701ULL + id)));
+		shared_ptr<const vector<double>> ratings;
+		uint64_t played = 0;
+		AnalyticsAccumulator local(options.rules.cellCount);
+		AnalyticsAccumulator* analytics = options.analytics ? &local : nullptr;
+		while (true) {
+			uint64_t match = nextMatch.fetch_add(1);
+			if (match >= options.matches) break;
+			if (played++ % 256 == 0) {
+				lock_guard<mutex> lock(snapshotMutex);
+				ratings = snapshot;
+			}
+			int a = (int)(match % botCount);  // Every bot gets its share of matches
+			int b = pickOpponent(a, *ratings, options.matchmakingWindow, rng);
+			if (match & 1) swap(a, b);       // Alternate seats
+			uint64_t seed = mix64(options.seed ^ mix64(match));
+			unique_ptr<Bot> bot1 = createBot(options.bots[a], seed ^ 1);
+			unique_ptr<Bot> bot2 = createBot(options.bots[b], seed ^ 2);
+			MatchResult result = playMatch(options.rules, *bot1, *bot2, seed, options.limits, analytics);
+			if (analytics && local.matches >= (uint64_t)options.analyticsFlushMatches) options.analytics->flush(local);
+
+			QueuedResult queued;
+			queued.rated.player1 = tableIndex[a];
+			queued.rated.player2 = tableIndex[b];
+			queued.rated.score1 = result.winner == 1 ? 1.0 : result.winner == 2 ? 0.0 : 0.5;
+			queued.match = result;
+			queued.bot1 = a;
+			queued.bot2 = b;
+			while (!queue.tryPush(queued)) this_thread::yield();
+		}
+		if (analytics) options.analytics->flush(local);
+		workersRunning.fetch_sub(1, memory_order_release);
+	};
+
+	StatsStore stats;
+	bool logging = !options.statsPath.empty() && stats.open(options.statsPath);
+
+	auto rater = [&]() {
+		vector<RatedResult> batch;
+		batch.reserve(options.batchSize);
+		QueuedResult item;
+		auto take = [&]() {
+			batch.push_back(item.rated);
+			report.ticks += item.match.ticks;
+			if (logging) {
+				MatchRecord record;
+				record.timestamp = (int64_t)time(nullptr);
+				record.durationTicks = item.match.ticks;
+				record.winner = (uint8_t)item.match.winner;
+				for (int i = 0; i < 2; i++) {
+					record.score[i] = item.match.score[i];
+					record.length[i] = item.match.length[i];
+					record.deathCause[i] = item.match.deathCause[i];
+				}
+				record.setPlayer(0, options.bots[item.bot1]);
+				record.setPlayer(1, options.bots[item.bot2]);
+				stats.append(record);
+			}
+		};
+		while (true) {
+			bool finished = workersRunning.load(memory_order_acquire) == 0;
+			while (batch.size() < options.batchSize && queue.tryPop(item)) take();
+			bool drained = finished && !queue.tryPop(item);
+			if (!drained && finished) take();  // Popped by the emptiness check
+			if (batch.size() >= options.batchSize || (drained && !batch.empty())) {
+				table.applyBatch(batch);
+				report.matches += batch.size();
+				report.batches++;
+				batch.clear();
+				publish();
+				if (report.batches % options.saveEveryBatches == 0) {
+					if (!options.ratingsPath.empty()) table.save(options.ratingsPath);
+					if (logging) stats.sync();
+				}
+			}
+			if (drained) break;
+			if (batch.size() < options.batchSize) this_thread::yield();
+		}
+	};
+
+	vector<thread> workers;
+	workersRunning.store(threadCount);
+	for (int i = 0; i < threadCount; i++) workers.emplace_back(worker, i);
+	thread ratingThread(rater);
+	for (thread& t : workers) t.join();
+	ratingThread.join();
+
+	if (!options.ratingsPath.empty()) table.save(options.ratingsPath);
+	if (logging) stats.writeIndex();
+	report.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+	return report;
+}
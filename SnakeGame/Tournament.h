@@ -0,0 +1,35 @@
+#pragma once
+// Rated bot tournaments: worker threads play matchmade matches and push results into a lock-free
+// queue; one rating thread drains it in batches, updates the RatingTable and saves it to disk.
+#include <cstdint>       // For fixed-width integer types
+#include <string>        // For bot names and the table path
+#include <vector>        // For the bot list
+#include "Analytics.h"
+#include "Rating.h"
+#include "Match.h"
+
+struct TournamentOptions {
+	std::vector<std::string> bots;  // Bot names (see createBot)
+	uint64_t matches = 10000;       // Matches to play
+	int threads = 0;                // Match workers (0 = hardware concurrency)
+	uint64_t seed = 1;              // Master seed
+	Rules rules;                    // Match rules
+	MatchLimits limits;             // Tick cap, adjudication and repetition draws per match
+	size_t batchSize = 4096;        // Results per rating batch
+	int matchmakingWindow = 3;      // Opponent is drawn from this many nearest-rated bots
+	std::string ratingsPath;        // Rating table file (empty = do not persist)
+	int saveEveryBatches = 16;      // Save the table after this many batches
+	std::string statsPath;          // Match statistics log (empty = do not log matches)
+	AnalyticsTotal* analytics = nullptr;  // Streaming analytics total (null = off)
+	int analyticsFlushMatches = 64; // Worker accumulators are merged into the total this often
+};
+
+struct TournamentReport {
+	uint64_t matches = 0;  // Matches played and rated
+	uint64_t ticks = 0;    // Ticks simulated
+	uint64_t batches = 0;  // Rating batches applied
+	double seconds = 0;    // Wall-clock time
+};
+
+// Function to run a tournament, updating (and, if a path is set, persisting) the table
+TournamentReport runTournament(const TournamentOptions& options, RatingTable& table);
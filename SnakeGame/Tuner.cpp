@@ -0,0 +1,261 @@
+#include "Tuner.h"
+#include <algorithm>     // For min, max and stable_sort
+#include <cmath>         // For sqrt, log, cos and round
+#include <cstdio>        // For snprintf, rename and remove
+#include <cstdlib>       // For abs and strtod
+#include <fstream>       // For checkpoints
+#include <memory>        // For the opponents
+#include <sstream>       // For checkpoint lines
+using namespace std;
+
+static const char* FEATURE_NAMES[FEATURE_COUNT] = { "food", "territory", "space", "opponent" };
+
+const char* featureName(int feature) {
+	return FEATURE_NAMES[feature];
+}
+
+string TunerWeights::botName() const {
+	string name = "weighted:";
+	for (int f = 0; f < FEATURE_COUNT; f++) {
+		char text[32];
+		snprintf(text, sizeof(text), f == 0 ? "%.4f" : ":%.4f", w[f]);
+		name += text;
+	}
+	return name;
+}
+
+bool parseWeights(const string& text, TunerWeights& weights) {
+	const char* p = text.c_str();
+	for (int f = 0; f < FEATURE_COUNT; f++) {
+		char* end;
+		weights.w[f] = strtod(p, &end);
+		if (end == p || *end != (f + 1 < FEATURE_COUNT ? ':' : '\0')) return false;
+		p = end + 1;
+	}
+	return true;
+}
+
+// Function to get the Manhattan distance between two cells
+static int distance(Cell a, Cell b) {
+	return abs(a.x - b.x) + abs(a.y - b.y);
+}
+
+WeightedBot::WeightedBot(const TunerWeights& weights, uint64_t seed) : weights(weights), rng(seed) {}
+
+void WeightedBot::reset(const TunerWeights& newWeights, uint64_t seed) {
+	weights = newWeights;
+	rng = SimRng(seed);
+}
+
+Dir WeightedBot::chooseMove(const Engine& engine, int snake) {
+	const EngineSnake& self = engine.snakes[snake];
+	Cell head = self.head();
+	Cell theirs = engine.snakes[1 - snake].head();
+	Cell target = engine.food;
+	if (engine.showPowerup && distance(head, engine.powerup) < distance(head, target)) target = engine.powerup;
+	int n = engine.rules.cellCount;
+	int areas[4] = { 0, 0, 0, 0 };
+	bool counted = n <= Bitboard::MAX_CELLS;
+	Bitboard free;
+	if (counted) {
+		free = freeCells(engine);
+		moveAreas(free, head, self.direction, areas);
+	}
+
+	Dir best = self.direction;
+	double bestScore = -1e300;
+	int first = rng.randomValue(0, 3);
+	for (int i = 0; i < 4; i++) {
+		Dir d = (Dir)((first + i) & 3);
+		if (d == oppositeDir(self.direction) || !isSafeMove(engine, snake, d)) continue;
+		Cell next = stepCell(head, d);
+		double feature[FEATURE_COUNT] = { -(double)distance(next, target) / n, 0, 0, 1.0 / max(1, distance(next, theirs)) };
+		if (counted) {
+			Bitboard after = free;
+			after.clear(next);
+			Cell heads[2] = { next, theirs };
+			territory.compute(after, heads, 2);
+			feature[FEATURE_TERRITORY] = (double)(territory.cells[0] - territory.cells[1]) / (n * n);
+			feature[FEATURE_SPACE] = (double)min(areas[d], self.length) / self.length;
+		}
+		double score = 0;
+		for (int f = 0; f < FEATURE_COUNT; f++) score += weights.w[f] * feature[f];
+		if (score > bestScore) {
+			bestScore = score;
+			best = d;
+		}
+	}
+	return best;
+}
+
+double TunerIndividual::fitness() const {
+	uint64_t matches = wins + draws + losses;
+	return matches > 0 ? (wins + 0.5 * draws) / matches : 0;
+}
+
+// Function to get a uniform value in [0, 1)
+static double uniform(SimRng& rng) {
+	return (rng.next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Function to get a standard normal value (Box-Muller)
+static double gaussian(SimRng& rng) {
+	double u = 1 - uniform(rng);  // In (0, 1], so the log is finite
+	return sqrt(-2 * log(u)) * cos(6.283185307179586 * uniform(rng));
+}
+
+// Function to clamp a weight to the range and round it to the checkpoint grid
+static double snapWeight(double value, double range) {
+	return round(min(max(value, -range), range) * 1e4) / 1e4;
+}
+
+// Function to get the seed of a generation's matches and breeding
+static uint64_t generationSeed(uint64_t seed, int generation) {
+	return mix64(seed ^ mix64(0x74756e6572ULL + (uint64_t)generation));
+}
+
+TunerState initialPopulation(const TunerOptions& options) {
+	TunerState state;
+	state.seed = options.seed;
+	SimRng rng(generationSeed(options.seed, -1));
+	state.population.resize(max(options.population, 1));
+	for (size_t i = 1; i < state.population.size(); i++) {
+		for (double& w : state.population[i].weights.w) w = snapWeight((2 * uniform(rng) - 1) * options.range, options.range);
+	}
+	return state;
+}
+
+vector<TunerIndividual> breed(const TunerState& state, const TunerOptions& options) {
+	const vector<TunerIndividual>& parents = state.population;
+	int size = (int)parents.size();
+	SimRng rng(generationSeed(state.seed, state.generation) ^ 0x6272656564ULL);
+	vector<TunerIndividual> children(max(options.population, 1));
+	int elite = min(max(options.elite, 0), min(size, (int)children.size()));
+	for (int i = 0; i < elite; i++) children[i].weights = parents[i].weights;
+
+	// The parents are sorted best first, so a tournament is won by the lowest index drawn
+	auto pick = [&]() {
+		int winner = size - 1;
+		for (int k = 0; k < max(options.tournament, 1); k++) winner = min(winner, rng.randomValue(0, size - 1));
+		return winner;
+	};
+	for (size_t i = elite; i < children.size(); i++) {
+		const TunerWeights& a = parents[pick()].weights;
+		const TunerWeights& b = parents[pick()].weights;
+		for (int f = 0; f < FEATURE_COUNT; f++) {
+			double blend = -0.25 + 1.5 * uniform(rng);  // May land a little outside both parents
+			double w = a.w[f] + blend * (b.w[f] - a.w[f]);
+			if (uniform(rng) < options.mutationRate) w += options.mutation * gaussian(rng);
+			children[i].weights.w[f] = snapWeight(w, options.range);
+		}
+	}
+	return children;
+}
+
+void evaluatePopulation(TunerState& state, const TunerOptions& options, ThreadPool& pool) {
+	vector<TunerIndividual>& population = state.population;
+	int size = (int)population.size();
+	int matches = max(options.matches, 1);
+	uint64_t seed = generationSeed(state.seed, state.generation);
+	vector<Engine> engines(pool.size(), Engine(options.rules, 0));  // One pooled engine per worker
+	vector<WeightedBot> bots(pool.size(), WeightedBot(TunerWeights(), 0));
+	vector<vector<TunerIndividual>> tallies(pool.size(), vector<TunerIndividual>(size));
+	int count = (int)min<uint64_t>((uint64_t)size * matches, 0x7fffffff);
+
+	pool.parallelFor(count, [&](int begin, int end, int worker) {
+		Engine& engine = engines[worker];
+		WeightedBot& bot = bots[worker];
+		vector<TunerIndividual>& tally = tallies[worker];
+		for (int i = begin; i < end; i++) {
+			int individual = i / matches;
+			int side = i % matches & 1;  // Each seed is played once on each side
+			uint64_t matchSeed = mix64(seed ^ mix64((uint64_t)(i % matches / 2)));  // Same seeds for every individual
+			bot.reset(population[individual].weights, matchSeed ^ (side + 1));
+			unique_ptr<Bot> opponent = createBot(options.opponent, matchSeed ^ (2 - side));
+			MatchResult r = side == 0 ? playMatch(engine, options.rules, bot, *opponent, matchSeed, options.limits)
+				: playMatch(engine, options.rules, *opponent, bot, matchSeed, options.limits);
+			TunerIndividual& t = tally[individual];
+			if (r.winner == side + 1) t.wins++;
+			else if (r.winner == DRAW) t.draws++;
+			else t.losses++;
+			t.margin += r.score[side] - r.score[1 - side];
+		}
+	});
+
+	for (int i = 0; i < size; i++) {
+		TunerIndividual& total = population[i];
+		total.wins = total.draws = total.losses = 0;
+		total.margin = 0;
+		for (const vector<TunerIndividual>& tally : tallies) {
+			total.wins += tally[i].wins;
+			total.draws += tally[i].draws;
+			total.losses += tally[i].losses;
+			total.margin += tally[i].margin;
+		}
+	}
+	stable_sort(population.begin(), population.end(), [](const TunerIndividual& a, const TunerIndividual& b) {
+		double fa = a.fitness(), fb = b.fitness();
+		return fa != fb ? fa > fb : a.margin > b.margin;
+	});
+	state.generation++;
+}
+
+bool saveCheckpoint(const TunerState& state, const string& path) {
+	string temporary = path + ".tmp";
+	{
+		ofstream out(temporary, ios::trunc);
+		if (!out) return false;
+		out << "# snake_sim --tune checkpoint\n";
+		out << "generation " << state.generation << '\n';
+		out << "seed " << state.seed << '\n';
+		out << "# wins draws losses margin";
+		for (int f = 0; f < FEATURE_COUNT; f++) out << ' ' << featureName(f);
+		out << '\n';
+		out.setf(ios::fixed);
+		out.precision(4);
+		for (const TunerIndividual& i : state.population) {
+			out << i.wins << ' ' << i.draws << ' ' << i.losses << ' ' << i.margin;
+			for (double w : i.weights.w) out << ' ' << w;
+			out << '\n';
+		}
+		if (!out.flush()) return false;
+	}
+	if (rename(temporary.c_str(), path.c_str()) != 0) {
+		remove(path.c_str());  // Windows will not rename over an existing file
+		if (rename(temporary.c_str(), path.c_str()) != 0) return false;
+	}
+	return true;
+}
+
+bool loadCheckpoint(const string& path, TunerState& state) {
+	ifstream in(path);
+	if (!in) return false;
+	TunerState loaded;
+	bool haveGeneration = false, haveSeed = false;
+	string line;
+	while (getline(in, line)) {
+		if (line.empty() || line[0] == '#') continue;
+		istringstream fields(line);
+		if (line.compare(0, 11, "generation ") == 0) {
+			string key;
+			haveGeneration = (bool)(fields >> key >> loaded.generation);
+			continue;
+		}
+		if (line.compare(0, 5, "seed ") == 0) {
+			string key;
+			haveSeed = (bool)(fields >> key >> loaded.seed);
+			continue;
+		}
+		TunerIndividual individual;
+		if (!(fields >> individual.wins >> individual.draws >> individual.losses >> individual.margin)) return false;
+		for (double& w : individual.weights.w) {
+			if (!(fields >> w)) return false;
+		}
+		loaded.population.push_back(individual);
+	}
+	// Unlike the rating table, a damaged checkpoint is refused: resuming from part of it would
+	// quietly breed a different run
+	if (!haveGeneration || !haveSeed || loaded.generation < 1 || loaded.population.empty()) return false;
+	state = loaded;
+	return true;
+}
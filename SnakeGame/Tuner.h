@@ -0,0 +1,111 @@
+#pragma once
+// Evolutionary tuning of the weighted bot's heuristic weights.
+// The weighted bot scores each safe move as a weighted sum of four features (see WeightedBot). The
+// tuner keeps a population of weight vectors; every generation, each one plays the same seeded matches
+// against a fixed opponent (common random numbers, on both sides of the board), and the next population
+// is bred from the results: the best few are kept as they are, the rest are children of two parents
+// picked by tournaments, blended and mutated with Gaussian noise.
+//
+// A generation is one parallelFor over every match of every individual. Each worker keeps one pooled
+// Engine and one WeightedBot (with its territory buffers) that are restarted for every match, and
+// tallies into its own row of results, so workers share nothing until the generation is merged.
+// Results only depend on the seeds, not on the number of threads.
+//
+// After every generation the evaluated population is written to a text checkpoint (through a
+// temporary file, so an interrupted write keeps the previous one). Weights are kept on a 1e-4 grid so
+// they read back exactly, and a resumed run breeds the same generations as one that never stopped.
+#include <cstdint>       // For fixed-width integer types
+#include <string>        // For bot names and paths
+#include <vector>        // For the population
+#include "Bitboard.h"
+#include "Bot.h"
+#include "Match.h"
+#include "ThreadPool.h"
+
+// Features of the weighted bot, in the order of its weights
+enum TunerFeature { FEATURE_FOOD, FEATURE_TERRITORY, FEATURE_SPACE, FEATURE_OPPONENT, FEATURE_COUNT };
+
+// Function to get the name of a feature as used in checkpoints
+const char* featureName(int feature);
+
+struct TunerWeights {
+	double w[FEATURE_COUNT] = { 1, 1, 4, -1 };  // Hand-set starting point
+
+	// Function to format the weights as a bot name for createBot ("weighted:W1:W2:W3:W4")
+	std::string botName() const;
+};
+
+// Function to parse "W1:W2:W3:W4"; false if there are not exactly four numbers
+bool parseWeights(const std::string& text, TunerWeights& weights);
+
+// Bot that plays the safe move with the highest weighted score ("weighted:W1:W2:W3:W4", or "weighted"
+// for the starting weights). Features of a move to cell `next`, each roughly in [-1, 1]:
+//  - food:      minus the distance from next to the food (or the closer visible power-up), per board side
+//  - territory: cells the snake reaches first minus cells the opponent reaches first after the move,
+//               per board cell
+//  - space:     cells reachable after the move, up to the snake's length, per segment (1 = room enough)
+//  - opponent:  one over the distance from next to the opponent's head (1 = a possible head-on crash)
+// Territory and space are 0 on boards wider than Bitboard::MAX_CELLS.
+class WeightedBot : public Bot {
+public:
+	WeightedBot(const TunerWeights& weights, uint64_t seed);
+
+	// Function to start a new match with other weights, keeping the buffers
+	void reset(const TunerWeights& weights, uint64_t seed);
+
+	Dir chooseMove(const Engine& engine, int snake) override;
+
+private:
+	TunerWeights weights;
+	SimRng rng;           // Private random stream for tie-breaks
+	Territory territory;  // Reused for every move
+};
+
+struct TunerOptions {
+	int population = 32;               // Weight vectors per generation
+	int generations = 20;              // Generations to run (counting those in a resumed checkpoint)
+	int matches = 200;                 // Matches per individual and generation, half on each side
+	int elite = 2;                     // Best individuals copied unchanged into the next generation
+	int tournament = 3;                // Individuals compared to pick each parent
+	double mutation = 0.5;             // Deviation of the Gaussian noise added to a mutated weight
+	double mutationRate = 0.25;        // Chance of each weight of a child to be mutated
+	double range = 10;                 // Weights are kept in [-range, range]
+	std::string opponent = "roomy";    // Bot every individual plays against
+	uint64_t seed = 1;                 // Master seed of the matches and the breeding
+	Rules rules;                       // Rules of every match
+	MatchLimits limits;                // Tick cap, adjudication and repetition draws per match
+};
+
+// One weight vector and its results in the generation it was evaluated in
+struct TunerIndividual {
+	TunerWeights weights;
+	uint64_t wins = 0;
+	uint64_t draws = 0;
+	uint64_t losses = 0;  // Including matches that hit the tick cap without a result
+	int64_t margin = 0;   // Own score minus the opponent's, summed over the matches
+
+	// Function to get the share of points won (a draw is half a point)
+	double fitness() const;
+};
+
+// A population after evaluation, sorted best first
+struct TunerState {
+	int generation = 0;   // Generations evaluated so far
+	uint64_t seed = 0;    // Master seed of the run
+	std::vector<TunerIndividual> population;
+};
+
+// Function to create the first population: the starting weights and random vectors in [-range, range]
+TunerState initialPopulation(const TunerOptions& options);
+
+// Function to breed the next population from an evaluated one (deterministic for a seed and generation)
+std::vector<TunerIndividual> breed(const TunerState& state, const TunerOptions& options);
+
+// Function to play every individual's matches on the pool, fill in the results and sort the population
+void evaluatePopulation(TunerState& state, const TunerOptions& options, ThreadPool& pool);
+
+// Function to write a checkpoint; false if the file cannot be written
+bool saveCheckpoint(const TunerState& state, const std::string& path);
+
+// Function to read a checkpoint; false if it is missing or damaged
+bool loadCheckpoint(const std::string& path, TunerState& state);